@@ -462,6 +462,49 @@ uint64_t ClassDB::get_api_hash(APIType p_api) {
 #endif
 }
 
+uint64_t ClassDB::get_api_constants_hash(APIType p_api) {
+	OBJTYPE_RLOCK;
+
+	uint64_t hash = hash_djb2_one_64(HashMapHasherDefault::hash(VERSION_FULL_CONFIG));
+
+	List<StringName> names;
+
+	const StringName *k = nullptr;
+
+	while ((k = classes.next(k))) {
+		names.push_back(*k);
+	}
+	//must be alphabetically sorted for hash to compute
+	names.sort_custom<StringName::AlphCompare>();
+
+	for (List<StringName>::Element *E = names.front(); E; E = E->next()) {
+		ClassInfo *t = classes.getptr(E->get());
+		ERR_FAIL_COND_V_MSG(!t, 0, "Cannot get class '" + String(E->get()) + "'.");
+		if (t->api != p_api || !t->exposed) {
+			continue;
+		}
+		hash = hash_djb2_one_64(t->name.hash(), hash);
+		hash = hash_djb2_one_64(t->inherits.hash(), hash);
+
+		List<StringName> snames;
+
+		k = nullptr;
+
+		while ((k = t->constant_map.next(k))) {
+			snames.push_back(*k);
+		}
+
+		snames.sort_custom<StringName::AlphCompare>();
+
+		for (List<StringName>::Element *F = snames.front(); F; F = F->next()) {
+			hash = hash_djb2_one_64(F->get().hash(), hash);
+			hash = hash_djb2_one_64(t->constant_map[F->get()], hash);
+		}
+	}
+
+	return hash;
+}
+
 bool ClassDB::class_exists(const StringName &p_class) {
 	OBJTYPE_RLOCK;
 	return classes.has(p_class);
@@ -494,6 +537,29 @@ Object *ClassDB::instance(const StringName &p_class) {
 #endif
 	return ti->creation_func();
 }
+Object *(*ClassDB::get_creation_func(const StringName &p_class, StringName *r_class))() {
+	OBJTYPE_RLOCK;
+
+	ClassInfo *ti = classes.getptr(p_class);
+	if (!ti || ti->disabled || !ti->creation_func) {
+		if (compat_classes.has(p_class)) {
+			ti = classes.getptr(compat_classes[p_class]);
+		}
+	}
+	if (!ti || ti->disabled || !ti->creation_func) {
+		return nullptr;
+	}
+#ifdef TOOLS_ENABLED
+	if (ti->api == API_EDITOR && !Engine::get_singleton()->is_editor_hint()) {
+		return nullptr;
+	}
+#endif
+	if (r_class) {
+		*r_class = ti->name;
+	}
+	return ti->creation_func;
+}
+
 bool ClassDB::can_instance(const StringName &p_class) {
 	OBJTYPE_RLOCK;
 
@@ -1115,6 +1181,21 @@ StringName ClassDB::get_property_getter(StringName p_class, const StringName &p_
 	return StringName();
 }
 
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
+	ClassInfo *type = classes.getptr(p_class);
+	ClassInfo *check = type;
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+			return psg;
+		}
+
+		check = check->inherits_ptr;
+	}
+
+	return nullptr;
+}
+
 bool ClassDB::has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance) {
 	ClassInfo *type = classes.getptr(p_class);
 	ClassInfo *check = type;
@@ -194,9 +194,13 @@ public:
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
 	static bool can_instance(const StringName &p_class);
 	static Object *instance(const StringName &p_class);
+	// The function instance() would call, for callers creating many objects of the class. nullptr if instance() would fail.
+	static Object *(*get_creation_func(const StringName &p_class, StringName *r_class = nullptr))();
 	static APIType get_api_type(const StringName &p_class);
 
 	static uint64_t get_api_hash(APIType p_api);
+	// Only covers the classes, their inheritance and integer constants, unlike get_api_hash() it is available in all builds.
+	static uint64_t get_api_constants_hash(APIType p_api);
 
 	template <class N, class M>
 	static MethodBind *bind_method(N p_method_name, M p_method) {
@@ -318,6 +322,7 @@ public:
 	static Variant::Type get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
 	static StringName get_property_setter(StringName p_class, const StringName &p_property);
 	static StringName get_property_getter(StringName p_class, const StringName &p_property);
+	static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
 
 	static bool has_method(StringName p_class, StringName p_method, bool p_no_inheritance = false);
 	static void set_method_flags(StringName p_class, StringName p_method, int p_flags);
@@ -5,13 +5,19 @@
 
 #include "message_queue.h"
 
+#include "core/os/frame_profiler.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
 
 MessageQueue *MessageQueue::singleton = nullptr;
+static thread_local MessageQueue *thread_queue = nullptr;
 
 MessageQueue *MessageQueue::get_singleton() {
-	return singleton;
+	return thread_queue ? thread_queue : singleton;
+}
+
+void MessageQueue::set_thread_queue(MessageQueue *p_queue) {
+	thread_queue = p_queue;
 }
 
 Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
@@ -220,6 +226,8 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 }
 
 void MessageQueue::flush() {
+	FRAME_PROFILE_SCOPE("MessageQueue::flush");
+
 	if (buffer_end > buffer_max_used) {
 		buffer_max_used = buffer_end;
 	}
@@ -307,6 +315,15 @@ MessageQueue::MessageQueue() {
 	buffer = memnew_arr(uint8_t, buffer_size);
 }
 
+MessageQueue::MessageQueue(uint32_t p_size_kb) {
+	flushing = false;
+
+	buffer_end = 0;
+	buffer_max_used = 0;
+	buffer_size = p_size_kb * 1024;
+	buffer = memnew_arr(uint8_t, buffer_size);
+}
+
 MessageQueue::~MessageQueue() {
 	uint32_t read_pos = 0;
 
@@ -327,6 +344,8 @@ MessageQueue::~MessageQueue() {
 		}
 	}
 
-	singleton = nullptr;
+	if (singleton == this) {
+		singleton = nullptr;
+	}
 	memdelete_arr(buffer);
 }
@@ -47,8 +47,13 @@ class MessageQueue {
 	bool flushing;
 
 public:
+	// The queue of the calling thread if it has one, the global queue otherwise.
 	static MessageQueue *get_singleton();
 
+	// Messages pushed from the calling thread go to p_queue (if not null) until it's set again,
+	// for threads that must hand them over to the main thread in a given order.
+	static void set_thread_queue(MessageQueue *p_queue);
+
 	Error push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error = false);
 	Error push_call(ObjectID p_id, const StringName &p_method, VARIANT_ARG_LIST);
 	Error push_notification(ObjectID p_id, int p_notification);
@@ -66,6 +71,7 @@ public:
 	int get_max_buffer_usage() const;
 
 	MessageQueue();
+	explicit MessageQueue(uint32_t p_size_kb); // Not the global queue.
 	~MessageQueue();
 };
 
@@ -17,18 +17,6 @@
 
 #ifdef DEBUG_ENABLED
 
-struct _ObjectDebugLock {
-	Object *obj;
-
-	_ObjectDebugLock(Object *p_obj) {
-		obj = p_obj;
-		obj->_lock_index.ref();
-	}
-	~_ObjectDebugLock() {
-		obj->_lock_index.unref();
-	}
-};
-
 #define OBJ_DEBUG_LOCK _ObjectDebugLock _debug_lock(this);
 
 #else
@@ -1160,18 +1148,22 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
 	//this happens automatically and will not change the performance of calling.
 	//awesome, isn't it?
-	VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	//it must only be read though, any non-const access makes a copy.
+	const VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
 
 	int ssize = slot_map.size();
 
 	OBJ_DEBUG_LOCK
 
+	// Arguments with binds, only allocated when there are too many for the stack.
+	const Variant *bind_stack[VARIANT_ARG_MAX * 2];
 	Vector<const Variant *> bind_mem;
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slot_map.getv(i);
+		const Connection &c = slot.conn;
 
 		Object *target = ObjectDB::get_instance(slot_map.getk(i)._id);
 		if (!target) {
@@ -1184,25 +1176,44 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
+			int bind_argc = p_argcount + c.binds.size();
+			const Variant **bind_args = bind_stack;
+			if (bind_argc > (int)(sizeof(bind_stack) / sizeof(bind_stack[0]))) {
+				bind_mem.resize(bind_argc);
+				bind_args = bind_mem.ptrw();
+			}
 
 			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
+				bind_args[j] = p_args[j];
 			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+				bind_args[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_args;
+			argc = bind_argc;
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
 			MessageQueue::get_singleton()->push_call(target->get_instance_id(), c.method, args, argc, true);
 		} else {
+			// Targets without a script are called through their native method directly, skipping the
+			// lookup by name done by call(). The method of an object's class can't change.
+			if (!slot.method_resolved) {
+				slot.method_bind = ClassDB::get_method(target->get_class_name(), c.method);
+				slot.method_resolved = true;
+			}
+
 			Variant::CallError ce;
 			_emitting = true;
-			target->call(c.method, args, argc, ce);
+			if (slot.method_bind && !target->get_script_instance()) {
+#ifdef DEBUG_ENABLED
+				_ObjectDebugLock target_lock(target);
+#endif
+				slot.method_bind->call(target, args, argc, ce);
+			} else {
+				target->call(c.method, args, argc, ce);
+			}
 			_emitting = false;
 
 			if (ce.error != Variant::CallError::CALL_OK) {
@@ -1419,6 +1430,19 @@ void Object::get_signals_connected_to_this(List<Connection> *p_connections) cons
 	}
 }
 
+void Object::disconnect_all() {
+	List<Connection> outgoing;
+	get_all_signal_connections(&outgoing);
+	for (List<Connection>::Element *E = outgoing.front(); E; E = E->next()) {
+		_disconnect(E->get().signal, E->get().target, E->get().method, true);
+	}
+
+	while (connections.size()) {
+		Connection c = connections.front()->get();
+		c.source->_disconnect(c.signal, c.target, c.method, true);
+	}
+}
+
 Error Object::connect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method, const Vector<Variant> &p_binds, uint32_t p_flags) {
 	ERR_FAIL_NULL_V(p_to_object, ERR_INVALID_PARAMETER);
 
@@ -376,6 +376,7 @@ public:                                                        \
                                                                \
 private:
 
+class MethodBind;
 class ScriptInstance;
 class ObjectRC;
 
@@ -438,7 +439,17 @@ private:
 			int reference_count;
 			Connection conn;
 			List<Connection>::Element *cE;
-			Slot() { reference_count = 0; }
+
+			// Native method of the target, resolved on the first emission. Shared by the copies of
+			// the slot map made while emitting, hence mutable.
+			mutable MethodBind *method_bind;
+			mutable bool method_resolved;
+
+			Slot() {
+				reference_count = 0;
+				method_bind = nullptr;
+				method_resolved = false;
+			}
 		};
 
 		MethodInfo user;
@@ -695,6 +706,7 @@ public:
 	Error connect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method, const Vector<Variant> &p_binds = Vector<Variant>(), uint32_t p_flags = 0);
 	void disconnect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method);
 	bool is_connected(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method) const;
+	void disconnect_all(); // From and to this object, reference counted connections included.
 
 	void call_deferred(const StringName &p_method, VARIANT_ARG_LIST);
 	void set_deferred(const StringName &p_property, const Variant &p_value);
@@ -736,6 +748,24 @@ public:
 	virtual ~Object();
 };
 
+#ifdef DEBUG_ENABLED
+
+// Keeps the object from being freed while one of its methods runs (see Object::call).
+// Public so script languages that call a resolved method directly can do the same.
+struct _ObjectDebugLock {
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+
+#endif
+
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
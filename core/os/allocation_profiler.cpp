@@ -0,0 +1,141 @@
+/**************************************************************************/
+/*  allocation_profiler.cpp                                               */
+/**************************************************************************/
+
+
+#include "allocation_profiler.h"
+
+#include "core/local_vector.h"
+#include "core/os/memory.h"
+#include "core/sort_array.h"
+#include "core/ustring.h"
+
+SafeFlag AllocationProfiler::enabled;
+SpinLock AllocationProfiler::lock;
+
+AllocationProfiler::Site AllocationProfiler::sites[MAX_SITES];
+uint32_t AllocationProfiler::num_sites = 0;
+uint64_t AllocationProfiler::overflow_count = 0;
+
+uint64_t AllocationProfiler::frames = 0;
+uint64_t AllocationProfiler::frame_begin_count = 0;
+uint64_t AllocationProfiler::frame_begin_bytes = 0;
+uint64_t AllocationProfiler::last_frame_count = 0;
+uint64_t AllocationProfiler::last_frame_bytes = 0;
+
+static const char *untagged_site = "(untagged)";
+
+void AllocationProfiler::record(size_t p_bytes, const char *p_site) {
+	if (!p_site || !p_site[0]) {
+		p_site = untagged_site;
+	}
+
+	// Sites are string literals, so the pointer identifies them.
+	uint32_t h = (uint32_t)((((uint64_t)(uintptr_t)p_site) >> 3) * 2654435761u);
+
+	lock.lock();
+
+	for (uint32_t n = 0; n < MAX_SITES; n++) {
+		Site &s = sites[(h + n) & (MAX_SITES - 1)];
+		if (s.site == p_site) {
+			s.count++;
+			s.bytes += p_bytes;
+			lock.unlock();
+			return;
+		}
+		if (!s.site) {
+			// Keep the table at most 3/4 full so probing stays short.
+			if (num_sites >= (MAX_SITES / 4) * 3) {
+				break;
+			}
+			s.site = p_site;
+			s.count = 1;
+			s.bytes = p_bytes;
+			num_sites++;
+			lock.unlock();
+			return;
+		}
+	}
+
+	overflow_count++;
+	lock.unlock();
+}
+
+void AllocationProfiler::set_enabled(bool p_enabled) {
+	enabled.set_to(p_enabled);
+}
+
+void AllocationProfiler::clear() {
+	lock.lock();
+	for (uint32_t n = 0; n < MAX_SITES; n++) {
+		sites[n].site = nullptr;
+	}
+	num_sites = 0;
+	overflow_count = 0;
+	frames = 0;
+	lock.unlock();
+}
+
+void AllocationProfiler::frame_end() {
+	uint64_t count = Memory::get_total_alloc_count();
+	uint64_t bytes = Memory::get_total_alloc_bytes();
+
+	last_frame_count = count - frame_begin_count;
+	last_frame_bytes = bytes - frame_begin_bytes;
+	frame_begin_count = count;
+	frame_begin_bytes = bytes;
+
+	if (is_enabled()) {
+		frames++;
+	}
+}
+
+struct _AllocationSiteSort {
+	_FORCE_INLINE_ bool operator()(const AllocationProfiler::Site &p_a, const AllocationProfiler::Site &p_b) const {
+		return p_a.count > p_b.count;
+	}
+};
+
+String AllocationProfiler::get_report(int p_max_sites) {
+	// Allocate before taking the lock, recording this allocation needs it.
+	LocalVector<Site> copy;
+	copy.resize(MAX_SITES);
+
+	lock.lock();
+	uint32_t count = 0;
+	for (uint32_t n = 0; n < MAX_SITES; n++) {
+		if (sites[n].site) {
+			copy[count++] = sites[n];
+		}
+	}
+	uint64_t overflow = overflow_count;
+	uint64_t num_frames = frames;
+	lock.unlock();
+
+	SortArray<Site, _AllocationSiteSort> sorter;
+	sorter.sort(copy.ptr(), count);
+
+	uint64_t total_count = overflow;
+	uint64_t total_bytes = 0;
+	for (uint32_t n = 0; n < count; n++) {
+		total_count += copy[n].count;
+		total_bytes += copy[n].bytes;
+	}
+
+	String report = "Allocations: " + itos(total_count) + " (" + String::humanize_size(total_bytes) + ") over " + itos(num_frames) + " frames, " + itos(count) + " call sites.\n";
+	report += "Last frame: " + itos(last_frame_count) + " allocations (" + String::humanize_size(last_frame_bytes) + ").\n";
+	report += String("Count").lpad(12) + String("Per frame").lpad(12) + String("Bytes").lpad(12) + "  Site\n";
+
+	uint32_t num_listed = MIN(count, (uint32_t)MAX(p_max_sites, 0));
+	for (uint32_t n = 0; n < num_listed; n++) {
+		const Site &s = copy[n];
+		String per_frame = num_frames ? String::num((double)s.count / num_frames, 2) : String("-");
+		report += itos(s.count).lpad(12) + per_frame.lpad(12) + String::humanize_size(s.bytes).lpad(12) + "  " + String(s.site) + "\n";
+	}
+
+	if (overflow) {
+		report += itos(overflow).lpad(12) + String("-").lpad(12) + String("-").lpad(12) + "  (sites not tracked, table full)\n";
+	}
+
+	return report;
+}
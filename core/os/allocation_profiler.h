@@ -0,0 +1,66 @@
+/**************************************************************************/
+/*  allocation_profiler.h                                                 */
+/**************************************************************************/
+
+
+#ifndef ALLOCATION_PROFILER_H
+#define ALLOCATION_PROFILER_H
+
+#include "core/os/spin_lock.h"
+#include "core/safe_refcount.h"
+#include "core/typedefs.h"
+
+class String;
+
+// Attributes heap allocations to the call sites that made them.
+// While this profiler is enabled, Memory keeps running totals (so allocations per frame can be
+// shown as a monitor) and every allocation is also counted against its call site,
+// as recorded by memnew / memalloc / memrealloc / memnew_arr in debug builds (file:line).
+// Allocations made without a site (containers calling Memory directly, or release builds)
+// are grouped together as untagged.
+// This must not allocate while recording, so sites are kept in a fixed size table.
+class AllocationProfiler {
+public:
+	enum {
+		MAX_SITES = 4096, // power of 2
+	};
+
+	struct Site {
+		const char *site;
+		uint64_t count;
+		uint64_t bytes;
+	};
+
+private:
+	static SafeFlag enabled;
+	static SpinLock lock;
+
+	static Site sites[MAX_SITES];
+	static uint32_t num_sites;
+	static uint64_t overflow_count; // allocations from new sites once the table is full
+
+	static uint64_t frames;
+	static uint64_t frame_begin_count;
+	static uint64_t frame_begin_bytes;
+	static uint64_t last_frame_count;
+	static uint64_t last_frame_bytes;
+
+public:
+	_FORCE_INLINE_ static bool is_enabled() { return enabled.is_set(); }
+
+	static void record(size_t p_bytes, const char *p_site);
+
+	static void set_enabled(bool p_enabled);
+	static void clear();
+
+	// Called once per main loop iteration.
+	static void frame_end();
+
+	static uint64_t get_frame_alloc_count() { return last_frame_count; }
+	static uint64_t get_frame_alloc_bytes() { return last_frame_bytes; }
+
+	// Sites sorted by number of allocations, most frequent first.
+	static String get_report(int p_max_sites = 20);
+};
+
+#endif // ALLOCATION_PROFILER_H
@@ -0,0 +1,187 @@
+/**************************************************************************/
+/*  frame_profiler.cpp                                                    */
+/**************************************************************************/
+
+
+#include "frame_profiler.h"
+
+#include "core/os/file_access.h"
+
+FrameProfiler *FrameProfiler::singleton = nullptr;
+SafeFlag FrameProfiler::capturing;
+SafeNumeric<uint32_t> FrameProfiler::generation(1);
+
+// Each thread caches its buffer, the generation is bumped whenever the buffers are freed
+// so threads register a new one on their next event.
+static thread_local FrameProfiler::ThreadBuffer *tls_buffer = nullptr;
+static thread_local uint32_t tls_generation = 0;
+
+FrameProfiler::ThreadBuffer *FrameProfiler::_get_thread_buffer(uint32_t &r_generation) {
+	uint32_t current_generation = generation.get();
+	r_generation = current_generation;
+	if (likely(tls_generation == current_generation)) {
+		return tls_buffer;
+	}
+
+	tls_buffer = nullptr;
+	tls_generation = current_generation;
+	if (!singleton) {
+		return nullptr;
+	}
+
+	// First event of this thread in the capture, the only time the mutex is taken.
+	MutexLock lock(singleton->mutex);
+
+	ThreadBuffer *tb = memnew(ThreadBuffer);
+	tb->thread_id = Thread::get_caller_id();
+	tb->events = memnew_arr(Event, singleton->buffer_size);
+	tb->mask = singleton->buffer_size - 1;
+	tb->num_written.set(0);
+	tb->writing.set(0);
+	singleton->thread_buffers.push_back(tb);
+
+	tls_buffer = tb;
+	return tb;
+}
+
+void FrameProfiler::_free_buffers() {
+	// Only called while not capturing. Threads that checked the capture before it stopped may
+	// still be recording, the new generation makes them register a new buffer next time.
+	generation.increment();
+
+	// A thread marks its buffer before it checks the generation, so once the buffer is seen
+	// unmarked its thread won't write to the events anymore. It may still mark the buffer itself,
+	// so the buffer is kept until the profiler is destroyed.
+	MutexLock lock(mutex);
+	for (uint32_t n = 0; n < thread_buffers.size(); n++) {
+		ThreadBuffer *tb = thread_buffers[n];
+		while (tb->writing.get() > 0) {
+			OS::get_singleton()->delay_usec(1);
+		}
+		memdelete_arr(tb->events);
+		tb->events = nullptr;
+		retired_buffers.push_back(tb);
+	}
+	thread_buffers.clear();
+}
+
+void FrameProfiler::start() {
+	ERR_FAIL_COND_MSG(is_active(), "The frame profiler is already capturing.");
+
+	_free_buffers();
+	capture_begin_usec = OS::get_singleton()->get_ticks_usec();
+	capturing.set();
+}
+
+void FrameProfiler::stop() {
+	capturing.clear();
+}
+
+bool FrameProfiler::is_capturing() const {
+	return is_active();
+}
+
+void FrameProfiler::clear() {
+	ERR_FAIL_COND_MSG(is_active(), "Stop the frame profiler capture before clearing it.");
+	_free_buffers();
+}
+
+void FrameProfiler::set_buffer_size(int p_events) {
+	ERR_FAIL_COND(p_events < 1);
+	buffer_size = next_power_of_2(p_events);
+}
+
+int FrameProfiler::get_buffer_size() const {
+	return buffer_size;
+}
+
+int FrameProfiler::get_event_count() const {
+	MutexLock lock(mutex);
+
+	uint64_t count = 0;
+	for (uint32_t n = 0; n < thread_buffers.size(); n++) {
+		const ThreadBuffer *tb = thread_buffers[n];
+		count += MIN(tb->num_written.get(), (uint64_t)tb->mask + 1);
+	}
+	return count;
+}
+
+int FrameProfiler::get_thread_event_count(Thread::ID p_thread) const {
+	MutexLock lock(mutex);
+
+	uint64_t count = 0;
+	for (uint32_t n = 0; n < thread_buffers.size(); n++) {
+		const ThreadBuffer *tb = thread_buffers[n];
+		if (tb->thread_id == p_thread) {
+			count += MIN(tb->num_written.get(), (uint64_t)tb->mask + 1);
+		}
+	}
+	return count;
+}
+
+Error FrameProfiler::save_chrome_trace(const String &p_path) {
+	ERR_FAIL_COND_V_MSG(is_active(), ERR_BUSY, "Stop the frame profiler capture before saving it.");
+
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Cannot save frame profiler capture to file '" + p_path + "'.");
+
+	MutexLock lock(mutex);
+
+	f->store_string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	f->store_string("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Godot\"}}");
+
+	for (uint32_t n = 0; n < thread_buffers.size(); n++) {
+		const ThreadBuffer *tb = thread_buffers[n];
+		// Chrome expects small thread ids, the buffer index is used instead of the (hashed) Thread::ID.
+		String tid = itos(n + 1);
+		String thread_name = tb->thread_id == Thread::get_main_id() ? String("Main Thread") : "Thread " + tid;
+		f->store_string(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"" + thread_name + "\"}}");
+
+		uint64_t capacity = (uint64_t)tb->mask + 1;
+		uint64_t num_written = tb->num_written.get();
+		uint64_t first = num_written > capacity ? num_written - capacity : 0;
+		for (uint64_t i = first; i < num_written; i++) {
+			const Event &e = tb->events[i & tb->mask];
+			String name = String(e.name).json_escape();
+			uint64_t ts = e.begin_usec >= capture_begin_usec ? e.begin_usec - capture_begin_usec : 0;
+			f->store_string(",\n{\"name\":\"" + name + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + uitos(ts) + ",\"dur\":" + uitos(e.end_usec - e.begin_usec) + "}");
+		}
+	}
+
+	f->store_string("\n]}\n");
+	f->close();
+
+	return OK;
+}
+
+void FrameProfiler::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start"), &FrameProfiler::start);
+	ClassDB::bind_method(D_METHOD("stop"), &FrameProfiler::stop);
+	ClassDB::bind_method(D_METHOD("is_capturing"), &FrameProfiler::is_capturing);
+	ClassDB::bind_method(D_METHOD("clear"), &FrameProfiler::clear);
+	ClassDB::bind_method(D_METHOD("set_buffer_size", "events"), &FrameProfiler::set_buffer_size);
+	ClassDB::bind_method(D_METHOD("get_buffer_size"), &FrameProfiler::get_buffer_size);
+	ClassDB::bind_method(D_METHOD("get_event_count"), &FrameProfiler::get_event_count);
+	ClassDB::bind_method(D_METHOD("save_chrome_trace", "path"), &FrameProfiler::save_chrome_trace);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "buffer_size", PROPERTY_HINT_RANGE, "1024,4194304,1"), "set_buffer_size", "get_buffer_size");
+}
+
+FrameProfiler::FrameProfiler() {
+	ERR_FAIL_COND_MSG(singleton, "Singleton for FrameProfiler already exists.");
+	singleton = this;
+	buffer_size = 65536;
+	capture_begin_usec = 0;
+}
+
+FrameProfiler::~FrameProfiler() {
+	capturing.clear();
+	_free_buffers();
+
+	// Destroyed at exit, once the other threads stopped recording.
+	for (uint32_t n = 0; n < retired_buffers.size(); n++) {
+		memdelete(retired_buffers[n]);
+	}
+	singleton = nullptr;
+}
@@ -0,0 +1,139 @@
+/**************************************************************************/
+/*  frame_profiler.h                                                      */
+/**************************************************************************/
+
+
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include "core/local_vector.h"
+#include "core/object.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+// Low overhead CPU timeline capture.
+// Engine code marks hot paths with FRAME_PROFILE_SCOPE("Class::function"). While a capture
+// is running, every scope records a (name, begin, end) event into a ring buffer owned by
+// the calling thread, so recording never takes a lock. When no capture is running a scope
+// costs a single flag check. Each buffer is marked while its thread writes to it, so the events are
+// only freed once no thread can still be writing them. The capture can be saved in the Chrome trace
+// event format, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+// Scope names must be string literals (or otherwise outlive the capture), only the pointer is stored.
+
+class FrameProfiler : public Object {
+	GDCLASS(FrameProfiler, Object);
+
+public:
+	struct Event {
+		const char *name;
+		uint64_t begin_usec;
+		uint64_t end_usec;
+	};
+
+	// Only written by the owning thread, read when saving.
+	struct ThreadBuffer {
+		Thread::ID thread_id;
+		Event *events;
+		uint32_t mask;
+		SafeNumeric<uint64_t> num_written; // wraps around the ring, the oldest events are overwritten
+		SafeNumeric<uint32_t> writing; // Set while the owning thread is inside record().
+	};
+
+private:
+	static FrameProfiler *singleton;
+	static SafeFlag capturing;
+	static SafeNumeric<uint32_t> generation;
+
+	mutable Mutex mutex;
+	LocalVector<ThreadBuffer *> thread_buffers;
+	LocalVector<ThreadBuffer *> retired_buffers; // Events freed, threads may still hold a pointer.
+	uint32_t buffer_size;
+	uint64_t capture_begin_usec;
+
+	static ThreadBuffer *_get_thread_buffer(uint32_t &r_generation);
+	void _free_buffers();
+
+protected:
+	static void _bind_methods();
+
+public:
+	static FrameProfiler *get_singleton() { return singleton; }
+
+	_FORCE_INLINE_ static bool is_active() { return capturing.is_set(); }
+
+	_FORCE_INLINE_ static void record(const char *p_name, uint64_t p_begin_usec, uint64_t p_end_usec) {
+		uint32_t buffer_generation;
+		ThreadBuffer *tb = _get_thread_buffer(buffer_generation);
+		if (!tb) {
+			return;
+		}
+
+		// Marked before checking the generation again, so the events can't be freed meanwhile.
+		// Only this thread touches the mark, it doesn't contend with other threads.
+		tb->writing.increment();
+		if (generation.get() == buffer_generation && capturing.is_set()) {
+			// Only this thread writes the count, no need for an atomic increment.
+			uint64_t n = tb->num_written.get();
+			Event &e = tb->events[n & tb->mask];
+			e.name = p_name;
+			e.begin_usec = p_begin_usec;
+			e.end_usec = p_end_usec;
+			tb->num_written.set(n + 1);
+		}
+		tb->writing.decrement();
+	}
+
+	void start();
+	void stop();
+	bool is_capturing() const;
+	void clear();
+
+	// Events kept per thread, rounded up to a power of 2. Applies to buffers created after the call.
+	void set_buffer_size(int p_events);
+	int get_buffer_size() const;
+
+	int get_event_count() const;
+	int get_thread_event_count(Thread::ID p_thread) const;
+	Error save_chrome_trace(const String &p_path);
+
+	FrameProfiler();
+	~FrameProfiler();
+};
+
+class FrameProfilerScope {
+	const char *name;
+	uint64_t begin_usec;
+
+public:
+	_FORCE_INLINE_ FrameProfilerScope(const char *p_name) {
+		if (FrameProfiler::is_active()) {
+			name = p_name;
+			begin_usec = OS::get_singleton()->get_ticks_usec();
+		} else {
+			name = nullptr;
+		}
+	}
+
+	_FORCE_INLINE_ ~FrameProfilerScope() {
+		if (name && FrameProfiler::is_active()) {
+			FrameProfiler::record(name, begin_usec, OS::get_singleton()->get_ticks_usec());
+		}
+	}
+};
+
+#define _FRAME_PROFILE_JOIN2(m_a, m_b) m_a##m_b
+#define _FRAME_PROFILE_JOIN(m_a, m_b) _FRAME_PROFILE_JOIN2(m_a, m_b)
+
+// Times the rest of the enclosing block.
+#define FRAME_PROFILE_SCOPE(m_name) FrameProfilerScope _FRAME_PROFILE_JOIN(_frame_profile_scope_, __LINE__)(m_name)
+
+// Records an interval that was already timed by the caller, to avoid reading the clock twice.
+#define FRAME_PROFILE_EVENT(m_name, m_begin_usec, m_end_usec)    \
+	if (FrameProfiler::is_active()) {                            \
+		FrameProfiler::record(m_name, m_begin_usec, m_end_usec); \
+	} else                                                       \
+		((void)0)
+
+#endif // FRAME_PROFILER_H
@@ -6,13 +6,14 @@
 #include "memory.h"
 
 #include "core/error_macros.h"
+#include "core/os/allocation_profiler.h"
 #include "core/safe_refcount.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
 void *operator new(size_t p_size, const char *p_description) {
-	return Memory::alloc_static(p_size, false);
+	return Memory::alloc_static(p_size, false, p_description);
 }
 
 void *operator new(size_t p_size, void *(*p_allocfunc)(size_t p_size)) {
@@ -39,8 +40,10 @@ SafeNumeric<uint64_t> Memory::max_usage;
 #endif
 
 SafeNumeric<uint64_t> Memory::alloc_count;
+SafeNumeric<uint64_t> Memory::total_alloc_count;
+SafeNumeric<uint64_t> Memory::total_alloc_bytes;
 
-void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
+void *Memory::alloc_static(size_t p_bytes, bool p_pad_align, const char *p_site) {
 #ifdef DEBUG_ENABLED
 	bool prepad = true;
 #else
@@ -53,6 +56,12 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
 	alloc_count.increment();
 
+	if (unlikely(AllocationProfiler::is_enabled())) {
+		total_alloc_count.increment();
+		total_alloc_bytes.add(p_bytes);
+		AllocationProfiler::record(p_bytes, p_site);
+	}
+
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
 		*s = p_bytes;
@@ -69,9 +78,16 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 	}
 }
 
-void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
+void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align, const char *p_site) {
 	if (p_memory == nullptr) {
-		return alloc_static(p_bytes, p_pad_align);
+		return alloc_static(p_bytes, p_pad_align, p_site);
+	}
+
+	// reallocations are counted, growing containers is a common source of per frame allocations
+	if (p_bytes && unlikely(AllocationProfiler::is_enabled())) {
+		total_alloc_count.increment();
+		total_alloc_bytes.add(p_bytes);
+		AllocationProfiler::record(p_bytes, p_site);
 	}
 
 	uint8_t *mem = (uint8_t *)p_memory;
@@ -166,6 +182,14 @@ uint64_t Memory::get_mem_max_usage() {
 #endif
 }
 
+uint64_t Memory::get_total_alloc_count() {
+	return total_alloc_count.get();
+}
+
+uint64_t Memory::get_total_alloc_bytes() {
+	return total_alloc_bytes.get();
+}
+
 _GlobalNil::_GlobalNil() {
 	color = 1;
 	left = this;
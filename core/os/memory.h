@@ -24,14 +24,23 @@ class Memory {
 
 	static SafeNumeric<uint64_t> alloc_count;
 
+	// running totals (never decremented), used to measure allocations per frame
+	// only counted while the AllocationProfiler is enabled, to keep allocations cheap otherwise
+	static SafeNumeric<uint64_t> total_alloc_count;
+	static SafeNumeric<uint64_t> total_alloc_bytes;
+
 public:
-	static void *alloc_static(size_t p_bytes, bool p_pad_align = false);
-	static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false);
+	// p_site is a static string identifying the call site (see MEMORY_SITE), used by the AllocationProfiler
+	static void *alloc_static(size_t p_bytes, bool p_pad_align = false, const char *p_site = nullptr);
+	static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false, const char *p_site = nullptr);
 	static void free_static(void *p_ptr, bool p_pad_align = false);
 
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+
+	static uint64_t get_total_alloc_count();
+	static uint64_t get_total_alloc_bytes();
 };
 
 class DefaultAllocator {
@@ -53,8 +62,15 @@ void operator delete(void *p_mem, void *(*p_allocfunc)(size_t p_size));
 void operator delete(void *p_mem, void *p_pointer, size_t check, const char *p_description);
 #endif
 
-#define memalloc(m_size) Memory::alloc_static(m_size)
-#define memrealloc(m_mem, m_size) Memory::realloc_static(m_mem, m_size)
+// Call sites are only recorded in debug builds, to keep the strings out of release binaries.
+#ifdef DEBUG_ENABLED
+#define MEMORY_SITE __FILE__ ":" _MKSTR(__LINE__)
+#else
+#define MEMORY_SITE ""
+#endif
+
+#define memalloc(m_size) Memory::alloc_static(m_size, false, MEMORY_SITE)
+#define memrealloc(m_mem, m_size) Memory::realloc_static(m_mem, m_size, false, MEMORY_SITE)
 #define memfree(m_mem) Memory::free_static(m_mem)
 
 _ALWAYS_INLINE_ void postinitialize_handler(void *) {}
@@ -65,7 +81,7 @@ _ALWAYS_INLINE_ T *_post_initialize(T *p_obj) {
 	return p_obj;
 }
 
-#define memnew(m_class) _post_initialize(new ("") m_class)
+#define memnew(m_class) _post_initialize(new (MEMORY_SITE) m_class)
 
 _ALWAYS_INLINE_ void *operator new(size_t p_size, void *p_pointer, size_t check, const char *p_description) {
 	//void *failptr=0;
@@ -111,7 +127,7 @@ void memdelete_allocator(T *p_class) {
 			memdelete(m_v);    \
 	}
 
-#define memnew_arr(m_class, m_count) memnew_arr_template<m_class>(m_count)
+#define memnew_arr(m_class, m_count) memnew_arr_template<m_class>(m_count, MEMORY_SITE)
 
 template <typename T>
 T *memnew_arr_template(size_t p_elements, const char *p_descr = "") {
@@ -122,7 +138,7 @@ T *memnew_arr_template(size_t p_elements, const char *p_descr = "") {
 	same strategy used by std::vector, and the PoolVector class, so it should be safe.*/
 
 	size_t len = sizeof(T) * p_elements;
-	uint64_t *mem = (uint64_t *)Memory::alloc_static(len, true);
+	uint64_t *mem = (uint64_t *)Memory::alloc_static(len, true, p_descr);
 	T *failptr = nullptr; //get rid of a warning
 	ERR_FAIL_COND_V(!mem, failptr);
 	*(mem - 1) = p_elements;
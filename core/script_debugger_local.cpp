@@ -245,6 +245,14 @@ Pair<String, int> ScriptDebuggerLocal::to_breakpoint(const String &p_line) {
 	return breakpoint;
 }
 
+static String _inline_cache_hit_rate(const ScriptLanguage::ProfilingInfo &p_info) {
+	uint64_t lookups = p_info.inline_cache_hits + p_info.inline_cache_misses;
+	if (lookups == 0) {
+		return String();
+	}
+	return "\tcache hits: " + itos(p_info.inline_cache_hits * 100 / lookups) + " %";
+}
+
 struct _ScriptDebuggerLocalProfileInfoSort {
 	bool operator()(const ScriptLanguage::ProfilingInfo &A, const ScriptLanguage::ProfilingInfo &B) const {
 		return A.total_time > B.total_time;
@@ -299,7 +307,7 @@ void ScriptDebuggerLocal::idle_poll() {
 		print_line(itos(i) + ":" + pinfo[i].signature);
 		float tt = USEC_TO_SEC(pinfo[i].total_time);
 		float st = USEC_TO_SEC(pinfo[i].self_time);
-		print_line("\ttotal: " + rtos(tt) + "/" + itos(tt * 100 / total_time) + " % \tself: " + rtos(st) + "/" + itos(st * 100 / total_time) + " % tcalls: " + itos(pinfo[i].call_count));
+		print_line("\ttotal: " + rtos(tt) + "/" + itos(tt * 100 / total_time) + " % \tself: " + rtos(st) + "/" + itos(st * 100 / total_time) + " % tcalls: " + itos(pinfo[i].call_count) + _inline_cache_hit_rate(pinfo[i]));
 	}
 }
 
@@ -338,7 +346,7 @@ void ScriptDebuggerLocal::profiling_end() {
 		print_line(itos(i) + ":" + pinfo[i].signature);
 		float tt = USEC_TO_SEC(pinfo[i].total_time);
 		float st = USEC_TO_SEC(pinfo[i].self_time);
-		print_line("\ttotal_ms: " + rtos(tt) + "\tself_ms: " + rtos(st) + "total%: " + itos(tt * 100 / total_time) + "\tself%: " + itos(st * 100 / total_time) + "\tcalls: " + itos(pinfo[i].call_count));
+		print_line("\ttotal_ms: " + rtos(tt) + "\tself_ms: " + rtos(st) + "total%: " + itos(tt * 100 / total_time) + "\tself%: " + itos(st * 100 / total_time) + "\tcalls: " + itos(pinfo[i].call_count) + _inline_cache_hit_rate(pinfo[i]));
 	}
 
 	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
@@ -314,6 +314,8 @@ public:
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
+	// Optional, loads ahead of time the scripts used by the given resources (autoloads and main scene at startup).
+	virtual void preload_scripts(const Vector<String> &p_paths) {}
 	virtual void get_public_functions(List<MethodInfo> *p_functions) const = 0;
 	virtual void get_public_constants(List<Pair<String, Variant>> *p_constants) const = 0;
 
@@ -322,6 +324,16 @@ public:
 		uint64_t call_count;
 		uint64_t total_time;
 		uint64_t self_time;
+		// Lookups served by (or missing) the per call site caches of languages that have them.
+		uint64_t inline_cache_hits;
+		uint64_t inline_cache_misses;
+
+		ProfilingInfo() :
+				call_count(0),
+				total_time(0),
+				self_time(0),
+				inline_cache_hits(0),
+				inline_cache_misses(0) {}
 	};
 
 	virtual void profiling_start() = 0;
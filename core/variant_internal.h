@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*  variant_internal.h                                                    */
+/**************************************************************************/
+
+
+#ifndef VARIANT_INTERNAL_H
+#define VARIANT_INTERNAL_H
+
+#include "core/variant.h"
+
+// Direct access to the payload of a Variant.
+// Meant for interpreters that already checked the type of the Variant (getters)
+// or that are writing a value of a type that doesn't allocate (setters),
+// so the conversions and the type switch of the regular API can be skipped.
+
+struct VariantInternal {
+	_FORCE_INLINE_ static const bool *get_bool(const Variant *v) { return &v->_data._bool; }
+	_FORCE_INLINE_ static const int64_t *get_int(const Variant *v) { return &v->_data._int; }
+	_FORCE_INLINE_ static const double *get_real(const Variant *v) { return &v->_data._real; }
+	_FORCE_INLINE_ static const Vector2 *get_vector2(const Variant *v) { return reinterpret_cast<const Vector2 *>(v->_data._mem); }
+
+	_FORCE_INLINE_ static void set_bool(Variant *v, bool p_value) {
+		_set_type(v, Variant::BOOL);
+		v->_data._bool = p_value;
+	}
+	_FORCE_INLINE_ static void set_int(Variant *v, int64_t p_value) {
+		_set_type(v, Variant::INT);
+		v->_data._int = p_value;
+	}
+	_FORCE_INLINE_ static void set_real(Variant *v, double p_value) {
+		_set_type(v, Variant::REAL);
+		v->_data._real = p_value;
+	}
+	_FORCE_INLINE_ static void set_vector2(Variant *v, const Vector2 &p_value) {
+		_set_type(v, Variant::VECTOR2);
+		*reinterpret_cast<Vector2 *>(v->_data._mem) = p_value;
+	}
+
+	// Makes the Variant hold the given type, the value is reset to the default one if the type changes.
+	static void initialize(Variant *v, Variant::Type p_type) {
+		if (v->type != p_type) {
+			Variant::CallError ce;
+			*v = Variant::construct(p_type, nullptr, 0, ce);
+		}
+	}
+
+	// Pointer to the value as passed to MethodBind::ptrcall() (see PtrToArg), nullptr for objects.
+	static const void *get_opaque_pointer(const Variant *v) {
+		switch (v->type) {
+			case Variant::NIL:
+			case Variant::OBJECT:
+			case Variant::VARIANT_MAX:
+				return nullptr;
+			case Variant::BOOL:
+				return &v->_data._bool;
+			case Variant::INT:
+				return &v->_data._int;
+			case Variant::REAL:
+				return &v->_data._real;
+			case Variant::TRANSFORM2D:
+				return v->_data._transform2d;
+			case Variant::AABB:
+				return v->_data._aabb;
+			case Variant::BASIS:
+				return v->_data._basis;
+			case Variant::TRANSFORM:
+				return v->_data._transform;
+			default:
+				return v->_data._mem; // everything else is stored in place
+		}
+	}
+	static void *get_opaque_pointer(Variant *v) { return const_cast<void *>(get_opaque_pointer(const_cast<const Variant *>(v))); }
+
+private:
+	// Only for types stored in place, the payload is left uninitialized.
+	_FORCE_INLINE_ static void _set_type(Variant *v, Variant::Type p_type) {
+		if (unlikely(v->type != p_type)) {
+			v->clear();
+			v->type = p_type;
+		}
+	}
+};
+
+#endif // VARIANT_INTERNAL_H
@@ -10,6 +10,7 @@
 #include "core/project_settings.h"
 #include "rasterizer_array.h"
 #include "rasterizer_asserts.h"
+#include "rasterizer_canvas_retained_cache.h"
 #include "rasterizer_storage_common.h"
 #include "servers/visual/rasterizer.h"
 
@@ -242,6 +243,25 @@ public:
 		Color final_modulate;
 	};
 
+	// prefilled data for a joined item, kept between frames in retained mode
+	struct BRetained {
+		LocalVector<Batch> batches;
+		LocalVector<BatchTex> batch_textures;
+		LocalVector<BatchVertex> vertices;
+		LocalVector<float> light_angles;
+		LocalVector<BatchColor> vertex_colors;
+		LocalVector<BatchColor> vertex_modulates;
+		LocalVector<BatchTransform> vertex_transforms;
+
+		int total_quads;
+		int total_verts;
+		int total_color_changes;
+		bool use_light_angles;
+		uint32_t sequence_batch_type_flags;
+	};
+
+	typedef RasterizerCanvasRetainedCache<BRetained> RetainedCache;
+
 	struct BLightRegion {
 		void reset() {
 			light_bitfield = 0;
@@ -293,6 +313,8 @@ public:
 			settings_uv_contract = false;
 			settings_uv_contract_amount = 0.0f;
 
+			settings_use_retained_batches = false;
+
 			buffer_mode_batch_upload_send_null = true;
 			buffer_mode_batch_upload_flag_stream = false;
 
@@ -424,6 +446,11 @@ public:
 		bool settings_uv_contract;
 		float settings_uv_contract_amount;
 
+		// retained mode, reuse the prefilled vertices of unchanged joined items
+		bool settings_use_retained_batches;
+		RetainedCache retained_cache;
+		LocalVector<typename RetainedCache::ItemKey> retained_keys;
+
 		// only done on diagnose frame
 		void reset_stats() {
 			stats_items_sorted = 0;
@@ -564,6 +591,12 @@ protected:
 	void render_joined_item_commands(const BItemJoined &p_bij, RasterizerCanvas::Item *p_current_clip, bool &r_reclip, typename T_STORAGE::Material *p_material, bool p_lit, const RenderItemState &p_ris);
 
 private:
+	// retained mode
+	bool _retained_build_keys(const BItemJoined &p_bij, bool p_lit);
+	void _retained_store(const BItemJoined &p_bij, bool p_lit, const FillState &p_fill_state);
+	bool _retained_restore(const BRetained &p_retained);
+	bool _retained_batch_tex_unchanged(const BatchTex &p_batch_tex) const;
+
 	// flush once full or end of joined item
 	void flush_render_batches(RasterizerCanvas::Item *p_first_item, RasterizerCanvas::Item *p_current_clip, bool &r_reclip, typename T_STORAGE::Material *p_material, uint32_t p_sequence_batch_type_flags);
 
@@ -680,6 +713,11 @@ protected:
 };
 
 PREAMBLE(void)::batch_canvas_begin() {
+	// evict retained items that have not been drawn recently
+	if (bdata.settings_use_retained_batches) {
+		bdata.retained_cache.begin_frame(Engine::get_singleton()->get_frames_drawn());
+	}
+
 	// diagnose_frame?
 	bdata.frame_string = ""; // just in case, always set this as we don't want a string leak in release...
 #if defined(TOOLS_ENABLED) && defined(DEBUG_ENABLED)
@@ -718,6 +756,10 @@ PREAMBLE(void)::batch_canvas_end() {
 		if (bdata.stats_light_items_joined) {
 			bdata.frame_string += "\tlight items joined: " + itos(bdata.stats_light_items_joined) + "\n";
 		}
+		if (bdata.settings_use_retained_batches) {
+			const typename RetainedCache::Stats &rs = bdata.retained_cache.get_stats();
+			bdata.frame_string += "\tretained hits: " + itos(rs.hits) + ", misses: " + itos(rs.misses) + ", stored: " + itos(rs.stores) + ", evicted: " + itos(rs.evictions) + "\n";
+		}
 
 		print_line(bdata.frame_string);
 	}
@@ -1002,6 +1044,8 @@ PREAMBLE(void)::batch_initialize() {
 	bdata.settings_item_reordering_lookahead = GLOBAL_GET("rendering/batching/parameters/item_reordering_lookahead");
 	bdata.settings_light_max_join_items = GLOBAL_GET("rendering/batching/lights/max_join_items");
 	bdata.settings_use_single_rect_fallback = GLOBAL_GET("rendering/batching/options/single_rect_fallback");
+	bdata.settings_use_retained_batches = GLOBAL_GET("rendering/batching/options/use_retained_batches");
+	bdata.retained_cache.set_max_age(GLOBAL_GET("rendering/batching/parameters/retained_max_age_frames"));
 	bdata.settings_use_software_skinning = GLOBAL_GET("rendering/2d/options/use_software_skinning");
 	bdata.settings_ninepatch_mode = GLOBAL_GET("rendering/2d/options/ninepatch_mode");
 
@@ -1119,6 +1163,7 @@ PREAMBLE(void)::batch_initialize() {
 		batching_options_string += "\titem_reordering_lookahead " + itos(bdata.settings_item_reordering_lookahead) + "\n";
 		batching_options_string += "\tlight_max_join_items " + itos(bdata.settings_light_max_join_items) + "\n";
 		batching_options_string += "\tsingle_rect_fallback " + String(Variant(bdata.settings_use_single_rect_fallback)) + "\n";
+		batching_options_string += "\tretained_batches " + String(Variant(bdata.settings_use_retained_batches)) + "\n";
 		batching_options_string += "\tdebug_flash " + String(Variant(bdata.settings_flash_batching)) + "\n";
 		batching_options_string += "\tdiagnose_frame " + String(Variant(bdata.settings_diagnose_frame));
 		print_verbose(batching_options_string);
@@ -2539,6 +2584,23 @@ PREAMBLE(void)::render_joined_item_commands(const BItemJoined &p_bij, Rasterizer
 		fill_state.extra_matrix_sent = true;
 	}
 
+	// retained mode, if none of the items have changed since they were last drawn,
+	// we can skip the prefill and send the vertices from last time
+	bool retain = false;
+	if (bdata.settings_use_retained_batches) {
+		retain = _retained_build_keys(p_bij, p_lit);
+
+		if (retain) {
+			const BRetained *retained = bdata.retained_cache.find(p_lit, p_bij.flags, bdata.retained_keys.ptr(), bdata.retained_keys.size());
+
+			if (retained && _retained_restore(*retained)) {
+				flush_render_batches(first_item, p_current_clip, r_reclip, p_material, retained->sequence_batch_type_flags);
+				bdata.reset_flush();
+				return;
+			}
+		}
+	}
+
 	for (unsigned int i = 0; i < p_bij.num_item_refs; i++) {
 		const BItemRef &ref = bdata.item_refs[p_bij.first_item_ref + i];
 		item = ref.item;
@@ -2590,6 +2652,9 @@ PREAMBLE(void)::render_joined_item_commands(const BItemJoined &p_bij, Rasterizer
 			bool bFull = get_this()->prefill_joined_item(fill_state, command_start, item, p_current_clip, r_reclip, p_material);
 
 			if (bFull) {
+				// can only retain joined items that fit in a single flush
+				retain = false;
+
 				// always pass first item (commands for default are always first item)
 				flush_render_batches(first_item, p_current_clip, r_reclip, p_material, fill_state.sequence_batch_type_flags);
 
@@ -2602,6 +2667,12 @@ PREAMBLE(void)::render_joined_item_commands(const BItemJoined &p_bij, Rasterizer
 		}
 	}
 
+	if (retain) {
+		_retained_store(p_bij, p_lit, fill_state);
+	} else if (bdata.settings_use_retained_batches) {
+		bdata.retained_cache.erase(first_item, p_lit);
+	}
+
 	// flush if any left
 	flush_render_batches(first_item, p_current_clip, r_reclip, p_material, fill_state.sequence_batch_type_flags);
 
@@ -2609,6 +2680,154 @@ PREAMBLE(void)::render_joined_item_commands(const BItemJoined &p_bij, Rasterizer
 	bdata.reset_flush();
 }
 
+PREAMBLE(bool)::_retained_build_keys(const BItemJoined &p_bij, bool p_lit) {
+	bdata.retained_keys.resize(p_bij.num_item_refs);
+
+	for (unsigned int i = 0; i < p_bij.num_item_refs; i++) {
+		const BItemRef &ref = bdata.item_refs[p_bij.first_item_ref + i];
+
+		// software skinned verts depend on the bone transforms, which are not tracked by the item
+		if (ref.item->skeleton.is_valid()) {
+			return false;
+		}
+
+		// the modulate must match the one used in the fill state
+		bdata.retained_keys[i].set(ref.item, p_lit ? ref.item->final_modulate : ref.final_modulate);
+	}
+
+	return true;
+}
+
+PREAMBLE(void)::_retained_store(const BItemJoined &p_bij, bool p_lit, const FillState &p_fill_state) {
+	const RasterizerCanvas::Item *first_item = bdata.item_refs[p_bij.first_item_ref].item;
+
+	// default batches are drawn by the legacy path, and may have dirtied the GL state
+	// and extra matrices, so are never retained
+	for (int n = 0; n < bdata.batches.size(); n++) {
+		if (bdata.batches[n].type == RasterizerStorageCommon::BT_DEFAULT) {
+			bdata.retained_cache.erase(first_item, p_lit);
+			return;
+		}
+	}
+
+	// with hardware transform the vertices are in local space, so can be reused if the item moves
+	bool transform_dependent = p_fill_state.use_software_transform || p_fill_state.use_attrib_transform;
+
+	BRetained *r = bdata.retained_cache.store(p_lit, p_bij.flags, transform_dependent, bdata.retained_keys.ptr(), bdata.retained_keys.size());
+	ERR_FAIL_NULL(r);
+
+	r->batches.resize(bdata.batches.size());
+	if (bdata.batches.size()) {
+		memcpy(r->batches.ptr(), bdata.batches.get_data(), bdata.batches.size() * sizeof(Batch));
+	}
+
+	r->batch_textures.resize(bdata.batch_textures.size());
+	for (int n = 0; n < bdata.batch_textures.size(); n++) {
+		r->batch_textures[n] = bdata.batch_textures[n];
+	}
+
+	r->vertices.resize(bdata.vertices.size());
+	if (bdata.vertices.size()) {
+		memcpy(r->vertices.ptr(), bdata.vertices.get_data(), bdata.vertices.size() * sizeof(BatchVertex));
+	}
+
+	r->light_angles.resize(bdata.light_angles.size());
+	if (bdata.light_angles.size()) {
+		memcpy(r->light_angles.ptr(), bdata.light_angles.get_data(), bdata.light_angles.size() * sizeof(float));
+	}
+
+	r->vertex_colors.resize(bdata.vertex_colors.size());
+	if (bdata.vertex_colors.size()) {
+		memcpy(r->vertex_colors.ptr(), bdata.vertex_colors.get_data(), bdata.vertex_colors.size() * sizeof(BatchColor));
+	}
+
+	r->vertex_modulates.resize(bdata.vertex_modulates.size());
+	if (bdata.vertex_modulates.size()) {
+		memcpy(r->vertex_modulates.ptr(), bdata.vertex_modulates.get_data(), bdata.vertex_modulates.size() * sizeof(BatchColor));
+	}
+
+	r->vertex_transforms.resize(bdata.vertex_transforms.size());
+	if (bdata.vertex_transforms.size()) {
+		memcpy(r->vertex_transforms.ptr(), bdata.vertex_transforms.get_data(), bdata.vertex_transforms.size() * sizeof(BatchTransform));
+	}
+
+	r->total_quads = bdata.total_quads;
+	r->total_verts = bdata.total_verts;
+	r->total_color_changes = bdata.total_color_changes;
+	r->use_light_angles = bdata.use_light_angles;
+	r->sequence_batch_type_flags = p_fill_state.sequence_batch_type_flags;
+}
+
+PREAMBLE(bool)::_retained_batch_tex_unchanged(const BatchTex &p_batch_tex) const {
+	// the uvs were calculated using the texture size at the time, a texture can
+	// change size (or filter flags) without the item being redrawn
+	typename T_STORAGE::Texture *texture = _get_canvas_texture(p_batch_tex.RID_texture);
+
+	if (!texture) {
+		return (p_batch_tex.tex_pixel_size.x == 1.0f) && (p_batch_tex.tex_pixel_size.y == 1.0f) && (p_batch_tex.flags == 0);
+	}
+
+	int w = texture->width;
+	int h = texture->height;
+
+	if (!w || !h) {
+		w = 1;
+		h = 1;
+	}
+
+	return (p_batch_tex.tex_pixel_size.x == (float)(1.0 / w)) && (p_batch_tex.tex_pixel_size.y == (float)(1.0 / h)) && (p_batch_tex.flags == texture->flags);
+}
+
+PREAMBLE(bool)::_retained_restore(const BRetained &p_retained) {
+	for (unsigned int n = 0; n < p_retained.batch_textures.size(); n++) {
+		if (!_retained_batch_tex_unchanged(p_retained.batch_textures[n])) {
+			return false;
+		}
+	}
+
+	// should always fit, as it was stored from a single flush
+	ERR_FAIL_COND_V((int)p_retained.vertices.size() > bdata.vertices.max_size(), false);
+
+	// batches are the only data that can grow dynamically
+	while ((int)p_retained.batches.size() > bdata.batches.max_size()) {
+		bdata.batches.reset();
+		bdata.batches.grow();
+		bdata.batches_temp.reset();
+		bdata.batches_temp.grow();
+	}
+
+	if (p_retained.batches.size()) {
+		memcpy(bdata.batches.request(p_retained.batches.size()), p_retained.batches.ptr(), p_retained.batches.size() * sizeof(Batch));
+	}
+
+	for (unsigned int n = 0; n < p_retained.batch_textures.size(); n++) {
+		bdata.batch_textures.push_back(p_retained.batch_textures[n]);
+	}
+
+	if (p_retained.vertices.size()) {
+		memcpy(bdata.vertices.request(p_retained.vertices.size()), p_retained.vertices.ptr(), p_retained.vertices.size() * sizeof(BatchVertex));
+	}
+	if (p_retained.light_angles.size()) {
+		memcpy(bdata.light_angles.request(p_retained.light_angles.size()), p_retained.light_angles.ptr(), p_retained.light_angles.size() * sizeof(float));
+	}
+	if (p_retained.vertex_colors.size()) {
+		memcpy(bdata.vertex_colors.request(p_retained.vertex_colors.size()), p_retained.vertex_colors.ptr(), p_retained.vertex_colors.size() * sizeof(BatchColor));
+	}
+	if (p_retained.vertex_modulates.size()) {
+		memcpy(bdata.vertex_modulates.request(p_retained.vertex_modulates.size()), p_retained.vertex_modulates.ptr(), p_retained.vertex_modulates.size() * sizeof(BatchColor));
+	}
+	if (p_retained.vertex_transforms.size()) {
+		memcpy(bdata.vertex_transforms.request(p_retained.vertex_transforms.size()), p_retained.vertex_transforms.ptr(), p_retained.vertex_transforms.size() * sizeof(BatchTransform));
+	}
+
+	bdata.total_quads = p_retained.total_quads;
+	bdata.total_verts = p_retained.total_verts;
+	bdata.total_color_changes = p_retained.total_color_changes;
+	bdata.use_light_angles = p_retained.use_light_angles;
+
+	return true;
+}
+
 PREAMBLE(void)::_legacy_canvas_item_render_commands(RasterizerCanvas::Item *p_item, RasterizerCanvas::Item *p_current_clip, bool &r_reclip, typename T_STORAGE::Material *p_material) {
 	int command_count = p_item->commands.size();
 
@@ -0,0 +1,199 @@
+/**************************************************************************/
+/*  rasterizer_canvas_retained_cache.h                                    */
+/**************************************************************************/
+
+
+#ifndef RASTERIZER_CANVAS_RETAINED_CACHE_H
+#define RASTERIZER_CANVAS_RETAINED_CACHE_H
+
+#include "core/local_vector.h"
+#include "core/oa_hash_map.h"
+#include "servers/visual/rasterizer.h"
+
+// Retained batching.
+// Most items in a 2D scene do not change from one frame to the next, yet the batcher
+// regenerates the vertices for every joined item each frame. This cache stores the prefilled
+// data for a joined item, keyed by its first item and validated against the revision,
+// number of commands, modulate and (if required) transform of every item reference.
+
+// The payload (vertices, batches etc) is defined by the batcher, this class only deals
+// with keying, validation and eviction, so it can be used (and tested) without a GPU backend.
+template <class T_PAYLOAD>
+class RasterizerCanvasRetainedCache {
+public:
+	// the state of an item reference that can affect the prefilled vertices
+	struct ItemKey {
+		const RasterizerCanvas::Item *item;
+		uint32_t revision;
+		uint32_t num_commands;
+		Color final_modulate;
+		Transform2D final_transform;
+
+		void set(const RasterizerCanvas::Item *p_item, const Color &p_final_modulate) {
+			item = p_item;
+			revision = p_item->revision;
+			num_commands = p_item->commands.size();
+			final_modulate = p_final_modulate;
+			final_transform = p_item->final_transform;
+		}
+
+		// with hardware transform the vertices are in local space, so the transform can be ignored
+		bool matches(const ItemKey &p_o, bool p_check_transform) const {
+			if ((item != p_o.item) || (revision != p_o.revision) || (num_commands != p_o.num_commands)) {
+				return false;
+			}
+			if (final_modulate != p_o.final_modulate) {
+				return false;
+			}
+			if (p_check_transform && (final_transform != p_o.final_transform)) {
+				return false;
+			}
+			return true;
+		}
+	};
+
+	struct Entry {
+		LocalVector<ItemKey> keys;
+		uint32_t flags;
+		bool transform_dependent;
+		uint64_t last_used_frame;
+		T_PAYLOAD payload;
+	};
+
+	// frame stats (just for monitoring and debugging)
+	struct Stats {
+		void reset() {
+			hits = 0;
+			misses = 0;
+			stores = 0;
+			evictions = 0;
+		}
+		int hits;
+		int misses;
+		int stores;
+		int evictions;
+	};
+
+private:
+	OAHashMap<uint64_t, Entry *> _entries;
+	LocalVector<uint64_t> _evict_list;
+	uint64_t _frame;
+	uint32_t _max_age;
+	Stats _stats;
+
+	// lit and unlit passes of the same joined item are stored separately
+	static uint64_t _make_key(const RasterizerCanvas::Item *p_first_item, bool p_lit) {
+		return (((uint64_t)(uintptr_t)p_first_item) << 1) | (p_lit ? 1 : 0);
+	}
+
+	bool _keys_match(const Entry &p_entry, uint32_t p_flags, const ItemKey *p_keys, uint32_t p_num_keys) const {
+		if ((p_entry.flags != p_flags) || (p_entry.keys.size() != p_num_keys)) {
+			return false;
+		}
+		for (uint32_t n = 0; n < p_num_keys; n++) {
+			if (!p_entry.keys[n].matches(p_keys[n], p_entry.transform_dependent)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	// returns the retained payload if none of the item references have changed, otherwise nullptr
+	T_PAYLOAD *find(bool p_lit, uint32_t p_flags, const ItemKey *p_keys, uint32_t p_num_keys) {
+		ERR_FAIL_COND_V(!p_num_keys, nullptr);
+
+		Entry **e = _entries.lookup_ptr(_make_key(p_keys[0].item, p_lit));
+		if (!e || !_keys_match(**e, p_flags, p_keys, p_num_keys)) {
+			_stats.misses++;
+			return nullptr;
+		}
+
+		(*e)->last_used_frame = _frame;
+		_stats.hits++;
+		return &(*e)->payload;
+	}
+
+	// returns a payload ready to be filled by the caller,
+	// an existing entry for the same first item is overwritten, reusing its memory
+	T_PAYLOAD *store(bool p_lit, uint32_t p_flags, bool p_transform_dependent, const ItemKey *p_keys, uint32_t p_num_keys) {
+		ERR_FAIL_COND_V(!p_num_keys, nullptr);
+
+		uint64_t key = _make_key(p_keys[0].item, p_lit);
+		Entry **existing = _entries.lookup_ptr(key);
+
+		Entry *e = nullptr;
+		if (existing) {
+			e = *existing;
+		} else {
+			e = memnew(Entry);
+			_entries.insert(key, e);
+		}
+
+		e->keys.resize(p_num_keys);
+		for (uint32_t n = 0; n < p_num_keys; n++) {
+			e->keys[n] = p_keys[n];
+		}
+		e->flags = p_flags;
+		e->transform_dependent = p_transform_dependent;
+		e->last_used_frame = _frame;
+
+		_stats.stores++;
+		return &e->payload;
+	}
+
+	void erase(const RasterizerCanvas::Item *p_first_item, bool p_lit) {
+		uint64_t key = _make_key(p_first_item, p_lit);
+		Entry **e = _entries.lookup_ptr(key);
+		if (e) {
+			memdelete(*e);
+			_entries.remove(key);
+		}
+	}
+
+	// items that are not drawn for a while (hidden, culled, or freed) are evicted
+	void begin_frame(uint64_t p_frame) {
+		if (p_frame == _frame) {
+			return;
+		}
+		_frame = p_frame;
+		_stats.reset();
+
+		_evict_list.clear();
+		for (typename OAHashMap<uint64_t, Entry *>::Iterator it = _entries.iter(); it.valid; it = _entries.next_iter(it)) {
+			if ((_frame - (*it.value)->last_used_frame) > _max_age) {
+				_evict_list.push_back(*it.key);
+			}
+		}
+
+		for (uint32_t n = 0; n < _evict_list.size(); n++) {
+			Entry **e = _entries.lookup_ptr(_evict_list[n]);
+			memdelete(*e);
+			_entries.remove(_evict_list[n]);
+		}
+		_stats.evictions = _evict_list.size();
+	}
+
+	void clear() {
+		for (typename OAHashMap<uint64_t, Entry *>::Iterator it = _entries.iter(); it.valid; it = _entries.next_iter(it)) {
+			memdelete(*it.value);
+		}
+		_entries.clear();
+	}
+
+	void set_max_age(uint32_t p_frames) { _max_age = p_frames; }
+	uint32_t get_max_age() const { return _max_age; }
+	int get_num_entries() const { return _entries.get_num_elements(); }
+	const Stats &get_stats() const { return _stats; }
+
+	RasterizerCanvasRetainedCache() {
+		_frame = 0;
+		_max_age = 8;
+		_stats.reset();
+	}
+	~RasterizerCanvasRetainedCache() {
+		clear();
+	}
+};
+
+#endif // RASTERIZER_CANVAS_RETAINED_CACHE_H
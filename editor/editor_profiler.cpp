@@ -372,6 +372,9 @@ void EditorProfiler::_update_frame() {
 			item->set_text(1, _get_time_as_text(m, time, it.calls));
 
 			item->set_text(2, itos(it.calls));
+			if (it.cache_hits + it.cache_misses > 0) {
+				item->set_tooltip(2, vformat(TTR("Inline cache hits: %d%%"), it.cache_hits * 100 / (it.cache_hits + it.cache_misses)));
+			}
 
 			if (plot_sigs.has(it.signature)) {
 				item->set_checked(0, true);
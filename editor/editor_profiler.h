@@ -41,6 +41,17 @@ public:
 				float self;
 				float total;
 				int calls;
+				// Script call sites served by inline caches, zero when the language has none.
+				uint64_t cache_hits;
+				uint64_t cache_misses;
+
+				Item() :
+						line(0),
+						self(0),
+						total(0),
+						calls(0),
+						cache_hits(0),
+						cache_misses(0) {}
 			};
 
 			Vector<Item> items;
@@ -1063,6 +1063,8 @@ void ScriptEditorDebugger::_parse_message(const String &p_msg, const Array &p_da
 			int calls = p_data[idx++];
 			float total = p_data[idx++];
 			float self = p_data[idx++];
+			uint64_t cache_hits = p_data[idx++];
+			uint64_t cache_misses = p_data[idx++];
 
 			EditorProfiler::Metric::Category::Item item;
 			if (profiler_signature.has(signature)) {
@@ -1087,6 +1089,8 @@ void ScriptEditorDebugger::_parse_message(const String &p_msg, const Array &p_da
 			item.calls = calls;
 			item.self = self;
 			item.total = total;
+			item.cache_hits = cache_hits;
+			item.cache_misses = cache_misses;
 			funcs.items.write[i] = item;
 		}
 
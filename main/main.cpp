@@ -12,7 +12,9 @@
 #include "core/io/ip.h"
 #include "core/io/resource_loader.h"
 #include "core/message_queue.h"
+#include "core/os/allocation_profiler.h"
 #include "core/os/dir_access.h"
+#include "core/os/frame_profiler.h"
 #include "core/os/os.h"
 #include "core/os/time.h"
 #include "core/project_settings.h"
@@ -78,6 +80,7 @@ static TranslationServer *translation_server = nullptr;
 static Performance *performance = nullptr;
 static PackedData *packed_data = nullptr;
 static Time *time_singleton = nullptr;
+static FrameProfiler *frame_profiler = nullptr;
 #ifdef MINIZIP_ENABLED
 static ZipArchive *zip_packed_data = nullptr;
 #endif
@@ -128,6 +131,8 @@ static bool force_lowdpi = false;
 // Debug
 
 static bool use_debug_profiler = false;
+static String frame_profile_path;
+static bool profile_allocations = false;
 #ifdef DEBUG_ENABLED
 static bool debug_collisions = false;
 static bool debug_navigation = false;
@@ -292,6 +297,8 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  --disable-crash-handler          Disable crash handler when supported by the platform code.\n");
 	OS::get_singleton()->print("  --fixed-fps <fps>                Force a fixed number of frames per second. This setting disables real-time synchronization.\n");
 	OS::get_singleton()->print("  --print-fps                      Print the frames per second to the stdout.\n");
+	OS::get_singleton()->print("  --frame-profile <file>           Capture a CPU timeline of the engine subsystems and save it on exit as a Chrome trace (JSON).\n");
+	OS::get_singleton()->print("  --profile-allocations            Count heap allocations per call site and print the most frequent ones on exit.\n");
 	OS::get_singleton()->print("\n");
 
 	OS::get_singleton()->print("Standalone tools:\n");
@@ -375,6 +382,10 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	ClassDB::register_class<Performance>();
 	engine->add_singleton(Engine::Singleton("Performance", performance));
 
+	frame_profiler = memnew(FrameProfiler);
+	ClassDB::register_class<FrameProfiler>();
+	engine->add_singleton(Engine::Singleton("FrameProfiler", frame_profiler));
+
 	GLOBAL_DEF("debug/settings/crash_handler/message",
 			String("Please include this when reporting the bug to the project developer."));
 	GLOBAL_DEF("debug/settings/crash_handler/message.editor",
@@ -857,6 +868,16 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 			}
 		} else if (I->get() == "--print-fps") {
 			print_fps = true;
+		} else if (I->get() == "--profile-allocations") {
+			profile_allocations = true;
+		} else if (I->get() == "--frame-profile") {
+			if (I->next()) {
+				frame_profile_path = I->next()->get();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing frame profile file argument, aborting.\n");
+				goto error;
+			}
 		} else if (I->get() == "--disable-crash-handler") {
 			OS::get_singleton()->disable_crash_handler();
 		} else if (I->get() == "--skip-breakpoints") {
@@ -1237,6 +1258,9 @@ error:
 	if (performance) {
 		memdelete(performance);
 	}
+	if (frame_profiler) {
+		memdelete(frame_profiler);
+	}
 	if (input_map) {
 		memdelete(input_map);
 	}
@@ -1277,6 +1301,15 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	// Print engine name and version
 	print_line(String(VERSION_NAME) + " v" + get_full_version_string() + " - " + String(VERSION_WEBSITE));
 
+	if (frame_profile_path != String()) {
+		// Started before the servers so the loading of the project is captured too.
+		frame_profiler->start();
+	}
+
+	if (profile_allocations) {
+		AllocationProfiler::set_enabled(true);
+	}
+
 #if !defined(NO_THREADS)
 	if (p_main_tid_override) {
 		Thread::main_thread_id = p_main_tid_override;
@@ -1329,7 +1362,7 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 
 	MAIN_PRINT("Main: Setup Logo");
 
-#if defined(JAVASCRIPT_ENABLED) || defined(ANDROID_ENABLED)
+#if defined(JAVASCRIPT_ENABLED) || defined(ANDROID_ENABLED) || defined(SERVER_ENABLED)
 	bool show_logo = false;
 #else
 	bool show_logo = true;
@@ -1825,6 +1858,29 @@ bool Main::start() {
 					}
 				}
 
+				//load the scripts used by the autoloads and the main scene in one batch, so languages can spread the work over threads
+				if (GLOBAL_DEF("application/run/preload_scripts", true)) {
+					Vector<String> preload_paths;
+					for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+						String s = E->get().name;
+						if (!s.begins_with("autoload/")) {
+							continue;
+						}
+						String path = ProjectSettings::get_singleton()->get(s);
+						if (path.begins_with("*")) {
+							path = path.substr(1, path.length() - 1);
+						}
+						preload_paths.push_back(path);
+					}
+					if (game_path.begins_with("res://")) {
+						preload_paths.push_back(game_path);
+					}
+
+					for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+						ScriptServer::get_language(i)->preload_scripts(preload_paths);
+					}
+				}
+
 				//second pass, load into global constants
 				List<Node *> to_add;
 				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
@@ -2131,6 +2187,8 @@ bool Main::iteration() {
 
 	iterating++;
 
+	FRAME_PROFILE_SCOPE("Main::iteration");
+
 	// ticks may become modified later on, and we want to store the raw measured
 	// value for profiling.
 	uint64_t raw_ticks_at_start = OS::get_singleton()->get_ticks_usec();
@@ -2183,6 +2241,8 @@ bool Main::iteration() {
 	bool exit = false;
 
 	for (int iters = 0; iters < advance.physics_steps; ++iters) {
+		FRAME_PROFILE_SCOPE("Main::physics_step");
+
 		if (InputDefault::get_singleton()->is_using_input_buffering() && agile_input_event_flushing) {
 			InputDefault::get_singleton()->flush_buffered_events();
 		}
@@ -2228,6 +2288,7 @@ bool Main::iteration() {
 	}
 	visual_server_callbacks->flush();
 	message_queue->flush();
+	OS::get_singleton()->get_main_loop()->idle_end();
 
 	VisualServer::get_singleton()->sync(); //sync if still drawing from previous frames.
 
@@ -2263,6 +2324,7 @@ bool Main::iteration() {
 	// profiler timing information
 	idle_process_ticks = OS::get_singleton()->get_ticks_usec() - idle_begin;
 	idle_process_max = MAX(idle_process_ticks, idle_process_max);
+	FRAME_PROFILE_EVENT("Main::idle", idle_begin, idle_begin + idle_process_ticks);
 	uint64_t frame_time = OS::get_singleton()->get_ticks_usec() - raw_ticks_at_start;
 
 	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
@@ -2281,6 +2343,8 @@ bool Main::iteration() {
 	frames++;
 	Engine::get_singleton()->_idle_frames++;
 
+	AllocationProfiler::frame_end();
+
 	if (frame > 1000000) {
 		// Wait a few seconds before printing FPS, as FPS reporting just after the engine has started is inaccurate.
 		if (hide_print_fps_attempts == 0) {
@@ -2360,6 +2424,18 @@ void Main::cleanup(bool p_force) {
 		script_debugger->idle_poll();
 	}
 
+	if (frame_profile_path != String()) {
+		frame_profiler->stop();
+		if (frame_profiler->save_chrome_trace(frame_profile_path) == OK) {
+			print_line("Frame profile saved to: " + frame_profile_path);
+		}
+	}
+
+	if (profile_allocations) {
+		AllocationProfiler::set_enabled(false);
+		print_line(AllocationProfiler::get_report());
+	}
+
 	ResourceLoader::remove_custom_loaders();
 	ResourceSaver::remove_custom_savers();
 
@@ -2416,6 +2492,9 @@ void Main::cleanup(bool p_force) {
 	if (performance) {
 		memdelete(performance);
 	}
+	if (frame_profiler) {
+		memdelete(frame_profiler);
+	}
 	if (input_map) {
 		memdelete(input_map);
 	}
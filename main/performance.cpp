@@ -6,6 +6,7 @@
 #include "performance.h"
 
 #include "core/message_queue.h"
+#include "core/os/allocation_profiler.h"
 #include "core/os/os.h"
 #include "scene/main/node.h"
 #include "scene/main/scene_tree.h"
@@ -17,6 +18,9 @@ Performance *Performance::singleton = nullptr;
 
 void Performance::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_monitor", "monitor"), &Performance::get_monitor);
+	ClassDB::bind_method(D_METHOD("set_allocation_tracking_enabled", "enabled"), &Performance::set_allocation_tracking_enabled);
+	ClassDB::bind_method(D_METHOD("is_allocation_tracking_enabled"), &Performance::is_allocation_tracking_enabled);
+	ClassDB::bind_method(D_METHOD("get_allocation_report", "max_sites"), &Performance::get_allocation_report, DEFVAL(20));
 
 	BIND_ENUM_CONSTANT(TIME_FPS);
 	BIND_ENUM_CONSTANT(TIME_PROCESS);
@@ -49,6 +53,9 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(MEMORY_ALLOCATIONS_PER_FRAME);
+	BIND_ENUM_CONSTANT(MEMORY_ALLOCATED_BYTES_PER_FRAME);
+	BIND_ENUM_CONSTANT(OBJECT_PENDING_DELETION_COUNT);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -62,6 +69,14 @@ float Performance::_get_node_count() const {
 	return sml->get_node_count();
 }
 
+float Performance::_get_pending_deletion_count() const {
+	SceneTree *sml = Object::cast_to<SceneTree>(OS::get_singleton()->get_main_loop());
+	if (!sml) {
+		return 0;
+	}
+	return sml->get_pending_deletion_count();
+}
+
 String Performance::get_monitor_name(Monitor p_monitor) const {
 	ERR_FAIL_INDEX_V(p_monitor, MONITOR_MAX, String());
 	static const char *names[MONITOR_MAX] = {
@@ -97,6 +112,9 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"memory/allocations_per_frame",
+		"memory/allocated_bytes_per_frame",
+		"object/pending_deletion",
 
 	};
 
@@ -161,6 +179,12 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case MEMORY_ALLOCATIONS_PER_FRAME: // Zero unless allocation tracking is enabled.
+			return AllocationProfiler::get_frame_alloc_count();
+		case MEMORY_ALLOCATED_BYTES_PER_FRAME:
+			return AllocationProfiler::get_frame_alloc_bytes();
+		case OBJECT_PENDING_DELETION_COUNT:
+			return _get_pending_deletion_count();
 
 		default: {
 		}
@@ -205,6 +229,9 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -219,6 +246,18 @@ void Performance::set_physics_process_time(float p_pt) {
 	_physics_process_time = p_pt;
 }
 
+void Performance::set_allocation_tracking_enabled(bool p_enabled) {
+	AllocationProfiler::set_enabled(p_enabled);
+}
+
+bool Performance::is_allocation_tracking_enabled() const {
+	return AllocationProfiler::is_enabled();
+}
+
+String Performance::get_allocation_report(int p_max_sites) const {
+	return AllocationProfiler::get_report(p_max_sites);
+}
+
 Performance::Performance() {
 	_process_time = 0;
 	_physics_process_time = 0;
@@ -18,6 +18,7 @@ class Performance : public Object {
 	static void _bind_methods();
 
 	float _get_node_count() const;
+	float _get_pending_deletion_count() const;
 
 	float _process_time;
 	float _physics_process_time;
@@ -57,6 +58,9 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		MEMORY_ALLOCATIONS_PER_FRAME,
+		MEMORY_ALLOCATED_BYTES_PER_FRAME,
+		OBJECT_PENDING_DELETION_COUNT,
 		MONITOR_MAX
 	};
 
@@ -74,6 +78,10 @@ public:
 	void set_process_time(float p_pt);
 	void set_physics_process_time(float p_pt);
 
+	void set_allocation_tracking_enabled(bool p_enabled);
+	bool is_allocation_tracking_enabled() const;
+	String get_allocation_report(int p_max_sites = 20) const;
+
 	static Performance *get_singleton() { return singleton; }
 
 	Performance();
@@ -0,0 +1,142 @@
+/**************************************************************************/
+/*  test_allocation_profiler.cpp                                          */
+/**************************************************************************/
+
+
+#include "test_allocation_profiler.h"
+
+#include "core/os/allocation_profiler.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/ustring.h"
+
+#define CHECK(X)                                                             \
+	if (!(X)) {                                                              \
+		OS::get_singleton()->print("\tFAIL at line %d: %s\n", __LINE__, #X); \
+		return false;                                                        \
+	} else {                                                                 \
+		OS::get_singleton()->print("\tPASS\n");                              \
+	}
+
+namespace TestAllocationProfiler {
+
+struct Payload {
+	uint8_t data[40];
+};
+
+// Other threads (audio mixing for instance) may allocate while the tests run,
+// so the totals are only checked to include the allocations made here.
+
+bool test_totals() {
+	bool was_enabled = AllocationProfiler::is_enabled();
+	AllocationProfiler::set_enabled(true);
+
+	uint64_t count = Memory::get_total_alloc_count();
+	uint64_t bytes = Memory::get_total_alloc_bytes();
+
+	Payload *p = memnew(Payload);
+	void *raw = memalloc(100);
+	raw = memrealloc(raw, 200);
+
+	uint64_t alloc_count = Memory::get_total_alloc_count() - count;
+	uint64_t alloc_bytes = Memory::get_total_alloc_bytes() - bytes;
+
+	memfree(raw);
+	memdelete(p);
+
+	// frees do not decrease the totals
+	uint64_t freed_count = Memory::get_total_alloc_count() - count;
+
+	// nothing is counted while disabled
+	AllocationProfiler::set_enabled(false);
+	count = Memory::get_total_alloc_count();
+	memdelete(memnew(Payload));
+	uint64_t disabled_count = Memory::get_total_alloc_count() - count;
+
+	AllocationProfiler::set_enabled(was_enabled);
+
+	CHECK(alloc_count >= 3);
+	CHECK(alloc_bytes >= sizeof(Payload) + 100 + 200);
+	CHECK(freed_count >= 3);
+	CHECK(disabled_count == 0);
+
+	return true;
+}
+
+bool test_frame_count() {
+	bool was_enabled = AllocationProfiler::is_enabled();
+	AllocationProfiler::set_enabled(true);
+	AllocationProfiler::frame_end();
+
+	for (int i = 0; i < 10; i++) {
+		memdelete(memnew(Payload));
+	}
+
+	AllocationProfiler::frame_end();
+	AllocationProfiler::set_enabled(was_enabled);
+
+	CHECK(AllocationProfiler::get_frame_alloc_count() >= 10);
+	CHECK(AllocationProfiler::get_frame_alloc_bytes() >= 10 * sizeof(Payload));
+
+	return true;
+}
+
+bool test_sites() {
+	bool was_enabled = AllocationProfiler::is_enabled();
+
+	AllocationProfiler::clear();
+	AllocationProfiler::set_enabled(true);
+
+	for (int i = 0; i < 1000; i++) {
+		memdelete(memnew(Payload));
+	}
+
+	AllocationProfiler::set_enabled(was_enabled);
+
+	String report = AllocationProfiler::get_report(5);
+	OS::get_singleton()->print("%s", report.utf8().get_data());
+
+#ifdef DEBUG_ENABLED
+	// the loop above is the most frequent site, so it is listed first
+	int first_line = report.find("\n", report.find("Site")) + 1;
+	String first_site = report.substr(first_line, report.find("\n", first_line) - first_line);
+	CHECK(first_site.find("test_allocation_profiler.cpp") != -1);
+	CHECK(first_site.strip_edges().begins_with("1000"));
+#endif
+
+	AllocationProfiler::clear();
+
+	return true;
+}
+
+typedef bool (*TestFunc)();
+TestFunc test_funcs[] = {
+	test_totals,
+	test_frame_count,
+	test_sites,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+} // namespace TestAllocationProfiler
@@ -0,0 +1,16 @@
+/**************************************************************************/
+/*  test_allocation_profiler.h                                            */
+/**************************************************************************/
+
+
+#ifndef TEST_ALLOCATION_PROFILER_H
+#define TEST_ALLOCATION_PROFILER_H
+
+#include "core/os/main_loop.h"
+
+namespace TestAllocationProfiler {
+
+MainLoop *test();
+}
+
+#endif // TEST_ALLOCATION_PROFILER_H
@@ -0,0 +1,960 @@
+/**************************************************************************/
+/*  test_bench.cpp                                                        */
+/**************************************************************************/
+
+
+#include "test_bench.h"
+
+#include "core/io/json.h"
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/math/math_funcs.h"
+#include "core/math/random_pcg.h"
+#include "core/os/allocation_profiler.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/sort_array.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/node_pool.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/timer.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/navigation_mesh.h"
+#include "scene/resources/packed_scene.h"
+#include "servers/navigation_server.h"
+#include "servers/physics_2d_server.h"
+#include "servers/visual_server.h"
+
+#include "modules/modules_enabled.gen.h" // For gdscript.
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+#include "modules/gdscript/gdscript.h"
+#endif
+
+// Deterministic benchmarks, meant to be run on the server platform (dummy rasterizer and audio)
+// to track performance regressions:
+//
+//   godot_server --test bench [<scenario>|all] [--bench-iterations <n>] [--bench-warmup <n>] [--bench-output <file.json>]
+//
+// Every scenario builds its data from a fixed seed, runs a few untimed warm-up iterations,
+// then times every iteration individually. The results (median, p99, allocations per iteration)
+// are printed as JSON, and optionally saved to a file.
+
+namespace TestBench {
+
+enum {
+	BENCH_SEED = 12345,
+	DEFAULT_ITERATIONS = 100,
+	DEFAULT_WARMUP = 10,
+	BENCH_ALLOC_ITERATIONS = 10, // Run again with allocations counted.
+};
+
+struct Scenario {
+	const char *name;
+	bool (*setup)(RandomPCG &r_rng);
+	void (*run)();
+	void (*cleanup)();
+};
+
+/* PHYSICS 2D */
+
+namespace Physics2D {
+
+static RID space;
+static RID floor_shape;
+static RID circle_shape;
+static Vector<RID> bodies;
+
+static bool setup(RandomPCG &r_rng) {
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+
+	space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	floor_shape = ps->rectangle_shape_create();
+	ps->shape_set_data(floor_shape, Vector2(2000, 10));
+	circle_shape = ps->circle_shape_create();
+	ps->shape_set_data(circle_shape, 8);
+
+	RID floor = ps->body_create();
+	ps->body_set_mode(floor, Physics2DServer::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(0, 600)));
+	bodies.push_back(floor);
+
+	for (int i = 0; i < 1000; i++) {
+		RID body = ps->body_create();
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, circle_shape);
+		Vector2 pos(r_rng.randf() * 1800 - 900, r_rng.randf() * 550);
+		ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, pos));
+		bodies.push_back(body);
+	}
+
+	return true;
+}
+
+static void run() {
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+	ps->flush_queries();
+	ps->step(1.0 / 60.0);
+}
+
+static void cleanup() {
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+	for (int i = 0; i < bodies.size(); i++) {
+		ps->free(bodies[i]);
+	}
+	bodies.clear();
+	ps->free(circle_shape);
+	ps->free(floor_shape);
+	ps->free(space);
+}
+
+} // namespace Physics2D
+
+/* CANVAS */
+
+namespace Canvas {
+
+static RID viewport;
+static RID canvas;
+static Vector<RID> items;
+
+static bool setup(RandomPCG &r_rng) {
+	VisualServer *vs = VisualServer::get_singleton();
+
+	viewport = vs->viewport_create();
+	vs->viewport_set_size(viewport, 1024, 600);
+	vs->viewport_set_update_mode(viewport, VS::VIEWPORT_UPDATE_ALWAYS);
+	vs->viewport_set_active(viewport, true);
+
+	canvas = vs->canvas_create();
+	vs->viewport_attach_canvas(viewport, canvas);
+
+	// Spread over twice the viewport size so part of the items are culled.
+	for (int i = 0; i < 5000; i++) {
+		RID item = vs->canvas_item_create();
+		vs->canvas_item_set_parent(item, canvas);
+		Vector2 pos(r_rng.randf() * 2048 - 512, r_rng.randf() * 1200 - 300);
+		vs->canvas_item_set_transform(item, Transform2D(0, pos));
+		for (int r = 0; r < 4; r++) {
+			Rect2 rect(r * 8, 0, 8, 8);
+			vs->canvas_item_add_rect(item, rect, Color(r_rng.randf(), r_rng.randf(), r_rng.randf()));
+		}
+		items.push_back(item);
+	}
+
+	return true;
+}
+
+static void run() {
+	VisualServer *vs = VisualServer::get_singleton();
+	vs->draw(false);
+	vs->sync();
+}
+
+static void cleanup() {
+	VisualServer *vs = VisualServer::get_singleton();
+	for (int i = 0; i < items.size(); i++) {
+		vs->free(items[i]);
+	}
+	items.clear();
+	vs->free(canvas);
+	vs->free(viewport);
+}
+
+} // namespace Canvas
+
+/* GDSCRIPT */
+
+namespace GDScriptVM {
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+static Ref<GDScript> script;
+static Ref<Reference> instance;
+
+static const char *source =
+		"extends Reference\n"
+		"\n"
+		"var counter = 0\n"
+		"\n"
+		"func add(a, b):\n"
+		"\treturn a + b\n"
+		"\n"
+		"func run():\n"
+		"\tvar total = 0\n"
+		"\tfor i in range(20000):\n"
+		"\t\ttotal += (i * 3) % 7\n"
+		"\tfor i in range(5000):\n"
+		"\t\ttotal = add(total, i)\n"
+		"\t\tcounter += 1\n"
+		"\tvar v = Vector2()\n"
+		"\tfor i in range(5000):\n"
+		"\t\tv += Vector2(i, 1.0)\n"
+		"\tvar arr = []\n"
+		"\tfor i in range(2000):\n"
+		"\t\tarr.append(i)\n"
+		"\tvar s = 0\n"
+		"\tfor x in arr:\n"
+		"\t\ts += x\n"
+		"\treturn total + s + int(v.x)\n";
+#endif
+
+static bool setup(RandomPCG &r_rng) {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	script.instance();
+	script->set_source_code(source);
+	Error err = script->reload();
+	ERR_FAIL_COND_V_MSG(err != OK, false, "Failed to compile the GDScript benchmark.");
+
+	instance.instance();
+	instance->set_script(script.get_ref_ptr());
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void run() {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	instance->call("run");
+#endif
+}
+
+static void cleanup() {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	instance.unref();
+	script.unref();
+#endif
+}
+
+} // namespace GDScriptVM
+
+/* GDSCRIPT YIELD */
+
+namespace GDScriptYield {
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+static Ref<GDScript> script;
+static Ref<Reference> instance;
+
+// A coroutine resumed over and over, with a few variants on its stack.
+static const char *source =
+		"extends Reference\n"
+		"\n"
+		"func worker():\n"
+		"\tvar name = \"worker\"\n"
+		"\tvar position = Vector2()\n"
+		"\tvar total = 0\n"
+		"\twhile true:\n"
+		"\t\tvar step = yield()\n"
+		"\t\tposition.x += step\n"
+		"\t\ttotal += step\n"
+		"\n"
+		"func run():\n"
+		"\tvar state = worker()\n"
+		"\tfor i in range(20000):\n"
+		"\t\tstate = state.resume(i)\n"
+		"\treturn state\n";
+#endif
+
+static bool setup(RandomPCG &r_rng) {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	script.instance();
+	script->set_source_code(source);
+	Error err = script->reload();
+	ERR_FAIL_COND_V_MSG(err != OK, false, "Failed to compile the GDScript yield benchmark.");
+
+	instance.instance();
+	instance->set_script(script.get_ref_ptr());
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void run() {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	instance->call("run");
+#endif
+}
+
+static void cleanup() {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	instance.unref();
+	script.unref();
+#endif
+}
+
+} // namespace GDScriptYield
+
+/* GDSCRIPT SIGNALS */
+
+namespace GDScriptSignals {
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+static Ref<GDScript> script;
+static Ref<Reference> instance;
+
+// Signals with several script receivers, binds and a native target, emitted in a loop.
+static const char *source =
+		"extends Reference\n"
+		"\n"
+		"signal hit(amount)\n"
+		"signal moved(position, velocity)\n"
+		"\n"
+		"class Receiver:\n"
+		"\tvar hits = 0\n"
+		"\tfunc on_hit(amount):\n"
+		"\t\thits += amount\n"
+		"\tfunc on_moved(position, velocity, tag):\n"
+		"\t\thits += tag\n"
+		"\n"
+		"var receivers = []\n"
+		"var native = Reference.new()\n"
+		"\n"
+		"func _init():\n"
+		"\tfor i in range(8):\n"
+		"\t\tvar receiver = Receiver.new()\n"
+		"\t\treceivers.append(receiver)\n"
+		"\t\tconnect(\"hit\", receiver, \"on_hit\")\n"
+		"\t\tconnect(\"moved\", receiver, \"on_moved\", [i])\n"
+		"\tconnect(\"hit\", native, \"set_block_signals\")\n"
+		"\n"
+		"func run():\n"
+		"\tfor i in range(5000):\n"
+		"\t\temit_signal(\"hit\", 1)\n"
+		"\t\temit_signal(\"moved\", Vector2(i, 0), Vector2(1, 1))\n"
+		"\treturn receivers[0].hits\n";
+#endif
+
+static bool setup(RandomPCG &r_rng) {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	script.instance();
+	script->set_source_code(source);
+	Error err = script->reload();
+	ERR_FAIL_COND_V_MSG(err != OK, false, "Failed to compile the GDScript signals benchmark.");
+
+	instance.instance();
+	instance->set_script(script.get_ref_ptr());
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void run() {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	instance->call("run");
+#endif
+}
+
+static void cleanup() {
+#ifdef MODULE_GDSCRIPT_ENABLED
+	instance.unref();
+	script.unref();
+#endif
+}
+
+} // namespace GDScriptSignals
+
+/* SCENE INSTANCING */
+
+namespace Instancing {
+
+static Ref<PackedScene> scene;
+
+static Node *make_scene(RandomPCG &r_rng) {
+	Node2D *root = memnew(Node2D);
+	root->set_name("Root");
+
+	for (int i = 0; i < 20; i++) {
+		Node2D *group = memnew(Node2D);
+		group->set_name("Group" + itos(i));
+		group->set_position(Vector2(r_rng.randf() * 1000, r_rng.randf() * 1000));
+		root->add_child(group);
+		group->set_owner(root);
+
+		for (int j = 0; j < 5; j++) {
+			Node2D *child = memnew(Node2D);
+			child->set_name("Child" + itos(j));
+			child->set_rotation(r_rng.randf() * Math_TAU);
+			child->set_modulate(Color(r_rng.randf(), r_rng.randf(), r_rng.randf()));
+			group->add_child(child);
+			child->set_owner(root);
+		}
+
+		Timer *timer = memnew(Timer);
+		timer->set_name("Timer");
+		timer->set_wait_time(1 + r_rng.randf());
+		group->add_child(timer);
+		timer->set_owner(root);
+	}
+
+	return root;
+}
+
+static bool setup(RandomPCG &r_rng) {
+	Node *root = make_scene(r_rng);
+	scene.instance();
+	Error err = scene->pack(root);
+	memdelete(root);
+	ERR_FAIL_COND_V(err != OK, false);
+	return true;
+}
+
+static void run() {
+	Node *node = scene->instance();
+	memdelete(node);
+}
+
+static void cleanup() {
+	scene.unref();
+}
+
+} // namespace Instancing
+
+/* SPAWNING */
+
+// Many instances of a small scene, like bullets or enemies, where resolving the scene costs as much as building the nodes.
+namespace Spawning {
+
+static Ref<PackedScene> scene;
+
+static bool setup(RandomPCG &r_rng) {
+	Node2D *root = memnew(Node2D);
+	root->set_name("Bullet");
+	root->set_position(Vector2(r_rng.randf() * 100, r_rng.randf() * 100));
+	root->set_rotation(r_rng.randf() * Math_TAU);
+	root->set_z_index(2);
+	root->add_to_group("bullets", true);
+
+	Node2D *visual = memnew(Node2D);
+	visual->set_name("Visual");
+	visual->set_scale(Vector2(0.5, 0.5));
+	visual->set_modulate(Color(1, r_rng.randf(), r_rng.randf()));
+	visual->set_light_mask(3);
+	root->add_child(visual);
+	visual->set_owner(root);
+
+	Timer *lifetime = memnew(Timer);
+	lifetime->set_name("Lifetime");
+	lifetime->set_wait_time(2 + r_rng.randf());
+	lifetime->set_one_shot(true);
+	lifetime->set_autostart(true);
+	root->add_child(lifetime);
+	lifetime->set_owner(root);
+
+	scene.instance();
+	Error err = scene->pack(root);
+	memdelete(root);
+	ERR_FAIL_COND_V(err != OK, false);
+	return true;
+}
+
+static void run() {
+	for (int i = 0; i < 1000; i++) {
+		Node *node = scene->instance();
+		memdelete(node);
+	}
+}
+
+static void cleanup() {
+	scene.unref();
+}
+
+} // namespace Spawning
+
+namespace PooledSpawning {
+
+static Ref<NodePool> pool;
+
+static bool setup(RandomPCG &r_rng) {
+	if (!Spawning::setup(r_rng)) {
+		return false;
+	}
+	pool.instance();
+	pool->set_scene(Spawning::scene);
+	return true;
+}
+
+static void run() {
+	Vector<Node *> nodes;
+	nodes.resize(100);
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < nodes.size(); j++) {
+			Node2D *node = Object::cast_to<Node2D>(pool->acquire());
+			node->set_position(Vector2(j, i));
+			nodes.write[j] = node;
+		}
+		for (int j = 0; j < nodes.size(); j++) {
+			pool->release(nodes[j]);
+		}
+	}
+}
+
+static void cleanup() {
+	pool.unref();
+	Spawning::cleanup();
+}
+
+} // namespace PooledSpawning
+
+/* NODE PROCESSING */
+
+namespace Processing {
+
+static SceneTree *tree = nullptr;
+static Vector<Node *> nodes;
+
+static bool setup(RandomPCG &r_rng) {
+	if (SceneTree::get_singleton()) {
+		return false; // Needs a tree of its own.
+	}
+	tree = memnew(SceneTree);
+	tree->init();
+
+	for (int i = 0; i < 20000; i++) {
+		Node *node = memnew(Node);
+		node->set_process_priority(r_rng.rand() % 4);
+		node->set_process(true);
+		node->set_physics_process(true);
+		tree->get_root()->add_child(node);
+		nodes.push_back(node);
+	}
+	return true;
+}
+
+static void run() {
+	for (int i = 0; i < 10; i++) {
+		// Some nodes stop and start processing every frame.
+		for (int j = i; j < nodes.size(); j += 100) {
+			nodes[j]->set_process(!nodes[j]->is_processing());
+		}
+		tree->iteration(0);
+		tree->idle(0);
+	}
+}
+
+static void cleanup() {
+	tree->finish();
+	memdelete(tree);
+	tree = nullptr;
+	nodes.clear();
+}
+
+} // namespace Processing
+
+/* GROUP CALLS */
+
+namespace GroupCalls {
+
+static SceneTree *tree = nullptr;
+
+static bool setup(RandomPCG &r_rng) {
+	if (SceneTree::get_singleton()) {
+		return false; // Needs a tree of its own.
+	}
+	tree = memnew(SceneTree);
+	tree->init();
+
+	// Mixed classes, as in most groups.
+	for (int i = 0; i < 10000; i++) {
+		Node *node = (r_rng.rand() % 2) ? memnew(Node) : memnew(Node2D);
+		node->add_to_group("enemies");
+		tree->get_root()->add_child(node);
+	}
+	return true;
+}
+
+static void run() {
+	for (int i = 0; i < 100; i++) {
+		tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME, "enemies", "set_process_priority", i);
+		tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME | SceneTree::GROUP_CALL_REVERSE, "enemies", "is_inside_tree");
+	}
+}
+
+static void cleanup() {
+	tree->finish();
+	memdelete(tree);
+	tree = nullptr;
+}
+
+} // namespace GroupCalls
+
+/* CANVAS TRANSFORMS */
+
+namespace CanvasTransforms {
+
+static SceneTree *tree = nullptr;
+static Node2D *parent = nullptr;
+static Vector<Node2D *> nodes;
+
+static bool setup(RandomPCG &r_rng) {
+	if (SceneTree::get_singleton()) {
+		return false; // Needs a tree of its own.
+	}
+	tree = memnew(SceneTree);
+	tree->init();
+
+	parent = memnew(Node2D);
+	tree->get_root()->add_child(parent);
+	for (int i = 0; i < 10000; i++) {
+		Node2D *node = memnew(Node2D);
+		node->set_position(Vector2(r_rng.randf() * 1024, r_rng.randf() * 600));
+		parent->add_child(node);
+		nodes.push_back(node);
+	}
+	return true;
+}
+
+static void run() {
+	for (int i = 0; i < 10; i++) {
+		// The parent moves every frame, a tenth of the children too, some of them several times.
+		parent->set_position(Vector2(i, i));
+		for (int j = i; j < nodes.size(); j += 10) {
+			nodes[j]->translate(Vector2(1, 0));
+			nodes[j]->rotate(0.01);
+		}
+		tree->idle(0);
+		tree->idle_end();
+	}
+}
+
+static void cleanup() {
+	tree->finish();
+	memdelete(tree);
+	tree = nullptr;
+	parent = nullptr;
+	nodes.clear();
+}
+
+} // namespace CanvasTransforms
+
+/* RESOURCE I/O */
+
+namespace ResourceIO {
+
+static Ref<PackedScene> scene;
+static String text_path;
+static String binary_path;
+
+static bool setup(RandomPCG &r_rng) {
+	Node *root = Instancing::make_scene(r_rng);
+	scene.instance();
+	Error err = scene->pack(root);
+	memdelete(root);
+	ERR_FAIL_COND_V(err != OK, false);
+
+	text_path = OS::get_singleton()->get_cache_path().plus_file("godot_bench_scene.tscn");
+	binary_path = OS::get_singleton()->get_cache_path().plus_file("godot_bench_scene.scn");
+	return true;
+}
+
+static void run() {
+	ResourceSaver::save(text_path, scene);
+	ResourceSaver::save(binary_path, scene);
+	ResourceLoader::load(text_path, "", true);
+	ResourceLoader::load(binary_path, "", true);
+}
+
+static void cleanup() {
+	DirAccess::remove_file_or_error(text_path);
+	DirAccess::remove_file_or_error(binary_path);
+	scene.unref();
+}
+
+} // namespace ResourceIO
+
+/* VARIANT, DICTIONARY AND STRING */
+
+namespace VariantOps {
+
+static Vector<String> keys;
+static Vector<Variant> values;
+
+static bool setup(RandomPCG &r_rng) {
+	for (int i = 0; i < 1000; i++) {
+		keys.push_back("key_" + itos(r_rng.rand()));
+		switch (i % 4) {
+			case 0:
+				values.push_back((int64_t)r_rng.rand());
+				break;
+			case 1:
+				values.push_back(r_rng.randf());
+				break;
+			case 2:
+				values.push_back(Vector2(r_rng.randf(), r_rng.randf()));
+				break;
+			default:
+				values.push_back(keys[i]);
+				break;
+		}
+	}
+	return true;
+}
+
+static void run() {
+	Dictionary d;
+	for (int i = 0; i < keys.size(); i++) {
+		d[keys[i]] = values[i];
+	}
+
+	Variant sum = 0;
+	for (int i = 0; i < keys.size(); i++) {
+		const Variant &v = d[keys[i]];
+		if (v.get_type() == Variant::INT || v.get_type() == Variant::REAL) {
+			bool valid;
+			Variant::evaluate(Variant::OP_ADD, sum, v, sum, valid);
+		}
+	}
+
+	String s;
+	for (int i = 0; i < 200; i++) {
+		s += keys[i];
+		s += vformat("%d:%s,", i, values[i]);
+	}
+	Vector<String> parts = s.split(",");
+
+	Array arr;
+	for (int i = 0; i < values.size(); i++) {
+		arr.push_back(values[i]);
+	}
+	arr.duplicate(true);
+	Variant(arr).hash();
+}
+
+static void cleanup() {
+	keys.clear();
+	values.clear();
+}
+
+} // namespace VariantOps
+
+/* NAVIGATION */
+
+namespace Navigation {
+
+enum {
+	GRID_SIZE = 64,
+};
+
+static RID map;
+static RID region;
+static Vector<Vector3> queries;
+
+static bool setup(RandomPCG &r_rng) {
+	NavigationServer *ns = NavigationServer::get_singleton_mut();
+	ERR_FAIL_COND_V(!ns, false);
+
+	// A grid of quads with random holes, so paths have to go around.
+	Ref<NavigationMesh> navmesh;
+	navmesh.instance();
+
+	PoolVector<Vector3> vertices;
+	for (int z = 0; z <= GRID_SIZE; z++) {
+		for (int x = 0; x <= GRID_SIZE; x++) {
+			vertices.push_back(Vector3(x, 0, z));
+		}
+	}
+	navmesh->set_vertices(vertices);
+
+	for (int z = 0; z < GRID_SIZE; z++) {
+		for (int x = 0; x < GRID_SIZE; x++) {
+			if ((x % 8) && (z % 8) && r_rng.randf() < 0.15) {
+				continue;
+			}
+			int v = z * (GRID_SIZE + 1) + x;
+			Vector<int> polygon;
+			polygon.push_back(v);
+			polygon.push_back(v + 1);
+			polygon.push_back(v + GRID_SIZE + 2);
+			polygon.push_back(v + GRID_SIZE + 1);
+			navmesh->add_polygon(polygon);
+		}
+	}
+
+	map = ns->map_create();
+	ns->map_set_cell_size(map, 0.25);
+	ns->map_set_active(map, true);
+
+	region = ns->region_create();
+	ns->region_set_map(region, map);
+	ns->region_set_navmesh(region, navmesh);
+	ns->map_force_update(map);
+
+	for (int i = 0; i < 200; i++) {
+		queries.push_back(Vector3(r_rng.randf() * GRID_SIZE, 0, r_rng.randf() * GRID_SIZE));
+	}
+
+	return true;
+}
+
+static void run() {
+	NavigationServer *ns = NavigationServer::get_singleton_mut();
+	for (int i = 0; i < queries.size() - 1; i++) {
+		ns->map_get_path(map, queries[i], queries[i + 1], true);
+	}
+}
+
+static void cleanup() {
+	NavigationServer *ns = NavigationServer::get_singleton_mut();
+	ns->free(region);
+	ns->free(map);
+	ns->process(0); // free is deferred until the commands are flushed
+	queries.clear();
+}
+
+} // namespace Navigation
+
+static const Scenario scenarios[] = {
+	{ "physics_2d", Physics2D::setup, Physics2D::run, Physics2D::cleanup },
+	{ "canvas", Canvas::setup, Canvas::run, Canvas::cleanup },
+	{ "gdscript", GDScriptVM::setup, GDScriptVM::run, GDScriptVM::cleanup },
+	{ "gdscript_yield", GDScriptYield::setup, GDScriptYield::run, GDScriptYield::cleanup },
+	{ "gdscript_signals", GDScriptSignals::setup, GDScriptSignals::run, GDScriptSignals::cleanup },
+	{ "instancing", Instancing::setup, Instancing::run, Instancing::cleanup },
+	{ "spawning", Spawning::setup, Spawning::run, Spawning::cleanup },
+	{ "spawning_pooled", PooledSpawning::setup, PooledSpawning::run, PooledSpawning::cleanup },
+	{ "processing", Processing::setup, Processing::run, Processing::cleanup },
+	{ "group_calls", GroupCalls::setup, GroupCalls::run, GroupCalls::cleanup },
+	{ "canvas_transforms", CanvasTransforms::setup, CanvasTransforms::run, CanvasTransforms::cleanup },
+	{ "resource_io", ResourceIO::setup, ResourceIO::run, ResourceIO::cleanup },
+	{ "variant", VariantOps::setup, VariantOps::run, VariantOps::cleanup },
+	{ "navigation", Navigation::setup, Navigation::run, Navigation::cleanup },
+	{ nullptr, nullptr, nullptr, nullptr }
+};
+
+static Dictionary run_scenario(const Scenario &p_scenario, int p_iterations, int p_warmup) {
+	Dictionary result;
+	result["name"] = p_scenario.name;
+
+	Math::seed(BENCH_SEED);
+	RandomPCG rng(BENCH_SEED);
+
+	if (!p_scenario.setup(rng)) {
+		OS::get_singleton()->print("%s: skipped\n", p_scenario.name);
+		result["skipped"] = true;
+		return result;
+	}
+
+	for (int i = 0; i < p_warmup; i++) {
+		p_scenario.run();
+	}
+
+	LocalVector<uint64_t> samples;
+	samples.resize(p_iterations);
+
+	for (int i = 0; i < p_iterations; i++) {
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		p_scenario.run();
+		samples[i] = OS::get_singleton()->get_ticks_usec() - begin;
+	}
+
+	// Allocations are only counted while the profiler is enabled, which would skew the timings,
+	// so they are measured on separate iterations.
+	int alloc_iterations = MIN(p_iterations, BENCH_ALLOC_ITERATIONS);
+	bool was_enabled = AllocationProfiler::is_enabled();
+	AllocationProfiler::set_enabled(true);
+	uint64_t alloc_count = Memory::get_total_alloc_count();
+	uint64_t alloc_bytes = Memory::get_total_alloc_bytes();
+
+	for (int i = 0; i < alloc_iterations; i++) {
+		p_scenario.run();
+	}
+
+	alloc_count = Memory::get_total_alloc_count() - alloc_count;
+	alloc_bytes = Memory::get_total_alloc_bytes() - alloc_bytes;
+	AllocationProfiler::set_enabled(was_enabled);
+
+	p_scenario.cleanup();
+
+	SortArray<uint64_t> sorter;
+	sorter.sort(samples.ptr(), samples.size());
+
+	uint64_t total = 0;
+	for (uint32_t i = 0; i < samples.size(); i++) {
+		total += samples[i];
+	}
+
+	uint32_t n = samples.size();
+	uint64_t median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	uint32_t p99_index = MIN((uint32_t)Math::ceil(n * 0.99) - 1, n - 1);
+
+	result["iterations"] = p_iterations;
+	result["median_usec"] = median;
+	result["p99_usec"] = samples[p99_index];
+	result["min_usec"] = samples[0];
+	result["max_usec"] = samples[n - 1];
+	result["mean_usec"] = total / n;
+	result["allocs_per_iteration"] = (double)alloc_count / alloc_iterations;
+	result["alloc_bytes_per_iteration"] = (double)alloc_bytes / alloc_iterations;
+
+	OS::get_singleton()->print("%s: median %d usec, p99 %d usec, %s allocations per iteration\n", p_scenario.name, (int)median, (int)samples[p99_index], String::num((double)alloc_count / alloc_iterations, 1).utf8().get_data());
+
+	return result;
+}
+
+MainLoop *test(const List<String> &p_args) {
+	String name = "all";
+	int iterations = DEFAULT_ITERATIONS;
+	int warmup = DEFAULT_WARMUP;
+	String output_path;
+
+	for (const List<String>::Element *E = p_args.front(); E; E = E->next()) {
+		if (!E->next()) {
+			break;
+		}
+		const String &value = E->next()->get();
+		if (E->get() == "bench" && !value.begins_with("-")) {
+			name = value;
+		} else if (E->get() == "--bench-iterations") {
+			iterations = value.to_int();
+		} else if (E->get() == "--bench-warmup") {
+			warmup = value.to_int();
+		} else if (E->get() == "--bench-output") {
+			output_path = value;
+		}
+	}
+
+	ERR_FAIL_COND_V_MSG(iterations < 1, nullptr, "At least one benchmark iteration is required.");
+	ERR_FAIL_COND_V(warmup < 0, nullptr);
+
+	Array results;
+	for (int i = 0; scenarios[i].name; i++) {
+		if (name == "all" || name == scenarios[i].name) {
+			results.push_back(run_scenario(scenarios[i], iterations, warmup));
+		}
+	}
+
+	if (results.empty()) {
+		String names;
+		for (int i = 0; scenarios[i].name; i++) {
+			names += String(" ") + scenarios[i].name;
+		}
+		ERR_FAIL_V_MSG(nullptr, "Unknown benchmark '" + name + "', available benchmarks are:" + names + ".");
+	}
+
+	Dictionary report;
+	report["seed"] = BENCH_SEED;
+	report["warmup"] = warmup;
+	report["results"] = results;
+
+	String json = JSON::print(report, "\t", false);
+	OS::get_singleton()->print("%s\n", json.utf8().get_data());
+
+	if (output_path != String()) {
+		Error err;
+		FileAccessRef f = FileAccess::open(output_path, FileAccess::WRITE, &err);
+		ERR_FAIL_COND_V_MSG(!f, nullptr, "Cannot save benchmark results to file '" + output_path + "'.");
+		f->store_string(json);
+		f->close();
+	}
+
+	return nullptr;
+}
+
+} // namespace TestBench
@@ -0,0 +1,18 @@
+/**************************************************************************/
+/*  test_bench.h                                                          */
+/**************************************************************************/
+
+
+#ifndef TEST_BENCH_H
+#define TEST_BENCH_H
+
+#include "core/list.h"
+#include "core/os/main_loop.h"
+#include "core/ustring.h"
+
+namespace TestBench {
+
+MainLoop *test(const List<String> &p_args);
+}
+
+#endif // TEST_BENCH_H
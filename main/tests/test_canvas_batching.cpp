@@ -0,0 +1,244 @@
+/**************************************************************************/
+/*  test_canvas_batching.cpp                                              */
+/**************************************************************************/
+
+
+#include "test_canvas_batching.h"
+
+#include "core/os/os.h"
+#include "drivers/gles_common/rasterizer_canvas_retained_cache.h"
+#include "drivers/gles_common/rasterizer_storage_common.h"
+
+#define CHECK(X)                                                             \
+	if (!(X)) {                                                              \
+		OS::get_singleton()->print("\tFAIL at line %d: %s\n", __LINE__, #X); \
+		return false;                                                        \
+	} else {                                                                 \
+		OS::get_singleton()->print("\tPASS\n");                              \
+	}
+
+namespace TestCanvasBatching {
+
+// stands in for the vertices and batches stored by the batcher
+struct MockPayload {
+	int num_verts;
+};
+
+typedef RasterizerCanvasRetainedCache<MockPayload> Cache;
+
+static void add_rect(RasterizerCanvas::Item &r_item, const Rect2 &p_rect) {
+	RasterizerCanvas::Item::CommandRect *rect = memnew(RasterizerCanvas::Item::CommandRect);
+	rect->rect = p_rect;
+	r_item.commands.push_back(rect);
+}
+
+static Cache::ItemKey make_key(const RasterizerCanvas::Item &p_item) {
+	Cache::ItemKey key;
+	key.set(&p_item, p_item.final_modulate);
+	return key;
+}
+
+bool test_store_and_find() {
+	Cache cache;
+	RasterizerCanvas::Item item;
+	add_rect(item, Rect2(0, 0, 16, 16));
+
+	Cache::ItemKey key = make_key(item);
+	CHECK(cache.find(false, 0, &key, 1) == nullptr);
+
+	MockPayload *p = cache.store(false, 0, false, &key, 1);
+	CHECK(p != nullptr);
+	p->num_verts = 4;
+
+	key = make_key(item);
+	MockPayload *found = cache.find(false, 0, &key, 1);
+	CHECK(found == p);
+	CHECK(found->num_verts == 4);
+	CHECK(cache.get_stats().hits == 1);
+	CHECK(cache.get_stats().misses == 1);
+
+	return true;
+}
+
+bool test_invalidated_by_redraw() {
+	Cache cache;
+	RasterizerCanvas::Item item;
+	add_rect(item, Rect2(0, 0, 16, 16));
+
+	Cache::ItemKey key = make_key(item);
+	cache.store(false, 0, false, &key, 1);
+
+	// adding commands without clearing changes the command count
+	add_rect(item, Rect2(16, 0, 16, 16));
+	key = make_key(item);
+	CHECK(cache.find(false, 0, &key, 1) == nullptr);
+
+	cache.store(false, 0, false, &key, 1);
+	CHECK(cache.find(false, 0, &key, 1) != nullptr);
+
+	// redrawing with the same number of commands changes the revision
+	item.clear();
+	add_rect(item, Rect2(0, 0, 32, 32));
+	add_rect(item, Rect2(32, 0, 32, 32));
+	key = make_key(item);
+	CHECK(cache.find(false, 0, &key, 1) == nullptr);
+
+	return true;
+}
+
+bool test_transform_and_modulate() {
+	Cache cache;
+	RasterizerCanvas::Item item;
+	add_rect(item, Rect2(0, 0, 16, 16));
+
+	// hardware transform, vertices are in local space
+	Cache::ItemKey key = make_key(item);
+	cache.store(false, 0, false, &key, 1);
+
+	item.final_transform.elements[2] = Vector2(100, 50);
+	key = make_key(item);
+	CHECK(cache.find(false, 0, &key, 1) != nullptr);
+
+	// software transform, vertices are baked
+	cache.store(false, 0, true, &key, 1);
+	item.final_transform.elements[2] = Vector2(200, 50);
+	key = make_key(item);
+	CHECK(cache.find(false, 0, &key, 1) == nullptr);
+
+	// modulate is baked into vertex colors
+	cache.store(false, 0, true, &key, 1);
+	CHECK(cache.find(false, 0, &key, 1) != nullptr);
+	item.final_modulate = Color(1, 0, 0, 1);
+	key = make_key(item);
+	CHECK(cache.find(false, 0, &key, 1) == nullptr);
+
+	// joined item flags (e.g. a change of material) also invalidate
+	cache.store(false, 0, true, &key, 1);
+	CHECK(cache.find(false, RasterizerStorageCommon::USE_LARGE_FVF, &key, 1) == nullptr);
+
+	return true;
+}
+
+bool test_joined_items() {
+	Cache cache;
+	RasterizerCanvas::Item items[3];
+	for (int n = 0; n < 3; n++) {
+		add_rect(items[n], Rect2(n * 16, 0, 16, 16));
+	}
+
+	Cache::ItemKey keys[3];
+	for (int n = 0; n < 3; n++) {
+		keys[n] = make_key(items[n]);
+	}
+	cache.store(false, 0, true, keys, 3);
+	CHECK(cache.find(false, 0, keys, 3) != nullptr);
+
+	// fewer items joined this frame
+	CHECK(cache.find(false, 0, keys, 2) == nullptr);
+
+	// a change to any item in the join
+	cache.store(false, 0, true, keys, 3);
+	items[2].final_transform.elements[2] = Vector2(1, 1);
+	keys[2] = make_key(items[2]);
+	CHECK(cache.find(false, 0, keys, 3) == nullptr);
+
+	// lit and unlit passes are separate entries
+	cache.store(false, 0, true, keys, 3);
+	CHECK(cache.find(true, 0, keys, 3) == nullptr);
+	cache.store(true, 0, true, keys, 3);
+	CHECK(cache.find(true, 0, keys, 3) != nullptr);
+	CHECK(cache.find(false, 0, keys, 3) != nullptr);
+	CHECK(cache.get_num_entries() == 2);
+
+	return true;
+}
+
+bool test_reused_address() {
+	Cache cache;
+
+	// a freed item whose memory is reused by a new item must not hit
+	uint8_t *mem = (uint8_t *)memalloc(sizeof(RasterizerCanvas::Item));
+
+	RasterizerCanvas::Item *item = memnew_placement(mem, RasterizerCanvas::Item);
+	add_rect(*item, Rect2(0, 0, 16, 16));
+	Cache::ItemKey key = make_key(*item);
+	cache.store(false, 0, false, &key, 1);
+	item->~Item();
+
+	item = memnew_placement(mem, RasterizerCanvas::Item);
+	add_rect(*item, Rect2(0, 0, 16, 16));
+	key = make_key(*item);
+	bool hit = cache.find(false, 0, &key, 1) != nullptr;
+	item->~Item();
+	memfree(mem);
+
+	CHECK(!hit);
+
+	return true;
+}
+
+bool test_eviction() {
+	Cache cache;
+	cache.set_max_age(2);
+
+	RasterizerCanvas::Item a;
+	RasterizerCanvas::Item b;
+	add_rect(a, Rect2(0, 0, 16, 16));
+	add_rect(b, Rect2(0, 0, 16, 16));
+	Cache::ItemKey key_a = make_key(a);
+	Cache::ItemKey key_b = make_key(b);
+
+	cache.begin_frame(1);
+	cache.store(false, 0, false, &key_a, 1);
+	cache.store(false, 0, false, &key_b, 1);
+	CHECK(cache.get_num_entries() == 2);
+
+	// only a is drawn in the following frames
+	for (uint64_t frame = 2; frame <= 4; frame++) {
+		cache.begin_frame(frame);
+		CHECK(cache.find(false, 0, &key_a, 1) != nullptr);
+	}
+
+	CHECK(cache.get_num_entries() == 1);
+	CHECK(cache.find(false, 0, &key_b, 1) == nullptr);
+
+	cache.clear();
+	CHECK(cache.get_num_entries() == 0);
+
+	return true;
+}
+
+typedef bool (*TestFunc)();
+TestFunc test_funcs[] = {
+	test_store_and_find,
+	test_invalidated_by_redraw,
+	test_transform_and_modulate,
+	test_joined_items,
+	test_reused_address,
+	test_eviction,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+} // namespace TestCanvasBatching
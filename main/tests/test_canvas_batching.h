@@ -0,0 +1,16 @@
+/**************************************************************************/
+/*  test_canvas_batching.h                                                */
+/**************************************************************************/
+
+
+#ifndef TEST_CANVAS_BATCHING_H
+#define TEST_CANVAS_BATCHING_H
+
+#include "core/os/main_loop.h"
+
+namespace TestCanvasBatching {
+
+MainLoop *test();
+}
+
+#endif // TEST_CANVAS_BATCHING_H
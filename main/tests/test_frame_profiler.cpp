@@ -0,0 +1,167 @@
+/**************************************************************************/
+/*  test_frame_profiler.cpp                                               */
+/**************************************************************************/
+
+
+#include "test_frame_profiler.h"
+
+#include "core/io/json.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/frame_profiler.h"
+#include "core/os/os.h"
+
+#define CHECK(X)                                                             \
+	if (!(X)) {                                                              \
+		OS::get_singleton()->print("\tFAIL at line %d: %s\n", __LINE__, #X); \
+		return false;                                                        \
+	} else {                                                                 \
+		OS::get_singleton()->print("\tPASS\n");                              \
+	}
+
+namespace TestFrameProfiler {
+
+// Other threads, such as the audio thread, may record events during the tests.
+static int main_thread_events() {
+	return FrameProfiler::get_singleton()->get_thread_event_count(Thread::get_caller_id());
+}
+
+static void nested_scopes() {
+	FRAME_PROFILE_SCOPE("outer");
+	{
+		FRAME_PROFILE_SCOPE("inner");
+	}
+}
+
+bool test_inactive() {
+	FrameProfiler *fp = FrameProfiler::get_singleton();
+	CHECK(fp != nullptr);
+	CHECK(!fp->is_capturing());
+
+	fp->clear();
+	nested_scopes();
+	CHECK(main_thread_events() == 0);
+
+	return true;
+}
+
+bool test_capture() {
+	FrameProfiler *fp = FrameProfiler::get_singleton();
+
+	fp->start();
+	CHECK(fp->is_capturing());
+	nested_scopes();
+	FRAME_PROFILE_EVENT("preset", 10, 20);
+	fp->stop();
+
+	CHECK(main_thread_events() == 3);
+
+	// stopped, nothing more is recorded
+	nested_scopes();
+	CHECK(main_thread_events() == 3);
+
+	// a new capture discards the previous one
+	fp->start();
+	fp->stop();
+	CHECK(main_thread_events() == 0);
+
+	return true;
+}
+
+bool test_ring_wraps() {
+	FrameProfiler *fp = FrameProfiler::get_singleton();
+	int old_size = fp->get_buffer_size();
+
+	fp->set_buffer_size(1000);
+	CHECK(fp->get_buffer_size() == 1024);
+
+	fp->start();
+	for (int i = 0; i < 1500; i++) {
+		nested_scopes();
+	}
+	fp->stop();
+
+	// only the most recent events are kept
+	CHECK(main_thread_events() == 1024);
+
+	fp->set_buffer_size(old_size);
+	fp->clear();
+
+	return true;
+}
+
+bool test_chrome_trace() {
+	FrameProfiler *fp = FrameProfiler::get_singleton();
+
+	fp->start();
+	nested_scopes();
+	CHECK(fp->save_chrome_trace(OS::get_singleton()->get_cache_path().plus_file("godot_frame_profile_test.json")) == ERR_BUSY);
+	fp->stop();
+
+	String path = OS::get_singleton()->get_cache_path().plus_file("godot_frame_profile_test.json");
+	CHECK(fp->save_chrome_trace(path) == OK);
+
+	Error err;
+	String text = FileAccess::get_file_as_string(path, &err);
+	DirAccess::remove_file_or_error(path);
+	CHECK(err == OK);
+
+	Variant ret;
+	String err_str;
+	int err_line;
+	CHECK(JSON::parse(text, ret, err_str, err_line) == OK);
+
+	Dictionary trace = ret;
+	Array events = trace["traceEvents"];
+
+	int complete = 0;
+	bool found_inner = false;
+	for (int i = 0; i < events.size(); i++) {
+		Dictionary e = events[i];
+		String name = e["name"];
+		if (String(e["ph"]) != "X" || (name != "outer" && name != "inner")) {
+			continue;
+		}
+		complete++;
+		found_inner = found_inner || name == "inner";
+	}
+	CHECK(complete == 2);
+	CHECK(found_inner);
+
+	fp->clear();
+
+	return true;
+}
+
+typedef bool (*TestFunc)();
+TestFunc test_funcs[] = {
+	test_inactive,
+	test_capture,
+	test_ring_wraps,
+	test_chrome_trace,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+} // namespace TestFrameProfiler
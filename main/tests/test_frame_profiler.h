@@ -0,0 +1,16 @@
+/**************************************************************************/
+/*  test_frame_profiler.h                                                 */
+/**************************************************************************/
+
+
+#ifndef TEST_FRAME_PROFILER_H
+#define TEST_FRAME_PROFILER_H
+
+#include "core/os/main_loop.h"
+
+namespace TestFrameProfiler {
+
+MainLoop *test();
+}
+
+#endif // TEST_FRAME_PROFILER_H
@@ -546,19 +546,21 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += "[\"";
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]=";
-					txt += DADDR(3);
-					incr += 4;
+					txt += DADDR(4);
+					txt += " ic#" + itos(code[ip + 3]);
+					incr += 5;
 
 				} break;
 				case GDScriptFunction::OPCODE_GET_NAMED: {
 					txt += " get_named ";
-					txt += DADDR(3);
+					txt += DADDR(4);
 					txt += "=";
 					txt += DADDR(1);
 					txt += "[\"";
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]";
-					incr += 4;
+					txt += " ic#" + itos(code[ip + 3]);
+					incr += 5;
 
 				} break;
 				case GDScriptFunction::OPCODE_SET_MEMBER: {
@@ -579,6 +581,17 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += "\"]";
 					incr += 3;
 
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_MEMBER: {
+					txt += " op_member ";
+					txt += "[\"";
+					txt += func.get_global_name(code[ip + 2]);
+					txt += "\"] ";
+					txt += Variant::get_operator_name(Variant::Operator(code[ip + 1]));
+					txt += "= ";
+					txt += DADDR(3);
+					incr += 4;
+
 				} break;
 				case GDScriptFunction::OPCODE_ASSIGN: {
 					txt += " assign ";
@@ -695,18 +708,24 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 				} break;
 
 				case GDScriptFunction::OPCODE_CALL:
-				case GDScriptFunction::OPCODE_CALL_RETURN: {
-					bool ret = code[ip] == GDScriptFunction::OPCODE_CALL_RETURN;
+				case GDScriptFunction::OPCODE_CALL_RETURN:
+				case GDScriptFunction::OPCODE_CALL_PTRCALL:
+				case GDScriptFunction::OPCODE_CALL_PTRCALL_RETURN: {
+					bool ret = code[ip] == GDScriptFunction::OPCODE_CALL_RETURN || code[ip] == GDScriptFunction::OPCODE_CALL_PTRCALL_RETURN;
+					bool ptrcall = code[ip] == GDScriptFunction::OPCODE_CALL_PTRCALL || code[ip] == GDScriptFunction::OPCODE_CALL_PTRCALL_RETURN;
 
 					if (ret) {
 						txt += " call-ret ";
 					} else {
 						txt += " call ";
 					}
+					if (ptrcall) {
+						txt += "(ptrcall) ";
+					}
 
 					int argc = code[ip + 1];
 					if (ret) {
-						txt += DADDR(4 + argc) + "=";
+						txt += DADDR(5 + argc) + "=";
 					}
 
 					txt += DADDR(2) + ".";
@@ -717,11 +736,12 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 						if (i > 0) {
 							txt += ", ";
 						}
-						txt += DADDR(4 + i);
+						txt += DADDR(5 + i);
 					}
 					txt += ")";
+					txt += " ic#" + itos(code[ip + 4]);
 
-					incr = 5 + argc;
+					incr = 6 + argc;
 
 				} break;
 				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
@@ -804,6 +824,16 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 					incr = 3;
 				} break;
+				case GDScriptFunction::OPCODE_JUMP_IF_NOT_COMPARE: {
+					txt += " jump-if-not ";
+					txt += DADDR(2);
+					txt += " " + Variant::get_operator_name(Variant::Operator(code[ip + 1])) + " ";
+					txt += DADDR(3);
+					txt += " to ";
+					txt += itos(code[ip + 4]);
+
+					incr = 5;
+				} break;
 				case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: {
 					txt += " jump-to-default-argument ";
 					incr = 1;
@@ -815,15 +845,33 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr = 2;
 
 				} break;
-				case GDScriptFunction::OPCODE_ITERATE_BEGIN: {
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN:
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_INT: {
 					txt += " for-init " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					if (code[ip] == GDScriptFunction::OPCODE_ITERATE_BEGIN_INT) {
+						txt += " (int)";
+					}
 					incr += 5;
 
 				} break;
-				case GDScriptFunction::OPCODE_ITERATE: {
+				case GDScriptFunction::OPCODE_ITERATE:
+				case GDScriptFunction::OPCODE_ITERATE_INT: {
 					txt += " for-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					if (code[ip] == GDScriptFunction::OPCODE_ITERATE_INT) {
+						txt += " (int)";
+					}
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE: {
+					txt += " for-init " + DADDR(6) + " in range(" + DADDR(2) + ", " + DADDR(3) + ", " + DADDR(4) + ") counter " + DADDR(1) + " end " + itos(code[ip + 5]);
+					incr += 7;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_RANGE: {
+					txt += " for-loop " + DADDR(5) + " to " + DADDR(2) + " step " + DADDR(3) + " counter " + DADDR(1) + " end " + itos(code[ip + 4]);
+					incr += 6;
+
 				} break;
 				case GDScriptFunction::OPCODE_LINE: {
 					int line = code[ip + 1] - 1;
@@ -844,6 +892,20 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr += 2;
 
 				} break;
+				default: {
+					// specialized operators, same as OPCODE_OPERATOR without the operator operand
+					Variant::Operator op = GDScriptFunction::get_typed_operator(GDScriptFunction::Opcode(code[ip]));
+					if (op != Variant::OP_MAX) {
+						txt += " op ";
+						txt += DADDR(3);
+						txt += " = ";
+						txt += DADDR(1);
+						txt += " " + Variant::get_operator_name(op) + " ";
+						txt += DADDR(2);
+						txt += " (typed)";
+						incr += 4;
+					}
+				} break;
 			}
 
 			if (incr == 0) {
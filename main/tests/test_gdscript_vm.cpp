@@ -0,0 +1,712 @@
+/**************************************************************************/
+/*  test_gdscript_vm.cpp                                                  */
+/**************************************************************************/
+
+
+#include "test_gdscript_vm.h"
+
+#include "core/os/os.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/node.h"
+
+#include "modules/modules_enabled.gen.h" // For gdscript.
+#ifdef MODULE_GDSCRIPT_ENABLED
+
+#include "modules/gdscript/gdscript.h"
+#include "modules/gdscript/gdscript_bytecode_cache.h"
+#include "modules/gdscript/gdscript_sampling_profiler.h"
+
+#define CHECK(X)                                                             \
+	if (!(X)) {                                                              \
+		OS::get_singleton()->print("\tFAIL at line %d: %s\n", __LINE__, #X); \
+		return false;                                                        \
+	} else {                                                                 \
+		OS::get_singleton()->print("\tPASS\n");                              \
+	}
+
+namespace TestGDScriptVM {
+
+static Ref<GDScript> _compile(const String &p_source) {
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(p_source);
+	Error err = script->reload();
+	ERR_FAIL_COND_V_MSG(err != OK, Ref<GDScript>(), "Failed to compile test script.");
+	return script;
+}
+
+static Ref<Reference> _instance(const Ref<GDScript> &p_script) {
+	Ref<Reference> instance;
+	instance.instance();
+	instance->set_script(p_script.get_ref_ptr());
+	return instance;
+}
+
+// Sums the inline cache counters of all functions, the profiler is restarted by the caller.
+static void _get_inline_cache_stats(uint64_t &r_hits, uint64_t &r_misses) {
+	Vector<ScriptLanguage::ProfilingInfo> info;
+	info.resize(4096);
+	int count = GDScriptLanguage::get_singleton()->profiling_get_accumulated_data(info.ptrw(), info.size());
+
+	r_hits = 0;
+	r_misses = 0;
+	for (int i = 0; i < count; i++) {
+		r_hits += info[i].inline_cache_hits;
+		r_misses += info[i].inline_cache_misses;
+	}
+}
+
+static const char *target_source =
+		"extends Reference\n"
+		"var value = 0\n"
+		"var typed : int = 0\n"
+		"func add(x):\n"
+		"\tvalue += x\n"
+		"\treturn value\n";
+
+static const char *caller_source =
+		"extends Reference\n"
+		"func calls(target, n):\n"
+		"\tvar total = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\ttotal += target.add(1)\n"
+		"\treturn total\n"
+		"func members(target, n):\n"
+		"\tfor i in range(n):\n"
+		"\t\ttarget.value = target.value + 2\n"
+		"\treturn target.value\n"
+		"func set_typed(target, v):\n"
+		"\ttarget.typed = v\n"
+		"\treturn target.typed\n"
+		"func native(node, n):\n"
+		"\tvar names = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tnode.name = \"Node\" + str(i)\n"
+		"\t\tif node.name == \"Node\" + str(i):\n"
+		"\t\t\tnames += 1\n"
+		"\t\tnames += node.get_child_count()\n"
+		"\treturn names\n";
+
+bool test_call_cache() {
+	Ref<GDScript> target_script = _compile(target_source);
+	Ref<GDScript> caller_script = _compile(caller_source);
+	CHECK(target_script.is_valid() && caller_script.is_valid());
+
+	Ref<Reference> target = _instance(target_script);
+	Ref<Reference> caller = _instance(caller_script);
+
+	GDScriptLanguage::get_singleton()->profiling_start();
+	Variant total = caller->call("calls", target, 100);
+	uint64_t hits, misses;
+	_get_inline_cache_stats(hits, misses);
+	GDScriptLanguage::get_singleton()->profiling_stop();
+
+	// 1 + 2 + ... + 100
+	CHECK(int(total) == 5050);
+	// the first call fills the cache, add() itself only touches its own members
+	CHECK(misses == 1);
+	CHECK(hits == 99);
+
+	return true;
+}
+
+bool test_member_cache() {
+	Ref<GDScript> target_script = _compile(target_source);
+	Ref<GDScript> caller_script = _compile(caller_source);
+	CHECK(target_script.is_valid() && caller_script.is_valid());
+
+	Ref<Reference> target = _instance(target_script);
+	Ref<Reference> caller = _instance(caller_script);
+
+	CHECK(int(caller->call("members", target, 50)) == 100);
+	CHECK(int(target->get("value")) == 100);
+
+	// a float assigned to an int member still goes through the conversion
+	Variant typed = caller->call("set_typed", target, 2.5);
+	CHECK(typed.get_type() == Variant::INT);
+	CHECK(int(typed) == 2);
+
+	return true;
+}
+
+bool test_native_cache() {
+	Ref<GDScript> caller_script = _compile(caller_source);
+	CHECK(caller_script.is_valid());
+	Ref<Reference> caller = _instance(caller_script);
+
+	Node *node = memnew(Node);
+	node->add_child(memnew(Node));
+
+	GDScriptLanguage::get_singleton()->profiling_start();
+	Variant names = caller->call("native", node, 10);
+	uint64_t hits, misses;
+	_get_inline_cache_stats(hits, misses);
+	GDScriptLanguage::get_singleton()->profiling_stop();
+
+	CHECK(int(names) == 20);
+	CHECK(String(node->get_name()) == "Node9");
+	// set name, get name and get_child_count() are cached per site
+	CHECK(misses == 3);
+	CHECK(hits == 27);
+
+	memdelete(node);
+
+	return true;
+}
+
+bool test_cache_invalidation() {
+	Ref<GDScript> target_script = _compile(target_source);
+	Ref<GDScript> caller_script = _compile(caller_source);
+	CHECK(target_script.is_valid() && caller_script.is_valid());
+
+	Ref<Reference> target = _instance(target_script);
+	Ref<Reference> caller = _instance(caller_script);
+	CHECK(int(caller->call("calls", target, 10)) == 55);
+
+	// the cached function is freed by the reload, the call site must resolve the new one
+	target.unref();
+	target_script->set_source_code(String(target_source).replace("value += x", "value += x * 2"));
+	CHECK(target_script->reload() == OK);
+
+	target = _instance(target_script);
+	CHECK(int(caller->call("calls", target, 2)) == 2 + 4);
+
+	// receivers with another script miss and are served by the regular path
+	Ref<Reference> other = _instance(_compile(String(target_source).replace("value += x", "value -= x")));
+	CHECK(int(caller->call("calls", other, 3)) == -6);
+
+	return true;
+}
+
+static const char *typed_source =
+		"extends Reference\n"
+		"func add_ints(a : int, b : int) -> int:\n"
+		"\treturn a + b\n"
+		"func scale(v : Vector2, f : float) -> Vector2:\n"
+		"\treturn v * f\n"
+		"func halve(x : float) -> float:\n"
+		"\treturn x / 2\n"
+		"func less(a : float, b : float) -> bool:\n"
+		"\treturn a < b\n"
+		"func count(n : int) -> int:\n"
+		"\tvar total := 0\n"
+		"\tfor i in range(n):\n"
+		"\t\ttotal += i\n"
+		"\treturn total\n"
+		"func untyped(x) -> int:\n"
+		"\treturn x\n"
+		"func mistyped_add(x):\n"
+		"\treturn untyped(x) + 1\n"
+		"func untyped_real(x) -> float:\n"
+		"\treturn x\n"
+		"func mistyped_divide(x):\n"
+		"\treturn 7 / untyped_real(x)\n"
+		"func mistyped_count(x):\n"
+		"\tvar total = 0\n"
+		"\tfor i in untyped(x):\n"
+		"\t\ttotal += i\n"
+		"\treturn total\n";
+
+// First opcode of a function, skipping the line markers.
+static int _get_first_opcode(const Ref<GDScript> &p_script, const StringName &p_function) {
+	const GDScriptFunction *function = p_script->get_member_functions()[p_function];
+	const int *code = function->get_code();
+	int ip = 0;
+	while (ip < function->get_code_size() && code[ip] == GDScriptFunction::OPCODE_LINE) {
+		ip += 2;
+	}
+	return ip < function->get_code_size() ? code[ip] : -1;
+}
+
+bool test_typed_operators() {
+	Ref<GDScript> script = _compile(typed_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	CHECK(_get_first_opcode(script, "add_ints") == GDScriptFunction::OPCODE_ADD_INT_INT);
+	CHECK(_get_first_opcode(script, "scale") == GDScriptFunction::OPCODE_MULTIPLY_VECTOR2_FLOAT);
+	CHECK(_get_first_opcode(script, "halve") == GDScriptFunction::OPCODE_DIVIDE_FLOAT_FLOAT);
+	CHECK(_get_first_opcode(script, "less") == GDScriptFunction::OPCODE_LESS_FLOAT_FLOAT);
+
+	Variant sum = instance->call("add_ints", 40, 2);
+	CHECK(sum.get_type() == Variant::INT && int(sum) == 42);
+	CHECK(Vector2(instance->call("scale", Vector2(1, 2), 1.5)) == Vector2(1.5, 3));
+	CHECK(double(instance->call("halve", 5.0)) == 2.5);
+	CHECK(bool(instance->call("less", 1.0, 2.0)));
+	CHECK(!bool(instance->call("less", 2.0, 1.0)));
+
+	// a typed function can still return another type, which takes the generic path
+	Variant mistyped = instance->call("mistyped_add", 2.5);
+	CHECK(mistyped.get_type() == Variant::REAL && double(mistyped) == 3.5);
+
+	// int constants used with floats stay ints, so int with int still gives an int
+	Variant divided = instance->call("mistyped_divide", 2);
+	CHECK(divided.get_type() == Variant::INT && int(divided) == 3);
+	divided = instance->call("mistyped_divide", 2.0);
+	CHECK(divided.get_type() == Variant::REAL && double(divided) == 3.5);
+
+	return true;
+}
+
+bool test_typed_iterate() {
+	Ref<GDScript> script = _compile(typed_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	CHECK(int(instance->call("count", 10)) == 45);
+	CHECK(int(instance->call("count", 1)) == 0);
+	CHECK(int(instance->call("count", 0)) == 0);
+	CHECK(int(instance->call("count", -3)) == 0);
+
+	// iterating a float counts like range(ceil(x))
+	CHECK(int(instance->call("mistyped_count", 4)) == 6);
+	CHECK(int(instance->call("mistyped_count", 2.5)) == 3);
+
+	return true;
+}
+
+static const char *ptrcall_source =
+		"extends Reference\n"
+		"func move(node : Node2D, v : Vector2):\n"
+		"\tnode.set_position(v)\n"
+		"func get_pos(node : Node2D) -> Vector2:\n"
+		"\treturn node.get_position()\n"
+		"func angle(node : Node2D, v : Vector2) -> float:\n"
+		"\treturn node.get_angle_to(node.to_global(v))\n"
+		"func untyped(x) -> float:\n"
+		"\treturn x\n"
+		"func rotate_by(node : Node2D, x):\n"
+		"\tnode.set_rotation(untyped(x))\n"
+		"\treturn node.get_rotation()\n"
+		"func move_untyped(node, v):\n"
+		"\tnode.set_position(v)\n"
+		"func fresh_max_value() -> float:\n"
+		"\treturn Curve.new().get_max_value()\n";
+
+bool test_ptrcall() {
+	Ref<GDScript> script = _compile(ptrcall_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	CHECK(_get_first_opcode(script, "move") == GDScriptFunction::OPCODE_CALL_PTRCALL);
+	CHECK(_get_first_opcode(script, "get_pos") == GDScriptFunction::OPCODE_CALL_PTRCALL_RETURN);
+	CHECK(_get_first_opcode(script, "move_untyped") == GDScriptFunction::OPCODE_CALL);
+
+	Node2D *node = memnew(Node2D);
+
+	instance->call("move", node, Vector2(3, 4));
+	CHECK(node->get_position() == Vector2(3, 4));
+	CHECK(Vector2(instance->call("get_pos", node)) == Vector2(3, 4));
+
+	// the result of the inner call is an argument of the outer one, and has another type
+	node->set_position(Vector2());
+	CHECK(Math::is_equal_approx(double(instance->call("angle", node, Vector2(0, 1))), Math_PI / 2));
+
+	// an int where a float is declared takes the regular path, which converts it
+	Variant rotation = instance->call("rotate_by", node, 2);
+	CHECK(rotation.get_type() == Variant::REAL && double(rotation) == 2.0);
+
+	instance->call("move_untyped", node, Vector2(5, 6));
+	CHECK(node->get_position() == Vector2(5, 6));
+
+	// the new curve is only referenced by the stack slot the result is written to
+	Variant max_value = instance->call("fresh_max_value");
+	CHECK(max_value.get_type() == Variant::REAL && double(max_value) == 1.0);
+
+	memdelete(node);
+
+	return true;
+}
+
+static const char *cache_source =
+		"extends Reference\n"
+		"signal changed(value)\n"
+		"const LIMITS = {\"min\": [1, 2], \"max\": Vector2(3, 4)}\n"
+		"class Counter:\n"
+		"\tvar count : int = 0\n"
+		"\tfunc add(n = 1):\n"
+		"\t\tcount += n\n"
+		"\t\treturn count\n"
+		"var value = 5 setget set_value\n"
+		"var counter = Counter.new()\n"
+		"func set_value(v):\n"
+		"\tvalue = v * 2\n"
+		"\temit_signal(\"changed\", value)\n"
+		"static func square(x : int) -> int:\n"
+		"\treturn x * x\n"
+		"func run():\n"
+		"\tcounter.add()\n"
+		"\tcounter.add(3)\n"
+		"\tself.value = square(counter.count)\n"
+		"\tvar node = Node.new()\n"
+		"\tvar is_node = node is Node\n"
+		"\tnode.free()\n"
+		"\treturn [value, LIMITS[\"min\"][1], is_node, Engine.get_iterations_per_second() > 0]\n";
+
+bool test_bytecode_cache() {
+	Ref<GDScript> script = _compile(cache_source);
+	CHECK(script.is_valid());
+
+	CharString utf8 = String(cache_source).utf8();
+	Vector<uint8_t> source;
+	source.resize(utf8.length());
+	memcpy(source.ptrw(), utf8.get_data(), utf8.length());
+
+#ifdef DEBUG_ENABLED
+	const bool debug = true;
+#else
+	const bool debug = false;
+#endif
+	Vector<uint8_t> cache;
+	CHECK(GDScriptBytecodeCache::save(script, source, debug, cache) == OK);
+
+	Ref<GDScript> loaded;
+	loaded.instance();
+	CHECK(GDScriptBytecodeCache::load(loaded.ptr(), cache, source) == OK);
+	CHECK(loaded->is_valid());
+	CHECK(loaded->get_subclasses().has("Counter"));
+	CHECK(loaded->has_script_signal("changed"));
+	CHECK(loaded->get_member_functions().size() == script->get_member_functions().size());
+
+	// globals (Node, Engine) are resolved by name, the setter and the inner class still work
+	Ref<Reference> instance = _instance(loaded);
+	Array result = instance->call("run");
+	CHECK(result.size() == 4);
+	CHECK(int(result[0]) == 32);
+	CHECK(int(result[1]) == 2);
+	CHECK(bool(result[2]));
+	CHECK(bool(result[3]));
+
+	// a cache made from another source is refused
+	Vector<uint8_t> changed = source;
+	changed.write[0] = '#';
+	Ref<GDScript> stale;
+	stale.instance();
+	CHECK(GDScriptBytecodeCache::load(stale.ptr(), cache, changed) != OK);
+	CHECK(!stale->is_valid());
+
+	// damaged data is detected before anything is loaded
+	Vector<uint8_t> damaged = cache;
+	damaged.write[damaged.size() - 1] ^= 0xFF;
+	Ref<GDScript> corrupt;
+	corrupt.instance();
+	CHECK(GDScriptBytecodeCache::load(corrupt.ptr(), damaged, source) != OK);
+	CHECK(corrupt->get_member_functions().empty());
+
+	return true;
+}
+
+static const char *yield_source =
+		"extends Reference\n"
+		"func gen(n):\n"
+		"\tvar text = \"v\"\n"
+		"\tvar total = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tvar got = yield()\n"
+		"\t\ttotal += got\n"
+		"\t\ttext += str(got)\n"
+		"\treturn [total, text]\n"
+		"func run(n):\n"
+		"\tvar state = gen(n)\n"
+		"\tvar i = 1\n"
+		"\twhile state is GDScriptFunctionState:\n"
+		"\t\tstate = state.resume(i)\n"
+		"\t\ti += 1\n"
+		"\treturn state\n";
+
+bool test_yield_resume() {
+	Ref<GDScript> script = _compile(yield_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	// the stack (with a string and a loop counter) survives every resume
+	Array result = instance->call("run", 5);
+	CHECK(result.size() == 2);
+	CHECK(int(result[0]) == 15);
+	CHECK(String(result[1]) == "v12345");
+
+	// stacks of finished states are reused by the next yields
+	for (int i = 0; i < 3; i++) {
+		result = instance->call("run", 200);
+		CHECK(int(result[0]) == 20100);
+	}
+
+	Variant pending = instance->call("gen", 2);
+	Ref<GDScriptFunctionState> state = pending;
+	CHECK(state.is_valid());
+	CHECK(state->is_valid(true));
+	state = state->resume(4);
+	CHECK(state.is_valid() && state->is_valid(true));
+	result = state->resume(6);
+	CHECK(int(result[0]) == 10);
+	CHECK(String(result[1]) == "v46");
+	CHECK(!state->is_valid());
+
+	return true;
+}
+
+static const char *folding_source =
+		"extends Reference\n"
+		"const DEBUG_CONST = false\n"
+		"const SCALE = 2\n"
+		"const ORIGIN = Vector2(1, 2)\n"
+		"class Inner:\n"
+		"\tconst OFFSET = 10\n"
+		"func flag():\n"
+		"\tif DEBUG_CONST:\n"
+		"\t\treturn 1\n"
+		"\treturn 2\n"
+		"func scaled():\n"
+		"\treturn ORIGIN * SCALE\n"
+		"func offset():\n"
+		"\treturn Inner.OFFSET * SCALE + SCALE\n"
+		"func pick():\n"
+		"\tmatch SCALE:\n"
+		"\t\t1:\n"
+		"\t\t\treturn \"one\"\n"
+		"\t\t2:\n"
+		"\t\t\treturn \"two\"\n"
+		"\t\t_:\n"
+		"\t\t\treturn \"other\"\n"
+		"func count():\n"
+		"\tvar total = 0\n"
+		"\twhile DEBUG_CONST:\n"
+		"\t\ttotal += 1\n"
+		"\treturn total\n"
+		"func divide():\n"
+		"\treturn SCALE / (SCALE - 2)\n";
+
+bool test_constant_folding() {
+	Ref<GDScript> script = _compile(folding_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	// constant conditions and expressions leave nothing to evaluate before the return
+	CHECK(_get_first_opcode(script, "flag") == GDScriptFunction::OPCODE_RETURN);
+	CHECK(_get_first_opcode(script, "scaled") == GDScriptFunction::OPCODE_RETURN);
+	CHECK(_get_first_opcode(script, "offset") == GDScriptFunction::OPCODE_RETURN);
+
+	CHECK(int(instance->call("flag")) == 2);
+	CHECK(Vector2(instance->call("scaled")) == Vector2(2, 4));
+	CHECK(int(instance->call("offset")) == 22);
+	CHECK(String(instance->call("pick")) == "two");
+	CHECK(int(instance->call("count")) == 0);
+
+	// an operation that fails on constants still compiles, the error is left for the runtime
+	CHECK(_get_first_opcode(script, "divide") != GDScriptFunction::OPCODE_RETURN);
+
+	return true;
+}
+
+static const char *superinstruction_source =
+		"extends Node2D\n"
+		"func countdown(n):\n"
+		"\tvar steps = 0\n"
+		"\twhile n > 0:\n"
+		"\t\tn -= 1\n"
+		"\t\tsteps += 1\n"
+		"\treturn steps\n"
+		"func sign_of(x):\n"
+		"\tif x < 0:\n"
+		"\t\treturn -1\n"
+		"\telif x == 0:\n"
+		"\t\treturn 0\n"
+		"\treturn 1\n"
+		"func nudge(v):\n"
+		"\tposition += v\n"
+		"\trotation -= 0.5\n"
+		"func teleport():\n"
+		"\tposition = Vector2(10, 10)\n"
+		"\treturn Vector2(1, 1)\n"
+		"func nudge_after_teleport():\n"
+		"\tposition += teleport()\n";
+
+bool test_superinstructions() {
+	Ref<GDScript> script = _compile(superinstruction_source);
+	CHECK(script.is_valid());
+	Node2D *node = memnew(Node2D);
+	node->set_script(script.get_ref_ptr());
+
+	CHECK(_get_first_opcode(script, "sign_of") == GDScriptFunction::OPCODE_JUMP_IF_NOT_COMPARE);
+	CHECK(_get_first_opcode(script, "nudge") == GDScriptFunction::OPCODE_OPERATOR_MEMBER);
+
+	CHECK(int(node->call("countdown", 5)) == 5);
+	CHECK(int(node->call("countdown", -2)) == 0);
+	CHECK(int(node->call("countdown", 2.5)) == 3);
+
+	// ints, floats and mixed operands, which take the generic comparison
+	CHECK(int(node->call("sign_of", -3)) == -1);
+	CHECK(int(node->call("sign_of", 0)) == 0);
+	CHECK(int(node->call("sign_of", 0.25)) == 1);
+	CHECK(int(node->call("sign_of", -0.25)) == -1);
+
+	node->set_position(Vector2(1, 1));
+	node->call("nudge", Vector2(2, 3));
+	CHECK(node->get_position() == Vector2(3, 4));
+	CHECK(Math::is_equal_approx(node->get_rotation(), (real_t)-0.5));
+
+	// the property is read before the value is evaluated, so the call doesn't take the fused opcode
+	CHECK(_get_first_opcode(script, "nudge_after_teleport") != GDScriptFunction::OPCODE_OPERATOR_MEMBER);
+	node->set_position(Vector2(1, 1));
+	node->call("nudge_after_teleport");
+	CHECK(node->get_position() == Vector2(2, 2));
+
+	memdelete(node);
+
+	return true;
+}
+
+static const char *range_source =
+		"extends Reference\n"
+		"func collect(from, to, step):\n"
+		"\tvar values = []\n"
+		"\tfor i in range(from, to, step):\n"
+		"\t\tvalues.append(i)\n"
+		"\treturn values\n"
+		"func between(from, to):\n"
+		"\tvar values = []\n"
+		"\tfor i in range(from, to):\n"
+		"\t\tvalues.append(i)\n"
+		"\treturn values\n"
+		"func countdown(n):\n"
+		"\tfor i in range(n, 0, -1):\n"
+		"\t\tn += i\n"
+		"\treturn n\n"
+		"func skip_odd(n):\n"
+		"\tvar total = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tif i % 2:\n"
+		"\t\t\tcontinue\n"
+		"\t\ti = -100\n"
+		"\t\ttotal += 1\n"
+		"\treturn total\n";
+
+bool test_range_loop() {
+	Ref<GDScript> script = _compile(range_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	// The loop starts by storing its bounds, there is no call to range().
+	CHECK(_get_first_opcode(script, "countdown") == GDScriptFunction::OPCODE_ASSIGN);
+
+	Array values = instance->call("collect", 0, 10, 3);
+	CHECK(values.size() == 4 && int(values[0]) == 0 && int(values[3]) == 9);
+	values = instance->call("collect", 10, 0, -4);
+	CHECK(values.size() == 3 && int(values[0]) == 10 && int(values[2]) == 2);
+	CHECK(Array(instance->call("collect", 0, 10, -1)).empty());
+	CHECK(Array(instance->call("collect", 5, 5, 1)).empty());
+
+	// Large bounds stay exact ints.
+	values = instance->call("between", 100000000, 100000003);
+	CHECK(values.size() == 3 && values[1].get_type() == Variant::INT && int(values[1]) == 100000001);
+	values = instance->call("between", 1.5, 4.5);
+	CHECK(values.size() == 3 && int(values[0]) == 1 && int(values[2]) == 3);
+
+	// The bound is evaluated once, assigning to the loop variable doesn't change the count.
+	CHECK(int(instance->call("countdown", 4)) == 14);
+	CHECK(int(instance->call("countdown", -4)) == -4);
+	CHECK(int(instance->call("skip_odd", 10)) == 5);
+
+	return true;
+}
+
+static const char *sampling_source =
+		"extends Reference\n"
+		"func busy(n):\n"
+		"\tvar total = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\ttotal += step(i)\n"
+		"\treturn total\n"
+		"func step(i):\n"
+		"\treturn i % 7\n";
+
+bool test_sampling_profiler() {
+#ifdef DEBUG_ENABLED
+	Ref<GDScript> script = _compile(sampling_source);
+	CHECK(script.is_valid());
+	Ref<Reference> instance = _instance(script);
+
+	GDScriptSamplingProfiler *profiler = GDScriptLanguage::get_singleton()->get_sampling_profiler();
+	CHECK(!profiler->is_active());
+	uint32_t interval = profiler->get_interval_usec();
+	profiler->clear();
+	profiler->set_interval_usec(100);
+	profiler->start();
+
+	uint64_t begin = OS::get_singleton()->get_ticks_msec();
+	while (OS::get_singleton()->get_ticks_msec() - begin < 200) {
+		instance->call("busy", 1000);
+	}
+
+	profiler->stop();
+	profiler->set_interval_usec(interval);
+
+	CHECK(profiler->get_sample_count() > 0);
+	// Every sample is taken inside busy(), the outermost frame.
+	String collapsed = profiler->get_collapsed_stacks();
+	Vector<String> stacks = collapsed.strip_edges().split("\n");
+	for (int i = 0; i < stacks.size(); i++) {
+		CHECK(stacks[i].begins_with("<built-in>:busy:"));
+	}
+	CHECK(profiler->get_report().find("<built-in>:busy:") != -1);
+
+	profiler->clear();
+	CHECK(profiler->get_collapsed_stacks() == "");
+#endif
+
+	return true;
+}
+
+typedef bool (*TestFunc)();
+TestFunc test_funcs[] = {
+	test_call_cache,
+	test_member_cache,
+	test_native_cache,
+	test_cache_invalidation,
+	test_typed_operators,
+	test_typed_iterate,
+	test_ptrcall,
+	test_bytecode_cache,
+	test_yield_resume,
+	test_constant_folding,
+	test_superinstructions,
+	test_sampling_profiler,
+	test_range_loop,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+} // namespace TestGDScriptVM
+
+#else
+
+namespace TestGDScriptVM {
+
+MainLoop *test() {
+	ERR_PRINT("The GDScript module is disabled, therefore GDScript VM tests cannot be used.");
+	return nullptr;
+}
+} // namespace TestGDScriptVM
+
+#endif
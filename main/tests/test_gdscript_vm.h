@@ -0,0 +1,16 @@
+/**************************************************************************/
+/*  test_gdscript_vm.h                                                    */
+/**************************************************************************/
+
+
+#ifndef TEST_GDSCRIPT_VM_H
+#define TEST_GDSCRIPT_VM_H
+
+#include "core/os/main_loop.h"
+
+namespace TestGDScriptVM {
+
+MainLoop *test();
+}
+
+#endif // TEST_GDSCRIPT_VM_H
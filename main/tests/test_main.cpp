@@ -9,15 +9,21 @@
 
 #ifdef DEBUG_ENABLED
 
+#include "test_allocation_profiler.h"
 #include "test_basis.h"
+#include "test_bench.h"
+#include "test_canvas_batching.h"
 #include "test_crypto.h"
+#include "test_frame_profiler.h"
 #include "test_gdscript.h"
+#include "test_gdscript_vm.h"
 #include "test_gui.h"
 #include "test_math.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
+#include "test_scene.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
 #include "test_theme.h"
@@ -33,6 +39,12 @@ const char **tests_get_names() {
 		"physics",
 		"physics_2d",
 		"render",
+		"canvas_batching",
+		"frame_profiler",
+		"allocation_profiler",
+		"scene",
+		"bench",
+		"gdscript_vm",
 		"oa_hash_map",
 		"gui",
 		"shaderlang",
@@ -75,6 +87,30 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestRender::test();
 	}
 
+	if (p_test == "canvas_batching") {
+		return TestCanvasBatching::test();
+	}
+
+	if (p_test == "frame_profiler") {
+		return TestFrameProfiler::test();
+	}
+
+	if (p_test == "allocation_profiler") {
+		return TestAllocationProfiler::test();
+	}
+
+	if (p_test == "scene") {
+		return TestScene::test();
+	}
+
+	if (p_test == "bench") {
+		return TestBench::test(p_args);
+	}
+
+	if (p_test == "gdscript_vm") {
+		return TestGDScriptVM::test();
+	}
+
 	if (p_test == "oa_hash_map") {
 		return TestOAHashMap::test();
 	}
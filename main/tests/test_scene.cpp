@@ -0,0 +1,663 @@
+/**************************************************************************/
+/*  test_scene.cpp                                                        */
+/**************************************************************************/
+
+
+#include "test_scene.h"
+
+#include "core/message_queue.h"
+#include "core/os/os.h"
+#include "scene/2d/camera_2d.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/node_pool.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/timer.h"
+#include "scene/resources/packed_scene.h"
+#include "servers/visual/visual_server_canvas.h"
+#include "servers/visual/visual_server_globals.h"
+
+#define CHECK(X)                                                             \
+	if (!(X)) {                                                              \
+		OS::get_singleton()->print("\tFAIL at line %d: %s\n", __LINE__, #X); \
+		return false;                                                        \
+	} else {                                                                 \
+		OS::get_singleton()->print("\tPASS\n");                              \
+	}
+
+namespace TestScene {
+
+static Ref<PackedScene> _pack_test_scene() {
+	Node2D *root = memnew(Node2D);
+	root->set_name("Root");
+	root->set_position(Vector2(10, 20));
+	root->set_rotation(0.5);
+	root->set_z_index(3);
+	root->set_modulate(Color(1, 0.5, 0.25));
+	root->add_to_group("spawned", true);
+
+	Timer *timer = memnew(Timer);
+	timer->set_name("Timer");
+	timer->set_wait_time(2.5);
+	timer->set_one_shot(true);
+	root->add_child(timer);
+	timer->set_owner(root);
+
+	// Indexed properties, set_limit(MARGIN_*, value).
+	Camera2D *camera = memnew(Camera2D);
+	camera->set_name("Camera");
+	camera->set_limit(MARGIN_LEFT, -100);
+	camera->set_limit(MARGIN_BOTTOM, 400);
+	root->add_child(camera);
+	camera->set_owner(root);
+
+	Ref<PackedScene> scene;
+	scene.instance();
+	Error err = scene->pack(root);
+	memdelete(root);
+	ERR_FAIL_COND_V(err != OK, Ref<PackedScene>());
+	return scene;
+}
+
+bool test_instance_plan() {
+	Ref<PackedScene> scene = _pack_test_scene();
+	CHECK(scene.is_valid());
+
+	// The first instance builds the plan, the second one replays it.
+	for (int i = 0; i < 2; i++) {
+		Node2D *root = Object::cast_to<Node2D>(scene->instance());
+		CHECK(root);
+		CHECK(root->get_name() == "Root");
+		CHECK(root->get_position() == Vector2(10, 20));
+		CHECK(Math::is_equal_approx(root->get_rotation(), (real_t)0.5));
+		CHECK(root->get_z_index() == 3);
+		CHECK(root->get_modulate() == Color(1, 0.5, 0.25));
+		CHECK(root->is_in_group("spawned"));
+
+		Timer *timer = Object::cast_to<Timer>(root->get_node_or_null(NodePath("Timer")));
+		CHECK(timer);
+		CHECK(timer->get_owner() == root);
+		CHECK(Math::is_equal_approx(timer->get_wait_time(), 2.5f));
+		CHECK(timer->is_one_shot());
+
+		Camera2D *camera = Object::cast_to<Camera2D>(root->get_node_or_null(NodePath("Camera")));
+		CHECK(camera);
+		CHECK(camera->get_limit(MARGIN_LEFT) == -100);
+		CHECK(camera->get_limit(MARGIN_BOTTOM) == 400);
+
+		memdelete(root);
+	}
+
+	// Changing the state discards the plan.
+	Ref<SceneState> state = scene->get_state();
+	state->add_node_property(0, state->add_name("position"), state->add_value(Vector2(-5, 5)));
+	Node2D *root = Object::cast_to<Node2D>(scene->instance());
+	CHECK(root);
+	CHECK(root->get_position() == Vector2(-5, 5));
+	memdelete(root);
+
+	return true;
+}
+
+static bool _check_instance_async(const Ref<PackedScene> &p_scene) {
+	Ref<SceneInstanceTask> task = p_scene->instance_async();
+	CHECK(task.is_valid());
+	Node2D *root = Object::cast_to<Node2D>(task->wait());
+	CHECK(root);
+	CHECK(task->get_status() == SceneInstanceTask::STATUS_DONE);
+	CHECK(task->get_node() == root);
+	CHECK(!root->is_inside_tree());
+	CHECK(root->get_position() == Vector2(10, 20));
+	CHECK(root->get_node_or_null(NodePath("Timer")));
+	memdelete(root);
+
+	// With a parent, the scene is added to it when committed.
+	Node *parent = memnew(Node);
+	task = p_scene->instance_async(parent);
+	Node *child = task->wait();
+	bool added = child && child->get_parent() == parent;
+	memdelete(parent);
+	CHECK(added);
+
+	// Canceled tasks free what was built, if anything.
+	task = p_scene->instance_async();
+	task->cancel();
+	CHECK(task->get_status() == SceneInstanceTask::STATUS_CANCELED);
+	CHECK(task->wait() == nullptr);
+
+	return true;
+}
+
+bool test_instance_async() {
+	Ref<PackedScene> scene = _pack_test_scene();
+	CHECK(scene.is_valid());
+
+	// Tests don't run a main loop, so use a tree of our own.
+	SceneTree *tree = nullptr;
+	if (!SceneTree::get_singleton()) {
+		tree = memnew(SceneTree);
+	}
+	bool pass = _check_instance_async(scene);
+	if (tree) {
+		memdelete(tree);
+	}
+	return pass;
+}
+
+bool test_node_pool() {
+	Ref<NodePool> pool;
+	pool.instance();
+	pool->set_scene(_pack_test_scene());
+	CHECK(pool->get_scene().is_valid());
+
+	Node *parent = memnew(Node);
+	Node *sibling = memnew(Node);
+	sibling->set_name("Root");
+	parent->add_child(sibling);
+
+	Node2D *root = Object::cast_to<Node2D>(pool->acquire());
+	CHECK(root);
+	CHECK(pool->get_miss_count() == 1);
+	parent->add_child(root);
+	CHECK(String(root->get_name()) != "Root");
+	root->set_position(Vector2(1, 1));
+	root->set_visible(false);
+	Timer *timer = Object::cast_to<Timer>(root->get_node_or_null(NodePath("Timer")));
+	CHECK(timer);
+	timer->set_wait_time(10);
+
+	// Released nodes leave the tree and get the values of the scene back.
+	pool->release(root);
+	CHECK(root->get_parent() == nullptr);
+	CHECK(pool->get_available_count() == 1);
+	CHECK(pool->get_in_use_count() == 0);
+	CHECK(root->get_name() == "Root");
+	CHECK(root->get_position() == Vector2(10, 20));
+	CHECK(root->is_visible());
+	CHECK(Math::is_equal_approx(timer->get_wait_time(), 2.5f));
+
+	CHECK(pool->acquire() == root);
+	CHECK(pool->get_hit_count() == 1);
+
+	// Beyond the maximum size, released nodes are freed.
+	pool->set_max_size(1);
+	Node *other = pool->acquire();
+	CHECK(other && other != root);
+	pool->release(root);
+	pool->release(other);
+	CHECK(pool->get_available_count() == 1);
+
+	memdelete(parent);
+	return true;
+}
+
+class ProcessCounter : public Node {
+	GDCLASS(ProcessCounter, Node);
+
+protected:
+	void _notification(int p_what) {
+		if (p_what != NOTIFICATION_PROCESS) {
+			return;
+		}
+		processed++;
+		order.push_back(this);
+		if (stop_other) {
+			stop_other->set_process(false);
+		}
+		if (start_other) {
+			start_other->set_process(true);
+		}
+	}
+
+public:
+	static Vector<Node *> order;
+	int processed = 0;
+	Node *stop_other = nullptr;
+	Node *start_other = nullptr;
+};
+
+Vector<Node *> ProcessCounter::order;
+
+bool test_process_lists() {
+	CHECK(!SceneTree::get_singleton());
+	SceneTree *tree = memnew(SceneTree);
+	tree->init();
+	Node *root = tree->get_root();
+
+	ProcessCounter *a = memnew(ProcessCounter);
+	ProcessCounter *b = memnew(ProcessCounter);
+	ProcessCounter *c = memnew(ProcessCounter);
+	ProcessCounter *d = memnew(ProcessCounter);
+	root->add_child(a);
+	root->add_child(b);
+	root->add_child(c);
+	root->add_child(d);
+	a->set_process_priority(1);
+	a->set_process(true);
+	b->set_process(true);
+	c->set_process(true);
+
+	// Lower priority first, then tree order. Changes made while processing apply to the next frame.
+	b->stop_other = c;
+	b->start_other = d;
+	ProcessCounter::order.clear();
+	tree->idle(0);
+	bool ordered = ProcessCounter::order.size() == 2 && ProcessCounter::order[0] == b && ProcessCounter::order[1] == a;
+	bool deferred = c->processed == 0 && d->processed == 0 && d->is_processing();
+
+	b->start_other = nullptr;
+	b->stop_other = nullptr;
+	tree->idle(0);
+	bool joined = d->processed == 1 && c->processed == 0;
+
+	// Paused nodes skip processing, unless they process while paused.
+	c->set_process(true);
+	c->set_pause_mode(Node::PAUSE_MODE_PROCESS);
+	tree->set_pause(true);
+	tree->idle(0);
+	bool paused = a->processed == 2 && c->processed == 1;
+	tree->set_pause(false);
+	tree->idle(0);
+	bool unpaused = a->processed == 3;
+
+	tree->finish();
+	memdelete(tree);
+
+	CHECK(ordered);
+	CHECK(deferred);
+	CHECK(joined);
+	CHECK(paused);
+	CHECK(unpaused);
+	return true;
+}
+
+class ThreadedCounter : public Node {
+	GDCLASS(ThreadedCounter, Node);
+
+protected:
+	void _notification(int p_what) {
+		if (p_what != NOTIFICATION_PROCESS) {
+			return;
+		}
+		processed++;
+		in_process_thread = SceneTree::is_in_process_thread();
+		call_deferred("set_meta", "processed", processed);
+	}
+
+public:
+	int processed = 0;
+	bool in_process_thread = false;
+};
+
+bool test_process_thread_groups() {
+	CHECK(!SceneTree::get_singleton());
+	SceneTree *tree = memnew(SceneTree);
+	tree->init();
+	Node *root = tree->get_root();
+
+	// The counters don't use the servers, so the default thread models don't matter.
+	tree->set_process_threads_allowed(true);
+	bool threads = tree->are_process_threads_allowed();
+
+	// Group members are interleaved with main thread nodes, they are still processed as one batch.
+	Vector<ThreadedCounter *> counters;
+	for (int i = 0; i < 256; i++) {
+		ThreadedCounter *counter = memnew(ThreadedCounter);
+		counter->set_process_thread_group(i % 2);
+		counter->set_process(true);
+		root->add_child(counter);
+		counters.push_back(counter);
+	}
+
+	tree->idle(0);
+	tree->idle(0);
+
+	bool processed = true;
+	bool deferred = true;
+	bool main_thread = true;
+	bool worker_thread = true;
+	for (int i = 0; i < counters.size(); i++) {
+		ThreadedCounter *counter = counters[i];
+		processed = processed && counter->processed == 2;
+		deferred = deferred && int(counter->get_meta("processed", 0)) == 2;
+		if (counter->get_process_thread_group() == 0) {
+			main_thread = main_thread && !counter->in_process_thread;
+		} else {
+			worker_thread = worker_thread && counter->in_process_thread == threads;
+		}
+	}
+	bool outside = !SceneTree::is_in_process_thread();
+
+	tree->finish();
+	memdelete(tree);
+
+	CHECK(processed);
+	CHECK(deferred);
+	CHECK(main_thread);
+	CHECK(worker_thread);
+	CHECK(outside);
+	return true;
+}
+
+bool test_node_lookup() {
+	// Enough children to be indexed by name.
+	Node *root = memnew(Node);
+	for (int i = 0; i < 100; i++) {
+		Node *child = memnew(Node);
+		child->set_name("Child" + itos(i));
+		root->add_child(child);
+	}
+	Node *middle = root->get_node(NodePath("Child50"));
+	Node *inner = memnew(Node);
+	inner->set_name("Inner");
+	middle->add_child(inner);
+
+	bool found = root->get_node_or_null(NodePath("Child99")) == root->get_child(99) && middle && middle->get_name() == "Child50";
+	bool nested = root->get_node_or_null(NodePath("Child50/Inner")) == inner && root->get_node_or_null(NodePath("Child50/Inner")) == inner;
+
+	// Taken names still get made unique.
+	Node *duplicate = memnew(Node);
+	duplicate->set_name("Child10");
+	root->add_child(duplicate);
+	bool unique = String(duplicate->get_name()) != "Child10" && root->get_node_or_null(NodePath("Child10")) == root->get_child(10);
+
+	// Cached lookups follow renames and removals.
+	inner->set_name("Renamed");
+	bool renamed = root->get_node_or_null(NodePath("Child50/Inner")) == nullptr && root->get_node_or_null(NodePath("Child50/Renamed")) == inner;
+	middle->set_name("Middle");
+	bool parent_renamed = root->get_node_or_null(NodePath("Child50/Renamed")) == nullptr && root->get_node_or_null(NodePath("Middle/Renamed")) == inner && root->get_node_or_null(NodePath("Child50")) == nullptr;
+	middle->remove_child(inner);
+	bool removed = root->get_node_or_null(NodePath("Middle/Renamed")) == nullptr;
+	memdelete(inner);
+
+	// Lookups from the removed node itself that went up to its parent.
+	Node *first = root->get_child(0);
+	bool sibling = first->get_node_or_null(NodePath("../Child1")) == root->get_child(1);
+	root->remove_child(first);
+	bool detached = sibling && first->get_node_or_null(NodePath("../Child1")) == nullptr;
+	memdelete(first);
+
+	// Back to scanning once most children are gone.
+	while (root->get_child_count() > 4) {
+		Node *child = root->get_child(0);
+		root->remove_child(child);
+		memdelete(child);
+	}
+	bool scanned = root->get_node_or_null(NodePath("Child99")) == root->get_child(2) && root->get_node_or_null(NodePath("Child0")) == nullptr;
+
+	memdelete(root);
+
+	CHECK(found);
+	CHECK(nested);
+	CHECK(unique);
+	CHECK(renamed);
+	CHECK(parent_renamed);
+	CHECK(removed);
+	CHECK(detached);
+	CHECK(scanned);
+	return true;
+}
+
+bool test_budgeted_deletion() {
+	// Tests don't run a main loop, and this needs a tree of its own that it can step and finish.
+	CHECK(!SceneTree::get_singleton());
+
+	SceneTree *tree = memnew(SceneTree);
+	tree->init();
+	tree->set_delete_budget_usec(1);
+
+	Node *swarm = memnew(Node);
+	for (int i = 0; i < 200; i++) {
+		swarm->add_child(memnew(Node));
+	}
+	tree->get_root()->add_child(swarm);
+	ObjectID swarm_id = swarm->get_instance_id();
+	Node *first = swarm->get_child(0);
+	ObjectID first_id = first->get_instance_id();
+	tree->get_root()->connect("renamed", first, "queue_free");
+
+	// Out of the tree at the end of the frame, destroyed over the next ones. Signals no longer
+	// reach nodes waiting to be destroyed.
+	swarm->queue_delete();
+	tree->idle(0);
+	bool detached = tree->get_root()->get_child_count() == 0;
+	bool pending = tree->get_pending_deletion_count() > 0 && ObjectDB::get_instance(swarm_id) != nullptr;
+	bool disconnected = ObjectDB::get_instance(first_id) == first && !tree->get_root()->is_connected("renamed", first, "queue_free");
+
+	int frames = 1;
+	while (tree->get_pending_deletion_count() > 0 && frames < 1000) {
+		tree->idle(0);
+		frames++;
+	}
+	bool spread = frames > 1;
+	bool destroyed = ObjectDB::get_instance(swarm_id) == nullptr && ObjectDB::get_instance(first_id) == nullptr;
+
+	// Whatever is left is destroyed when the tree finishes.
+	Node *other = memnew(Node);
+	for (int i = 0; i < 200; i++) {
+		other->add_child(memnew(Node));
+	}
+	ObjectID other_id = other->get_instance_id();
+	other->queue_delete();
+	tree->idle(0);
+
+	tree->finish();
+	memdelete(tree);
+	bool finished = ObjectDB::get_instance(other_id) == nullptr;
+
+	CHECK(detached);
+	CHECK(pending);
+	CHECK(disconnected);
+	CHECK(spread);
+	CHECK(destroyed);
+	CHECK(finished);
+	return true;
+}
+
+// The transform the visual server has for the node.
+static bool _get_sent_transform(const Node2D *p_node, Transform2D &r_transform) {
+	VisualServer::get_singleton()->sync();
+	VisualServerCanvas::Item *item = VSG::canvas ? VSG::canvas->canvas_item_owner.getornull(p_node->get_canvas_item()) : nullptr;
+	if (!item) {
+		return false;
+	}
+	r_transform = item->xform;
+	return true;
+}
+
+class ThreadedMover : public Node2D {
+	GDCLASS(ThreadedMover, Node2D);
+
+protected:
+	void _notification(int p_what) {
+		if (p_what == NOTIFICATION_PROCESS) {
+			set_position(get_position() + Vector2(1, 0));
+		}
+	}
+};
+
+bool test_canvas_transforms() {
+	// Tests don't run a main loop, and this needs a tree of its own that it can step and finish.
+	CHECK(!SceneTree::get_singleton());
+
+	SceneTree *tree = memnew(SceneTree);
+	tree->init();
+	Node2D *node = memnew(Node2D);
+	tree->get_root()->add_child(node);
+	Transform2D sent;
+
+	// Moves are sent when the frame ends, after the deferred calls flushed once idle() returns.
+	node->set_position(Vector2(1, 2));
+	tree->idle(0);
+	node->call_deferred("set_position", Vector2(3, 4));
+	MessageQueue::get_singleton()->flush();
+	bool held = _get_sent_transform(node, sent) && sent.get_origin() == Vector2();
+	tree->idle_end();
+	bool sent_last = _get_sent_transform(node, sent) && sent.get_origin() == Vector2(3, 4);
+
+	// Moves made in a process thread are sent along with the others.
+	tree->set_process_threads_allowed(true);
+	ThreadedMover *mover = memnew(ThreadedMover);
+	mover->set_process_thread_group(1);
+	mover->set_process(true);
+	tree->get_root()->add_child(mover);
+	tree->idle(0);
+	bool thread_held = _get_sent_transform(mover, sent) && sent.get_origin() == Vector2();
+	tree->idle_end();
+	bool thread_sent = _get_sent_transform(mover, sent) && sent.get_origin() == Vector2(1, 0);
+	tree->get_root()->remove_child(mover);
+	memdelete(mover);
+
+	// A pending move is sent when the node leaves the tree, and out of the tree moves are sent at once.
+	node->set_position(Vector2(5, 6));
+	tree->get_root()->remove_child(node);
+	bool sent_on_exit = _get_sent_transform(node, sent) && sent.get_origin() == Vector2(5, 6);
+	node->set_position(Vector2(7, 8));
+	bool sent_outside = _get_sent_transform(node, sent) && sent.get_origin() == Vector2(7, 8);
+
+	memdelete(node);
+	tree->finish();
+	memdelete(tree);
+
+	CHECK(held);
+	CHECK(sent_last);
+	CHECK(thread_held);
+	CHECK(thread_sent);
+	CHECK(sent_on_exit);
+	CHECK(sent_outside);
+	return true;
+}
+
+bool test_signal_emission() {
+	Node *emitter = memnew(Node);
+	Node *target = memnew(Node);
+	emitter->add_user_signal(MethodInfo("named", PropertyInfo(Variant::STRING, "name")));
+	emitter->add_user_signal(MethodInfo("flagged"));
+
+	// Native targets, called through the method resolved on the first emission.
+	emitter->connect("named", target, "set_name");
+	emitter->emit_signal("named", "First");
+	emitter->emit_signal("named", "Second");
+	bool native = target->get_name() == "Second";
+
+	// Binds are appended to the arguments.
+	Vector<Variant> binds;
+	binds.push_back("bound");
+	binds.push_back(42);
+	emitter->connect("flagged", target, "set_meta", binds, Object::CONNECT_ONESHOT);
+	emitter->emit_signal("flagged");
+	bool bound = int(target->get_meta("bound", 0)) == 42;
+	bool oneshot = !emitter->is_connected("flagged", target, "set_meta");
+
+	// Freed targets are disconnected.
+	memdelete(target);
+	List<Object::Connection> connections;
+	emitter->get_signal_connection_list("named", &connections);
+	bool freed = connections.empty() && emitter->emit_signal("named", "Third") == OK;
+
+	memdelete(emitter);
+
+	CHECK(native);
+	CHECK(bound);
+	CHECK(oneshot);
+	CHECK(freed);
+	return true;
+}
+
+bool test_group_calls() {
+	// Tests don't run a main loop, and this needs a tree of its own that it can step and finish.
+	CHECK(!SceneTree::get_singleton());
+
+	SceneTree *tree = memnew(SceneTree);
+	tree->init();
+
+	// Native classes mixed, with some nodes that can be called from the process threads.
+	Vector<Node *> nodes;
+	for (int i = 0; i < 64; i++) {
+		Node *node = (i % 3) ? memnew(Node) : memnew(ThreadedCounter);
+		node->set_process_thread_group(i % 2);
+		node->add_to_group("callees");
+		tree->get_root()->add_child(node);
+		nodes.push_back(node);
+	}
+
+	tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME, "callees", "set_meta", "realtime", 1);
+	tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME | SceneTree::GROUP_CALL_REVERSE, "callees", "set_meta", "reverse", 2);
+	tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME | SceneTree::GROUP_CALL_THREADED, "callees", "set_meta", "threaded", 3);
+	tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME, "callees", "missing_method");
+	tree->call_group("callees", "set_meta", "deferred", 4);
+	bool deferred = !nodes[0]->has_meta("deferred");
+
+	// Threaded calls only use the process threads when processing does.
+	bool threads_followed = true;
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			tree->set_process_threads_allowed(true);
+		}
+		tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME | SceneTree::GROUP_CALL_THREADED, "callees", "notification", Node::NOTIFICATION_PROCESS);
+		for (int i = 0; i < nodes.size(); i++) {
+			ThreadedCounter *counter = Object::cast_to<ThreadedCounter>(nodes[i]);
+			if (counter && counter->get_process_thread_group() != 0) {
+				threads_followed = threads_followed && counter->in_process_thread == tree->are_process_threads_allowed();
+			}
+		}
+	}
+	tree->idle(0);
+
+	bool called = true;
+	for (int i = 0; i < nodes.size(); i++) {
+		Node *node = nodes[i];
+		called = called && int(node->get_meta("realtime", 0)) == 1 && int(node->get_meta("reverse", 0)) == 2;
+		called = called && int(node->get_meta("threaded", 0)) == 3;
+		deferred = deferred && int(node->get_meta("deferred", 0)) == 4;
+		node->remove_from_group("callees");
+	}
+	bool emptied = !tree->has_group("callees");
+
+	tree->finish();
+	memdelete(tree);
+
+	CHECK(called);
+	CHECK(deferred);
+	CHECK(threads_followed);
+	CHECK(emptied);
+	return true;
+}
+
+typedef bool (*TestFunc)();
+TestFunc test_funcs[] = {
+	test_instance_plan,
+	test_instance_async,
+	test_node_pool,
+	test_process_lists,
+	test_process_thread_groups,
+	test_node_lookup,
+	test_budgeted_deletion,
+	test_canvas_transforms,
+	test_signal_emission,
+	test_group_calls,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+} // namespace TestScene
@@ -0,0 +1,16 @@
+/**************************************************************************/
+/*  test_scene.h                                                          */
+/**************************************************************************/
+
+
+#ifndef TEST_SCENE_H
+#define TEST_SCENE_H
+
+#include "core/os/main_loop.h"
+
+namespace TestScene {
+
+MainLoop *test();
+}
+
+#endif // TEST_SCENE_H
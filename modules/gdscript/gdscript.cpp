@@ -12,7 +12,10 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_compiler.h"
+#include "gdscript_preloader.h"
+#include "gdscript_sampling_profiler.h"
 
 ///////////////////////////
 
@@ -53,14 +56,23 @@ Object *GDScriptNativeClass::instance() {
 }
 
 void GDScript::_clear_pending_func_states() {
-	GDScriptLanguage::get_singleton()->lock.lock();
-	while (SelfList<GDScriptFunctionState> *E = pending_func_states.first()) {
+	SpinLock &func_state_lock = GDScriptLanguage::get_singleton()->get_func_state_lock(this);
+	while (true) {
 		// Order matters since clearing the stack may already cause
 		// the GDSCriptFunctionState to be destroyed and thus removed from the list.
-		pending_func_states.remove(E);
+		// The stack is cleared without the lock, as that may free other function states.
+		func_state_lock.lock();
+		SelfList<GDScriptFunctionState> *E = pending_func_states.first();
+		if (E) {
+			pending_func_states.remove(E);
+		}
+		func_state_lock.unlock();
+
+		if (!E) {
+			break;
+		}
 		E->self()->_clear_stack();
 	}
-	GDScriptLanguage::get_singleton()->lock.unlock();
 }
 
 GDScriptInstance *GDScript::_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_isref, Variant::CallError &r_error) {
@@ -739,6 +751,10 @@ Error GDScript::load_byte_code(const String &p_path) {
 	ERR_FAIL_COND_V(bytecode.size() == 0, ERR_PARSE_ERROR);
 	path = p_path;
 
+	return load_tokens(bytecode);
+}
+
+Error GDScript::load_tokens(const Vector<uint8_t> &p_tokens) {
 	String basedir = path;
 
 	if (basedir == "") {
@@ -751,9 +767,9 @@ Error GDScript::load_byte_code(const String &p_path) {
 
 	valid = false;
 	GDScriptParser parser;
-	Error err = parser.parse_bytecode(bytecode, basedir, get_path());
+	Error err = parser.parse_bytecode(p_tokens, basedir, get_path());
 	if (err) {
-		_err_print_error("GDScript::load_byte_code", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), parser.get_error_line(), ("Parse Error: " + parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
+		_err_print_error("GDScript::load_tokens", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), parser.get_error_line(), ("Parse Error: " + parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
 		ERR_FAIL_V(ERR_PARSE_ERROR);
 	}
 
@@ -761,7 +777,7 @@ Error GDScript::load_byte_code(const String &p_path) {
 	err = compiler.compile(&parser, this);
 
 	if (err) {
-		_err_print_error("GDScript::load_byte_code", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), compiler.get_error_line(), ("Compile Error: " + compiler.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
+		_err_print_error("GDScript::load_tokens", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), compiler.get_error_line(), ("Compile Error: " + compiler.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
 		ERR_FAIL_V(ERR_COMPILATION_FAILED);
 	}
 
@@ -938,6 +954,9 @@ GDScript::~GDScript() {
 
 	_save_orphaned_subclasses();
 
+	// Another script may be allocated at the same address.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
 #ifdef DEBUG_ENABLED
 	GDScriptLanguage::get_singleton()->lock.lock();
 	GDScriptLanguage::get_singleton()->script_list.remove(&script_list);
@@ -1292,15 +1311,24 @@ GDScriptInstance::GDScriptInstance() {
 }
 
 GDScriptInstance::~GDScriptInstance() {
-	GDScriptLanguage::singleton->lock.lock();
+	SpinLock &func_state_lock = GDScriptLanguage::singleton->get_func_state_lock(this);
+	while (true) {
+		// Same as GDScript::_clear_pending_func_states().
+		func_state_lock.lock();
+		SelfList<GDScriptFunctionState> *E = pending_func_states.first();
+		if (E) {
+			pending_func_states.remove(E);
+		}
+		func_state_lock.unlock();
 
-	while (SelfList<GDScriptFunctionState> *E = pending_func_states.first()) {
-		// Order matters since clearing the stack may already cause
-		// the GDSCriptFunctionState to be destroyed and thus removed from the list.
-		pending_func_states.remove(E);
+		if (!E) {
+			break;
+		}
 		E->self()->_clear_stack();
 	}
 
+	GDScriptLanguage::singleton->lock.lock();
+
 	if (script.is_valid() && owner) {
 		script->instances.erase(owner);
 	}
@@ -1379,6 +1407,13 @@ void GDScriptLanguage::init() {
 	for (List<Engine::Singleton>::Element *E = singletons.front(); E; E = E->next()) {
 		_add_global(E->get().name, E->get().ptr);
 	}
+
+#ifdef DEBUG_ENABLED
+	if (GLOBAL_GET("debug/gdscript/sampling_profiler/enabled")) {
+		sampling_profiler->set_interval_usec(GLOBAL_GET("debug/gdscript/sampling_profiler/interval_usec"));
+		sampling_profiler->start();
+	}
+#endif
 }
 
 String GDScriptLanguage::get_type() const {
@@ -1392,6 +1427,17 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 	return OK;
 }
 void GDScriptLanguage::finish() {
+	preloader->release();
+
+#ifdef DEBUG_ENABLED
+	if (sampling_profiler->is_active()) {
+		sampling_profiler->stop();
+		String path = GLOBAL_GET("debug/gdscript/sampling_profiler/output_path");
+		if (sampling_profiler->save_report(path + ".txt") == OK && sampling_profiler->save_collapsed_stacks(path + ".folded") == OK) {
+			print_line("GDScript sampling profile saved to: " + path + ".txt (collapsed stacks in " + path + ".folded)");
+		}
+	}
+#endif
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -1409,6 +1455,12 @@ void GDScriptLanguage::profiling_start() {
 		elem->self()->profile.last_frame_call_count = 0;
 		elem->self()->profile.last_frame_self_time = 0;
 		elem->self()->profile.last_frame_total_time = 0;
+		elem->self()->profile.inline_cache_hits = 0;
+		elem->self()->profile.inline_cache_misses = 0;
+		elem->self()->profile.frame_inline_cache_hits = 0;
+		elem->self()->profile.frame_inline_cache_misses = 0;
+		elem->self()->profile.last_frame_inline_cache_hits = 0;
+		elem->self()->profile.last_frame_inline_cache_misses = 0;
 		elem = elem->next();
 	}
 
@@ -1439,6 +1491,8 @@ int GDScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr,
 		p_info_arr[current].self_time = elem->self()->profile.self_time;
 		p_info_arr[current].total_time = elem->self()->profile.total_time;
 		p_info_arr[current].signature = elem->self()->profile.signature;
+		p_info_arr[current].inline_cache_hits = elem->self()->profile.inline_cache_hits;
+		p_info_arr[current].inline_cache_misses = elem->self()->profile.inline_cache_misses;
 		elem = elem->next();
 		current++;
 	}
@@ -1465,6 +1519,8 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_
 			p_info_arr[current].self_time = elem->self()->profile.last_frame_self_time;
 			p_info_arr[current].total_time = elem->self()->profile.last_frame_total_time;
 			p_info_arr[current].signature = elem->self()->profile.signature;
+			p_info_arr[current].inline_cache_hits = elem->self()->profile.last_frame_inline_cache_hits;
+			p_info_arr[current].inline_cache_misses = elem->self()->profile.last_frame_inline_cache_misses;
 			current++;
 		}
 		elem = elem->next();
@@ -1653,7 +1709,14 @@ void GDScriptLanguage::reload_tool_script(const Ref<Script> &p_script, bool p_so
 void GDScriptLanguage::frame() {
 	calls = 0;
 
+	// The autoloads and the main scene hold on to the preloaded scripts they use by now.
+	preloader->release();
+
 #ifdef DEBUG_ENABLED
+	if (sampling_profiler->is_active()) {
+		sampling_profiler->flush();
+	}
+
 	if (profiling) {
 		lock.lock();
 
@@ -1665,6 +1728,10 @@ void GDScriptLanguage::frame() {
 			elem->self()->profile.frame_call_count = 0;
 			elem->self()->profile.frame_self_time = 0;
 			elem->self()->profile.frame_total_time = 0;
+			elem->self()->profile.last_frame_inline_cache_hits = elem->self()->profile.frame_inline_cache_hits;
+			elem->self()->profile.last_frame_inline_cache_misses = elem->self()->profile.frame_inline_cache_misses;
+			elem->self()->profile.frame_inline_cache_hits = 0;
+			elem->self()->profile.frame_inline_cache_misses = 0;
 			elem = elem->next();
 		}
 
@@ -1674,6 +1741,10 @@ void GDScriptLanguage::frame() {
 #endif
 }
 
+void GDScriptLanguage::preload_scripts(const Vector<String> &p_paths) {
+	preloader->preload(p_paths);
+}
+
 /* EDITOR FUNCTIONS */
 void GDScriptLanguage::get_reserved_words(List<String> *p_words) const {
 	static const char *_reserved_words[] = {
@@ -2050,6 +2121,14 @@ GDScriptLanguage::GDScriptLanguage() {
 
 	profiling = false;
 	script_frame_time = 0;
+	// Empty caches have version 0, so they never validate.
+	inline_cache_version.set(1);
+
+	preloader = memnew(GDScriptPreloader);
+
+#ifdef DEBUG_ENABLED
+	sampling_profiler = memnew(GDScriptSamplingProfiler);
+#endif
 
 	_debug_call_stack_pos = 0;
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
@@ -2071,6 +2150,10 @@ GDScriptLanguage::GDScriptLanguage() {
 	GLOBAL_DEF("debug/gdscript/warnings/treat_warnings_as_errors", false);
 	GLOBAL_DEF("debug/gdscript/warnings/exclude_addons", true);
 	GLOBAL_DEF("debug/gdscript/completion/autocomplete_setters_and_getters", false);
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/enabled", false);
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/interval_usec", 1000);
+	ProjectSettings::get_singleton()->set_custom_property_info("debug/gdscript/sampling_profiler/interval_usec", PropertyInfo(Variant::INT, "debug/gdscript/sampling_profiler/interval_usec", PROPERTY_HINT_RANGE, "50,100000,1,or_greater"));
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/output_path", "user://gdscript_profile");
 	for (int i = 0; i < (int)GDScriptWarning::WARNING_MAX; i++) {
 		String warning = GDScriptWarning::get_name_from_code((GDScriptWarning::Code)i).to_lower();
 		bool default_enabled = !warning.begins_with("unsafe_") && i != GDScriptWarning::UNUSED_CLASS_VARIABLE;
@@ -2083,6 +2166,10 @@ GDScriptLanguage::~GDScriptLanguage() {
 	if (_call_stack) {
 		memdelete_arr(_call_stack);
 	}
+	memdelete(preloader);
+#ifdef DEBUG_ENABLED
+	memdelete(sampling_profiler);
+#endif
 
 	// Clear dependencies between scripts, to ensure cyclic references are broken (to avoid leaks at exit).
 	SelfList<GDScript> *s = script_list.first();
@@ -2144,8 +2231,11 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 	if (p_path.ends_with(".gde") || p_path.ends_with(".gdc")) {
 		script->set_script_path(p_original_path); // script needs this.
 		script->set_path(p_original_path, true);
-		Error err = script->load_byte_code(p_path);
-		ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot load byte code from file '" + p_path + "'.");
+		// Encrypted scripts are never cached, the cache would give their code away.
+		if (p_path.ends_with(".gde") || GDScriptBytecodeCache::load_from_file(script, p_path) != OK) {
+			Error err = script->load_byte_code(p_path);
+			ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot load byte code from file '" + p_path + "'.");
+		}
 
 	} else {
 		Error err = script->load_source_code(p_path);
@@ -2154,7 +2244,14 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 		script->set_script_path(p_original_path); // script needs this.
 		script->set_path(p_original_path, true);
 
-		script->reload();
+		if (GDScriptBytecodeCache::load_from_file(script, p_path) != OK) {
+			Vector<uint8_t> tokens;
+			if (GDScriptLanguage::get_singleton()->get_preloader()->take_tokens(p_path, tokens)) {
+				script->load_tokens(tokens);
+			} else {
+				script->reload();
+			}
+		}
 	}
 	if (r_error) {
 		*r_error = OK;
@@ -8,9 +8,13 @@
 
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
+#include "core/safe_refcount.h"
 #include "core/script_language.h"
 #include "gdscript_function.h"
 
+class GDScriptPreloader;
+class GDScriptSamplingProfiler;
+
 class GDScriptNativeClass : public Reference {
 	GDCLASS(GDScriptNativeClass, Reference);
 
@@ -42,6 +46,7 @@ class GDScript : public Script {
 	friend class GDScriptInstance;
 	friend class GDScriptFunction;
 	friend class GDScriptCompiler;
+	friend class GDScriptBytecodeCache;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
 
@@ -165,6 +170,7 @@ public:
 	void set_script_path(const String &p_path) { path = p_path; } //because subclasses need a path too...
 	Error load_source_code(const String &p_path);
 	Error load_byte_code(const String &p_path);
+	Error load_tokens(const Vector<uint8_t> &p_tokens);
 
 	Vector<uint8_t> get_as_byte_code() const;
 
@@ -329,14 +335,34 @@ class GDScriptLanguage : public ScriptLanguage {
 	friend class GDScriptFunction;
 
 	SelfList<GDScriptFunction>::List function_list;
+	friend class GDScriptSamplingProfiler;
 	bool profiling;
 	uint64_t script_frame_time;
 
+	SafeNumeric<uint32_t> inline_cache_version;
+
 	Map<String, ObjectID> orphan_subclasses;
 
+	GDScriptPreloader *preloader;
+#ifdef DEBUG_ENABLED
+	GDScriptSamplingProfiler *sampling_profiler;
+#endif
+
+	// Guard the lists of function states waiting on each script and instance. The lock is picked
+	// from the address of the owner of the list, so yields in unrelated scripts don't contend.
+	enum {
+		FUNC_STATE_LOCK_COUNT = 64,
+	};
+	SpinLock func_state_locks[FUNC_STATE_LOCK_COUNT];
+
 public:
 	int calls;
 
+	// Inline caches remember resolved functions and member indices, which become stale whenever
+	// a script is compiled or freed. Bumping the version discards all of them at once.
+	_FORCE_INLINE_ void invalidate_inline_caches() { inline_cache_version.increment(); }
+	_FORCE_INLINE_ uint32_t get_inline_cache_version() const { return inline_cache_version.get(); }
+
 	bool debug_break(const String &p_error, bool p_allow_continue = true);
 	bool debug_break_parse(const String &p_file, int p_line, const String &p_error);
 
@@ -415,6 +441,11 @@ public:
 	_FORCE_INLINE_ const Map<StringName, Variant> &get_named_globals_map() const { return named_globals; }
 
 	_FORCE_INLINE_ static GDScriptLanguage *get_singleton() { return singleton; }
+	_FORCE_INLINE_ GDScriptPreloader *get_preloader() const { return preloader; }
+#ifdef DEBUG_ENABLED
+	_FORCE_INLINE_ GDScriptSamplingProfiler *get_sampling_profiler() const { return sampling_profiler; }
+#endif
+	_FORCE_INLINE_ SpinLock &get_func_state_lock(const void *p_owner) { return func_state_locks[((uintptr_t)p_owner >> 4) & (FUNC_STATE_LOCK_COUNT - 1)]; }
 
 	virtual String get_name() const;
 
@@ -481,6 +512,7 @@ public:
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
+	virtual void preload_scripts(const Vector<String> &p_paths);
 
 	/* GLOBAL CLASSES */
 
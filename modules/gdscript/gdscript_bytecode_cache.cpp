@@ -0,0 +1,1008 @@
+/**************************************************************************/
+/*  gdscript_bytecode_cache.cpp                                           */
+/**************************************************************************/
+
+
+#include "gdscript_bytecode_cache.h"
+
+#include "core/engine.h"
+#include "core/global_constants.h"
+#include "core/io/marshalls.h"
+#include "core/os/file_access.h"
+#include "gdscript_compiler.h"
+#include "gdscript_functions.h"
+#include "gdscript_parser.h"
+
+/*
+ * File layout, all integers little endian:
+ *
+ * "GDBC", format version, engine hash (64 bits), debug flag (8 bits),
+ * source size, source hash, payload size, payload hash, payload.
+ *
+ * The payload is the tree of inner classes (names only, so every class exists before any
+ * of them references another) followed by the body of each class in the same order.
+ */
+
+#define CACHE_HEADER_SIZE 33
+
+enum {
+	CONSTANT_VARIANT,
+	CONSTANT_NULL_OBJECT,
+	CONSTANT_SCRIPT,
+	CONSTANT_RESOURCE,
+	CONSTANT_NATIVE_CLASS,
+	CONSTANT_ARRAY,
+	CONSTANT_DICTIONARY,
+};
+
+struct GDScriptBytecodeCache::Writer {
+	Vector<uint8_t> data;
+
+	void put_u8(uint8_t p_value) {
+		data.push_back(p_value);
+	}
+
+	void put_u32(uint32_t p_value) {
+		int pos = data.size();
+		data.resize(pos + 4);
+		encode_uint32(p_value, &data.write[pos]);
+	}
+
+	void put_string(const String &p_string) {
+		CharString utf8 = p_string.utf8();
+		put_u32(utf8.length());
+		int pos = data.size();
+		data.resize(pos + utf8.length());
+		memcpy(&data.write[pos], utf8.get_data(), utf8.length());
+	}
+
+	Error put_variant(const Variant &p_value) {
+		int len;
+		Error err = encode_variant(p_value, nullptr, len);
+		ERR_FAIL_COND_V(err != OK, err);
+		put_u32(len);
+		int pos = data.size();
+		data.resize(pos + len);
+		return encode_variant(p_value, &data.write[pos], len);
+	}
+};
+
+// Reading past the end sets the error flag and returns zeros, callers check it once per section.
+struct GDScriptBytecodeCache::Reader {
+	const uint8_t *data;
+	int size;
+	int pos;
+	bool error;
+
+	bool has(int p_bytes) {
+		if (p_bytes < 0 || pos + p_bytes > size) {
+			error = true;
+			return false;
+		}
+		return true;
+	}
+
+	uint8_t get_u8() {
+		if (!has(1)) {
+			return 0;
+		}
+		return data[pos++];
+	}
+
+	uint32_t get_u32() {
+		if (!has(4)) {
+			return 0;
+		}
+		uint32_t value = decode_uint32(&data[pos]);
+		pos += 4;
+		return value;
+	}
+
+	// Element counts, every element takes at least one byte.
+	int get_count() {
+		uint32_t count = get_u32();
+		if (count > uint32_t(size - pos)) {
+			error = true;
+			return 0;
+		}
+		return count;
+	}
+
+	String get_string() {
+		int len = get_count();
+		String string;
+		if (len) {
+			string.parse_utf8((const char *)&data[pos], len);
+			pos += len;
+		}
+		return string;
+	}
+
+	Error get_variant(Variant &r_value) {
+		int len = get_count();
+		if (error) {
+			return ERR_FILE_CORRUPT;
+		}
+		Error err = decode_variant(r_value, &data[pos], len);
+		pos += len;
+		return err;
+	}
+
+	Reader(const uint8_t *p_data, int p_size) :
+			data(p_data),
+			size(p_size),
+			pos(0),
+			error(false) {}
+};
+
+/*************** SAVE ***************/
+
+// Scripts are stored as the file they come from plus the path of inner class names inside it,
+// an empty file stands for the script being saved (which has no path yet when exporting).
+Error GDScriptBytecodeCache::_save_script_ref(Writer &p_writer, const Script *p_script, const GDScript *p_main) {
+	ERR_FAIL_NULL_V(p_script, ERR_INVALID_DATA);
+
+	List<StringName> names;
+	const Script *root = p_script;
+	const GDScript *gds = Object::cast_to<GDScript>(p_script);
+	while (gds && gds->_owner) {
+		names.push_front(gds->name);
+		gds = gds->_owner;
+		root = gds;
+	}
+
+	if (root == p_main) {
+		p_writer.put_string(String());
+	} else {
+		String path = root->get_path();
+		ERR_FAIL_COND_V_MSG(!path.is_resource_file(), ERR_INVALID_DATA, "Can't reference a built-in script in a bytecode cache.");
+		p_writer.put_string(path);
+	}
+
+	p_writer.put_u32(names.size());
+	for (List<StringName>::Element *E = names.front(); E; E = E->next()) {
+		p_writer.put_string(E->get());
+	}
+	return OK;
+}
+
+Error GDScriptBytecodeCache::_save_constant(Writer &p_writer, const Variant &p_value, const GDScript *p_main) {
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			Object *obj = p_value;
+			if (!obj) {
+				p_writer.put_u8(CONSTANT_NULL_OBJECT);
+				return OK;
+			}
+
+			Script *script = Object::cast_to<Script>(obj);
+			if (script) {
+				p_writer.put_u8(CONSTANT_SCRIPT);
+				return _save_script_ref(p_writer, script, p_main);
+			}
+
+			Resource *res = Object::cast_to<Resource>(obj);
+			if (res) {
+				ERR_FAIL_COND_V_MSG(!res->get_path().is_resource_file(), ERR_INVALID_DATA, "Can't reference a built-in resource in a bytecode cache.");
+				p_writer.put_u8(CONSTANT_RESOURCE);
+				p_writer.put_string(res->get_path());
+				return OK;
+			}
+
+			GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(obj);
+			if (native) {
+				p_writer.put_u8(CONSTANT_NATIVE_CLASS);
+				p_writer.put_string(native->get_name());
+				return OK;
+			}
+
+			ERR_FAIL_V_MSG(ERR_INVALID_DATA, "Can't store a constant of type '" + obj->get_class() + "' in a bytecode cache.");
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_value;
+			p_writer.put_u8(CONSTANT_ARRAY);
+			p_writer.put_u32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				Error err = _save_constant(p_writer, array[i], p_main);
+				ERR_FAIL_COND_V(err != OK, err);
+			}
+			return OK;
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dict = p_value;
+			List<Variant> keys;
+			dict.get_key_list(&keys);
+			p_writer.put_u8(CONSTANT_DICTIONARY);
+			p_writer.put_u32(keys.size());
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				Error err = _save_constant(p_writer, E->get(), p_main);
+				ERR_FAIL_COND_V(err != OK, err);
+				err = _save_constant(p_writer, dict[E->get()], p_main);
+				ERR_FAIL_COND_V(err != OK, err);
+			}
+			return OK;
+		} break;
+		default: {
+			p_writer.put_u8(CONSTANT_VARIANT);
+			return p_writer.put_variant(p_value);
+		} break;
+	}
+
+	return ERR_BUG;
+}
+
+Error GDScriptBytecodeCache::_save_data_type(Writer &p_writer, const GDScriptDataType &p_type, const GDScript *p_main) {
+	p_writer.put_u8(p_type.has_type);
+	if (!p_type.has_type) {
+		return OK;
+	}
+
+	p_writer.put_u8(p_type.kind);
+	p_writer.put_u32(p_type.builtin_type);
+	p_writer.put_string(p_type.native_type);
+	if (p_type.kind == GDScriptDataType::SCRIPT || p_type.kind == GDScriptDataType::GDSCRIPT) {
+		return _save_script_ref(p_writer, p_type.script_type, p_main);
+	}
+	return OK;
+}
+
+Error GDScriptBytecodeCache::_save_function(Writer &p_writer, const GDScriptFunction *p_function, const GDScript *p_main) {
+	p_writer.put_string(p_function->name);
+	p_writer.put_u8(p_function->_static);
+	p_writer.put_u32(p_function->_argument_count);
+	p_writer.put_u32(p_function->_stack_size);
+	p_writer.put_u32(p_function->_call_size);
+	p_writer.put_u32(p_function->_initial_line);
+	p_writer.put_u32(p_function->_inline_cache_count);
+
+	Error err;
+
+	p_writer.put_u32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		err = _save_data_type(p_writer, p_function->argument_types[i], p_main);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+	err = _save_data_type(p_writer, p_function->return_type, p_main);
+	ERR_FAIL_COND_V(err != OK, err);
+
+#ifdef TOOLS_ENABLED
+	p_writer.put_u32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		p_writer.put_string(p_function->arg_names[i]);
+	}
+#else
+	p_writer.put_u32(0);
+#endif
+
+	p_writer.put_u32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		err = _save_constant(p_writer, p_function->constants[i], p_main);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	p_writer.put_u32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		p_writer.put_string(p_function->global_names[i]);
+	}
+
+	p_writer.put_u32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		p_writer.put_u32(p_function->default_arguments[i]);
+	}
+
+	p_writer.put_u32(p_function->code.size());
+	for (int i = 0; i < p_function->code.size(); i++) {
+		p_writer.put_u32(p_function->code[i]);
+	}
+
+	// The global array is laid out differently by every build (and autoloads are named globals
+	// in the editor), so addresses of globals are saved by name and resolved again when loading.
+	// Only the operands the VM reads as addresses are looked at.
+	LocalVector<int> addresses;
+	ERR_FAIL_COND_V_MSG(!p_function->get_address_operands(addresses), ERR_BUG, "Can't decode the code of function '" + String(p_function->name) + "'.");
+
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	Map<int, StringName> global_names;
+	for (const Map<StringName, int>::Element *E = global_map.front(); E; E = E->next()) {
+		global_names[E->get()] = E->key();
+	}
+
+	List<Pair<int, StringName>> relocations;
+	for (uint32_t i = 0; i < addresses.size(); i++) {
+		uint32_t word = p_function->code[addresses[i]];
+		uint32_t address = word & GDScriptFunction::ADDR_MASK;
+		switch (word >> GDScriptFunction::ADDR_BITS) {
+			case GDScriptFunction::ADDR_TYPE_GLOBAL: {
+				ERR_FAIL_COND_V(!global_names.has(address), ERR_BUG);
+				relocations.push_back(Pair<int, StringName>(addresses[i], global_names[address]));
+			} break;
+			case GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL: {
+#ifdef TOOLS_ENABLED
+				ERR_FAIL_COND_V(address >= (uint32_t)p_function->named_globals.size(), ERR_BUG);
+				relocations.push_back(Pair<int, StringName>(addresses[i], p_function->named_globals[address]));
+#else
+				ERR_FAIL_V(ERR_BUG);
+#endif
+			} break;
+		}
+	}
+
+	p_writer.put_u32(relocations.size());
+	for (List<Pair<int, StringName>>::Element *E = relocations.front(); E; E = E->next()) {
+		p_writer.put_u32(E->get().first);
+		p_writer.put_string(E->get().second);
+	}
+
+	p_writer.put_u32(p_function->stack_debug.size());
+	for (const List<GDScriptFunction::StackDebug>::Element *E = p_function->stack_debug.front(); E; E = E->next()) {
+		p_writer.put_u32(E->get().line);
+		p_writer.put_u32(E->get().pos);
+		p_writer.put_u8(E->get().added);
+		p_writer.put_string(E->get().identifier);
+	}
+
+	return OK;
+}
+
+void GDScriptBytecodeCache::_save_class_tree(Writer &p_writer, const GDScript *p_script, List<const GDScript *> &r_classes) {
+	r_classes.push_back(p_script);
+	p_writer.put_u32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		p_writer.put_string(E->key());
+		_save_class_tree(p_writer, E->get().ptr(), r_classes);
+	}
+}
+
+Error GDScriptBytecodeCache::_save_class(Writer &p_writer, const GDScript *p_script, const GDScript *p_main) {
+	Error err;
+
+	p_writer.put_u8(p_script->tool);
+	p_writer.put_string(p_script->name);
+
+	if (p_script->native.is_valid()) {
+		p_writer.put_u8(0);
+		p_writer.put_string(p_script->native->get_name());
+	} else {
+		ERR_FAIL_COND_V(p_script->base.is_null(), ERR_INVALID_DATA);
+		p_writer.put_u8(1);
+		err = _save_script_ref(p_writer, p_script->base.ptr(), p_main);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	p_writer.put_u32(p_script->members.size());
+	for (const Set<StringName>::Element *E = p_script->members.front(); E; E = E->next()) {
+		p_writer.put_string(E->get());
+	}
+
+	p_writer.put_u32(p_script->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.front(); E; E = E->next()) {
+		p_writer.put_string(E->key());
+		p_writer.put_u32(E->get().index);
+		p_writer.put_string(E->get().setter);
+		p_writer.put_string(E->get().getter);
+		err = _save_data_type(p_writer, E->get().data_type, p_main);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	p_writer.put_u32(p_script->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_script->member_info.front(); E; E = E->next()) {
+		const PropertyInfo &pi = E->get();
+		p_writer.put_string(E->key());
+		p_writer.put_u32(pi.type);
+		p_writer.put_string(pi.name);
+		p_writer.put_string(pi.class_name);
+		p_writer.put_u32(pi.hint);
+		p_writer.put_string(pi.hint_string);
+		p_writer.put_u32(pi.usage);
+	}
+
+	p_writer.put_u32(p_script->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+		p_writer.put_string(E->key());
+		err = _save_constant(p_writer, E->get(), p_main);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	p_writer.put_u32(p_script->_signals.size());
+	for (const Map<StringName, Vector<StringName>>::Element *E = p_script->_signals.front(); E; E = E->next()) {
+		p_writer.put_string(E->key());
+		p_writer.put_u32(E->get().size());
+		for (int i = 0; i < E->get().size(); i++) {
+			p_writer.put_string(E->get()[i]);
+		}
+	}
+
+	p_writer.put_u32(p_script->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		err = _save_function(p_writer, E->get(), p_main);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	return OK;
+}
+
+String GDScriptBytecodeCache::get_cache_path(const String &p_source_path) {
+	return p_source_path.get_basename() + ".gdbc";
+}
+
+static uint64_t _compute_engine_hash() {
+	// Integer constants of native classes are folded into the code.
+	uint64_t hash = ClassDB::get_api_constants_hash(ClassDB::API_CORE);
+
+	hash = hash_djb2_one_64(GDScriptBytecodeCache::FORMAT_VERSION, hash);
+	hash = hash_djb2_one_64(GDScriptFunction::OPCODE_END, hash);
+	hash = hash_djb2_one_64(Variant::VARIANT_MAX, hash);
+	hash = hash_djb2_one_64(Variant::OP_MAX, hash);
+	for (int i = 0; i < GDScriptFunctions::FUNC_MAX; i++) {
+		hash = hash_djb2_one_64(String(GDScriptFunctions::get_func_name(GDScriptFunctions::Function(i))).hash(), hash);
+	}
+	for (int i = 0; i < GlobalConstants::get_global_constant_count(); i++) {
+		hash = hash_djb2_one_64(String(GlobalConstants::get_global_constant_name(i)).hash(), hash);
+		hash = hash_djb2_one_64(GlobalConstants::get_global_constant_value(i), hash);
+	}
+
+	return hash;
+}
+
+uint64_t GDScriptBytecodeCache::get_engine_hash() {
+	static uint64_t hash = _compute_engine_hash();
+	return hash;
+}
+
+Error GDScriptBytecodeCache::save(const Ref<GDScript> &p_script, const Vector<uint8_t> &p_source, bool p_debug, Vector<uint8_t> &r_cache) {
+	ERR_FAIL_COND_V(p_script.is_null() || !p_script->valid, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(p_script->_owner, ERR_INVALID_PARAMETER, "Only the main class of a script can be saved.");
+
+	Writer payload;
+	List<const GDScript *> classes;
+	_save_class_tree(payload, p_script.ptr(), classes);
+	for (List<const GDScript *>::Element *E = classes.front(); E; E = E->next()) {
+		Error err = _save_class(payload, E->get(), p_script.ptr());
+		if (err != OK) {
+			return err;
+		}
+	}
+
+	Writer header;
+	header.put_u8('G');
+	header.put_u8('D');
+	header.put_u8('B');
+	header.put_u8('C');
+	header.put_u32(FORMAT_VERSION);
+	header.put_u32(get_engine_hash() & 0xFFFFFFFF);
+	header.put_u32(get_engine_hash() >> 32);
+	header.put_u8(p_debug);
+	header.put_u32(p_source.size());
+	header.put_u32(hash_djb2_buffer(p_source.ptr(), p_source.size()));
+	header.put_u32(payload.data.size());
+	header.put_u32(hash_djb2_buffer(payload.data.ptr(), payload.data.size()));
+	ERR_FAIL_COND_V(header.data.size() != CACHE_HEADER_SIZE, ERR_BUG);
+
+	r_cache = header.data;
+	r_cache.append_array(payload.data);
+	return OK;
+}
+
+Error GDScriptBytecodeCache::compile(const String &p_path, const String &p_source_code, const Vector<uint8_t> &p_source, bool p_debug, Vector<uint8_t> &r_cache) {
+#ifndef DEBUG_ENABLED
+	ERR_FAIL_COND_V_MSG(p_debug, ERR_UNAVAILABLE, "Debug code can only be compiled by debug builds.");
+#endif
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_script_path(p_path);
+	script->source = p_source_code;
+
+	GDScriptParser parser;
+	Error err = parser.parse(p_source_code, p_path.get_base_dir(), false, p_path);
+	if (err != OK) {
+		return ERR_PARSE_ERROR;
+	}
+
+	GDScriptCompiler compiler;
+	compiler.set_strip_debug(!p_debug);
+	compiler.set_debug_stack(p_debug);
+	err = compiler.compile(&parser, script.ptr());
+	if (err != OK) {
+		return ERR_COMPILATION_FAILED;
+	}
+
+	return save(script, p_source, p_debug, r_cache);
+}
+
+/*************** LOAD ***************/
+
+Error GDScriptBytecodeCache::_load_script_ref(Reader &p_reader, GDScript *p_main, Ref<Script> &r_script) {
+	String path = p_reader.get_string();
+	if (path.empty()) {
+		r_script = Ref<Script>(p_main);
+	} else {
+		r_script = ResourceLoader::load(path);
+		ERR_FAIL_COND_V_MSG(r_script.is_null(), ERR_FILE_MISSING_DEPENDENCIES, "Can't load script '" + path + "' referenced by a bytecode cache.");
+	}
+
+	int count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = p_reader.get_string();
+		Ref<GDScript> gds = r_script;
+		ERR_FAIL_COND_V(gds.is_null() || !gds->subclasses.has(name), ERR_FILE_MISSING_DEPENDENCIES);
+		r_script = gds->subclasses[name];
+	}
+
+	return p_reader.error ? ERR_FILE_CORRUPT : OK;
+}
+
+Error GDScriptBytecodeCache::_load_constant(Reader &p_reader, GDScript *p_main, Variant &r_value) {
+	switch (p_reader.get_u8()) {
+		case CONSTANT_VARIANT: {
+			return p_reader.get_variant(r_value);
+		} break;
+		case CONSTANT_NULL_OBJECT: {
+			r_value = (Object *)nullptr;
+			return OK;
+		} break;
+		case CONSTANT_SCRIPT: {
+			Ref<Script> script;
+			Error err = _load_script_ref(p_reader, p_main, script);
+			r_value = script;
+			return err;
+		} break;
+		case CONSTANT_RESOURCE: {
+			String path = p_reader.get_string();
+			RES res = ResourceLoader::load(path);
+			ERR_FAIL_COND_V_MSG(res.is_null(), ERR_FILE_MISSING_DEPENDENCIES, "Can't load resource '" + path + "' referenced by a bytecode cache.");
+			r_value = res;
+			return OK;
+		} break;
+		case CONSTANT_NATIVE_CLASS: {
+			StringName name = p_reader.get_string();
+			const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+			ERR_FAIL_COND_V(!global_map.has(name), ERR_FILE_MISSING_DEPENDENCIES);
+			r_value = GDScriptLanguage::get_singleton()->get_global_array()[global_map[name]];
+			return OK;
+		} break;
+		case CONSTANT_ARRAY: {
+			int count = p_reader.get_count();
+			Array array;
+			array.resize(count);
+			for (int i = 0; i < count; i++) {
+				Error err = _load_constant(p_reader, p_main, array[i]);
+				ERR_FAIL_COND_V(err != OK, err);
+			}
+			r_value = array;
+			return OK;
+		} break;
+		case CONSTANT_DICTIONARY: {
+			int count = p_reader.get_count();
+			Dictionary dict;
+			for (int i = 0; i < count; i++) {
+				Variant key;
+				Variant value;
+				Error err = _load_constant(p_reader, p_main, key);
+				ERR_FAIL_COND_V(err != OK, err);
+				err = _load_constant(p_reader, p_main, value);
+				ERR_FAIL_COND_V(err != OK, err);
+				dict[key] = value;
+			}
+			r_value = dict;
+			return OK;
+		} break;
+	}
+
+	ERR_FAIL_V(ERR_FILE_CORRUPT);
+}
+
+Error GDScriptBytecodeCache::_load_data_type(Reader &p_reader, GDScript *p_main, const GDScript *p_owner, GDScriptDataType &r_type) {
+	r_type = GDScriptDataType();
+	r_type.has_type = p_reader.get_u8();
+	if (!r_type.has_type) {
+		return OK;
+	}
+
+	uint8_t kind = p_reader.get_u8();
+	uint32_t builtin_type = p_reader.get_u32();
+	ERR_FAIL_COND_V(kind > GDScriptDataType::GDSCRIPT || builtin_type >= Variant::VARIANT_MAX, ERR_FILE_CORRUPT);
+	r_type.builtin_type = Variant::Type(builtin_type);
+	r_type.native_type = p_reader.get_string();
+
+	switch (kind) {
+		case GDScriptDataType::BUILTIN: {
+			r_type.kind = GDScriptDataType::BUILTIN;
+		} break;
+		case GDScriptDataType::NATIVE: {
+			r_type.kind = GDScriptDataType::NATIVE;
+		} break;
+		case GDScriptDataType::SCRIPT:
+		case GDScriptDataType::GDSCRIPT: {
+			r_type.kind = kind == GDScriptDataType::SCRIPT ? GDScriptDataType::SCRIPT : GDScriptDataType::GDSCRIPT;
+			Error err = _load_script_ref(p_reader, p_main, r_type.script_type_ref);
+			ERR_FAIL_COND_V(err != OK, err);
+			r_type.script_type = r_type.script_type_ref.ptr();
+			// Same as the compiler, the owner of the typed element isn't referenced to avoid cycles.
+			if (r_type.script_type == p_owner) {
+				r_type.script_type_ref = Ref<Script>();
+			}
+		} break;
+		default: {
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		} break;
+	}
+
+	return p_reader.error ? ERR_FILE_CORRUPT : OK;
+}
+
+Error GDScriptBytecodeCache::_load_function(Reader &p_reader, GDScript *p_main, GDScript *p_script, GDScriptFunction *p_function) {
+	Error err;
+
+	p_function->name = p_reader.get_string();
+	p_function->_static = p_reader.get_u8();
+	p_function->_argument_count = p_reader.get_u32();
+	p_function->_stack_size = p_reader.get_u32();
+	p_function->_call_size = p_reader.get_u32();
+	p_function->_initial_line = p_reader.get_u32();
+	int inline_cache_count = p_reader.get_u32();
+	ERR_FAIL_COND_V(p_reader.error || p_function->_argument_count < 0 || p_function->_stack_size < p_function->_argument_count || p_function->_call_size < 0 || inline_cache_count < 0, ERR_FILE_CORRUPT);
+
+	p_function->argument_types.resize(p_reader.get_count());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		err = _load_data_type(p_reader, p_main, p_script, p_function->argument_types.write[i]);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+	err = _load_data_type(p_reader, p_main, p_script, p_function->return_type);
+	ERR_FAIL_COND_V(err != OK, err);
+
+	int arg_name_count = p_reader.get_count();
+	for (int i = 0; i < arg_name_count; i++) {
+		StringName arg_name = p_reader.get_string();
+#ifdef TOOLS_ENABLED
+		p_function->arg_names.push_back(arg_name);
+#endif
+	}
+
+	p_function->constants.resize(p_reader.get_count());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		err = _load_constant(p_reader, p_main, p_function->constants.write[i]);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+	p_function->_constant_count = p_function->constants.size();
+	p_function->_constants_ptr = p_function->_constant_count ? p_function->constants.ptrw() : nullptr;
+
+	p_function->global_names.resize(p_reader.get_count());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		p_function->global_names.write[i] = p_reader.get_string();
+	}
+	p_function->_global_names_count = p_function->global_names.size();
+	p_function->_global_names_ptr = p_function->_global_names_count ? p_function->global_names.ptr() : nullptr;
+
+	p_function->default_arguments.resize(p_reader.get_count());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		p_function->default_arguments.write[i] = p_reader.get_u32();
+	}
+	p_function->_default_arg_count = MAX(p_function->default_arguments.size() - 1, 0);
+	p_function->_default_arg_ptr = p_function->default_arguments.size() ? p_function->default_arguments.ptr() : nullptr;
+
+	p_function->code.resize(p_reader.get_count());
+	for (int i = 0; i < p_function->code.size(); i++) {
+		p_function->code.write[i] = p_reader.get_u32();
+	}
+
+	int relocation_count = p_reader.get_count();
+	for (int i = 0; i < relocation_count; i++) {
+		int pos = p_reader.get_u32();
+		StringName name = p_reader.get_string();
+		ERR_FAIL_INDEX_V(pos, p_function->code.size(), ERR_FILE_CORRUPT);
+
+		const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+		if (global_map.has(name)) {
+			p_function->code.write[pos] = global_map[name] | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+			continue;
+		}
+#ifdef TOOLS_ENABLED
+		if (GDScriptLanguage::get_singleton()->get_named_globals_map().has(name)) {
+			int idx = p_function->named_globals.find(name);
+			if (idx == -1) {
+				idx = p_function->named_globals.size();
+				p_function->named_globals.push_back(name);
+			}
+			p_function->code.write[pos] = idx | (GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL << GDScriptFunction::ADDR_BITS);
+			continue;
+		}
+#endif
+		print_verbose("GDScript bytecode cache: identifier not found: " + String(name) + ".");
+		return ERR_FILE_MISSING_DEPENDENCIES;
+	}
+
+#ifdef TOOLS_ENABLED
+	p_function->_named_globals_count = p_function->named_globals.size();
+	p_function->_named_globals_ptr = p_function->_named_globals_count ? p_function->named_globals.ptr() : nullptr;
+#endif
+
+	p_function->_code_size = p_function->code.size();
+	p_function->_code_ptr = p_function->_code_size ? p_function->code.ptr() : nullptr;
+
+	int stack_debug_count = p_reader.get_count();
+	for (int i = 0; i < stack_debug_count; i++) {
+		GDScriptFunction::StackDebug sd;
+		sd.line = p_reader.get_u32();
+		sd.pos = p_reader.get_u32();
+		sd.added = p_reader.get_u8();
+		sd.identifier = p_reader.get_string();
+		// Only kept when it would be generated by compiling the script.
+		if (ScriptDebugger::get_singleton()) {
+			p_function->stack_debug.push_back(sd);
+		}
+	}
+
+	ERR_FAIL_COND_V(p_reader.error, ERR_FILE_CORRUPT);
+
+	if (inline_cache_count) {
+		p_function->inline_caches.resize(inline_cache_count);
+		p_function->_inline_caches_ptr = p_function->inline_caches.ptrw();
+		p_function->_inline_cache_count = inline_cache_count;
+	}
+
+	p_function->_script = p_script;
+	p_function->source = p_main->get_path();
+
+#ifdef DEBUG_ENABLED
+	if (ScriptDebugger::get_singleton()) {
+		String signature = p_main->get_path() + "::" + itos(p_function->_initial_line);
+		if (p_script->name != StringName()) {
+			signature += "::" + String(p_script->name) + "." + String(p_function->name);
+		} else {
+			signature += "::" + String(p_function->name);
+		}
+		p_function->profile.signature = signature;
+	}
+
+	p_function->func_cname = (String(p_function->source) + " - " + String(p_function->name)).utf8();
+	p_function->_func_cname = p_function->func_cname.get_data();
+#endif
+
+	return OK;
+}
+
+Error GDScriptBytecodeCache::_load_class_tree(Reader &p_reader, GDScript *p_script, List<GDScript *> &r_classes) {
+	r_classes.push_back(p_script);
+
+	int count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = p_reader.get_string();
+		ERR_FAIL_COND_V(p_reader.error || p_script->subclasses.has(name), ERR_FILE_CORRUPT);
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+		subclass->_owner = p_script;
+		subclass->fully_qualified_name = p_script->fully_qualified_name + "::" + name;
+		p_script->subclasses.insert(name, subclass);
+
+		Error err = _load_class_tree(p_reader, subclass.ptr(), r_classes);
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	return OK;
+}
+
+Error GDScriptBytecodeCache::_load_class(Reader &p_reader, GDScript *p_main, GDScript *p_script) {
+	Error err;
+
+	p_script->tool = p_reader.get_u8();
+	p_script->name = p_reader.get_string();
+
+	if (p_reader.get_u8() == 0) {
+		StringName native_name = p_reader.get_string();
+		const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+		ERR_FAIL_COND_V(!global_map.has(native_name), ERR_FILE_MISSING_DEPENDENCIES);
+		p_script->native = GDScriptLanguage::get_singleton()->get_global_array()[global_map[native_name]];
+		ERR_FAIL_COND_V(p_script->native.is_null(), ERR_FILE_MISSING_DEPENDENCIES);
+	} else {
+		Ref<Script> base;
+		err = _load_script_ref(p_reader, p_main, base);
+		ERR_FAIL_COND_V(err != OK, err);
+		p_script->base = base;
+		ERR_FAIL_COND_V(p_script->base.is_null(), ERR_FILE_CORRUPT);
+		p_script->_base = p_script->base.ptr();
+	}
+
+	int count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		p_script->members.insert(p_reader.get_string());
+	}
+
+	count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = p_reader.get_string();
+		GDScript::MemberInfo minfo;
+		minfo.index = p_reader.get_u32();
+		minfo.setter = p_reader.get_string();
+		minfo.getter = p_reader.get_string();
+		err = _load_data_type(p_reader, p_main, p_script, minfo.data_type);
+		ERR_FAIL_COND_V(err != OK, err);
+		p_script->member_indices[name] = minfo;
+	}
+
+	// Inherited members come first, the cache is stale if the base script in another file changed since.
+	const GDScript *base = p_script->_base;
+	const GDScript *base_root = base;
+	while (base_root && base_root->_owner) {
+		base_root = base_root->_owner;
+	}
+	if (base && base_root != p_main) {
+		bool same_layout = base->member_indices.size() + p_script->members.size() == p_script->member_indices.size();
+		for (const Map<StringName, GDScript::MemberInfo>::Element *E = base->member_indices.front(); E && same_layout; E = E->next()) {
+			const Map<StringName, GDScript::MemberInfo>::Element *F = p_script->member_indices.find(E->key());
+			same_layout = F && F->get().index == E->get().index;
+		}
+		if (!same_layout) {
+			print_verbose("GDScript bytecode cache: members of base script '" + base->get_path() + "' changed.");
+			return ERR_FILE_MISSING_DEPENDENCIES;
+		}
+	}
+
+	count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = p_reader.get_string();
+		PropertyInfo pi;
+		pi.type = Variant::Type(p_reader.get_u32());
+		pi.name = p_reader.get_string();
+		pi.class_name = p_reader.get_string();
+		pi.hint = PropertyHint(p_reader.get_u32());
+		pi.hint_string = p_reader.get_string();
+		pi.usage = p_reader.get_u32();
+		ERR_FAIL_COND_V(pi.type >= Variant::VARIANT_MAX, ERR_FILE_CORRUPT);
+		p_script->member_info[name] = pi;
+	}
+
+	count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = p_reader.get_string();
+		Variant value;
+		err = _load_constant(p_reader, p_main, value);
+		ERR_FAIL_COND_V(err != OK, err);
+		p_script->constants[name] = value;
+	}
+
+	count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		StringName name = p_reader.get_string();
+		Vector<StringName> &arguments = p_script->_signals[name];
+		arguments.resize(p_reader.get_count());
+		for (int j = 0; j < arguments.size(); j++) {
+			arguments.write[j] = p_reader.get_string();
+		}
+	}
+
+	count = p_reader.get_count();
+	for (int i = 0; i < count; i++) {
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		err = _load_function(p_reader, p_main, p_script, function);
+		if (err != OK || p_script->member_functions.has(function->name)) {
+			memdelete(function);
+			ERR_FAIL_COND_V(err == OK, ERR_FILE_CORRUPT);
+			return err;
+		}
+		p_script->member_functions[function->name] = function;
+	}
+
+	ERR_FAIL_COND_V(!p_script->member_functions.has("_init"), ERR_FILE_CORRUPT);
+	p_script->initializer = p_script->member_functions["_init"];
+
+	return p_reader.error ? ERR_FILE_CORRUPT : OK;
+}
+
+void GDScriptBytecodeCache::_clear_class(GDScript *p_script) {
+	for (Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		_clear_class(E->get().ptr());
+		E->get()->_owner = nullptr;
+	}
+	p_script->subclasses.clear();
+
+	for (Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	p_script->member_functions.clear();
+	p_script->initializer = nullptr;
+
+	p_script->native = Ref<GDScriptNativeClass>();
+	p_script->base = Ref<GDScript>();
+	p_script->_base = nullptr;
+	p_script->members.clear();
+	p_script->member_indices.clear();
+	p_script->member_info.clear();
+	p_script->constants.clear();
+	p_script->_signals.clear();
+	p_script->tool = false;
+	p_script->name = StringName();
+	p_script->valid = false;
+}
+
+Error GDScriptBytecodeCache::load(GDScript *p_script, const Vector<uint8_t> &p_cache, const Vector<uint8_t> &p_source) {
+	ERR_FAIL_NULL_V(p_script, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(p_script->member_functions.size() || p_script->subclasses.size(), ERR_ALREADY_IN_USE, "Bytecode caches can only be loaded into new scripts.");
+
+	if (p_cache.size() < CACHE_HEADER_SIZE) {
+		return ERR_FILE_CORRUPT;
+	}
+
+	Reader header(p_cache.ptr(), CACHE_HEADER_SIZE);
+	if (header.get_u8() != 'G' || header.get_u8() != 'D' || header.get_u8() != 'B' || header.get_u8() != 'C') {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+	if (header.get_u32() != FORMAT_VERSION) {
+		print_verbose("GDScript bytecode cache: unsupported format version.");
+		return ERR_FILE_UNRECOGNIZED;
+	}
+	uint64_t engine_hash = header.get_u32();
+	engine_hash |= uint64_t(header.get_u32()) << 32;
+	if (engine_hash != get_engine_hash()) {
+		print_verbose("GDScript bytecode cache: made by a different engine build.");
+		return ERR_FILE_UNRECOGNIZED;
+	}
+#ifdef DEBUG_ENABLED
+	bool debug = true;
+#else
+	bool debug = false;
+#endif
+	if (bool(header.get_u8()) != debug) {
+		print_verbose(String("GDScript bytecode cache: not made for ") + (debug ? "debug" : "release") + " builds.");
+		return ERR_FILE_UNRECOGNIZED;
+	}
+	uint32_t source_size = header.get_u32();
+	uint32_t source_hash = header.get_u32();
+	if (source_size != (uint32_t)p_source.size() || source_hash != hash_djb2_buffer(p_source.ptr(), p_source.size())) {
+		print_verbose("GDScript bytecode cache: source changed.");
+		return ERR_FILE_UNRECOGNIZED;
+	}
+	uint32_t payload_size = header.get_u32();
+	uint32_t payload_hash = header.get_u32();
+	const uint8_t *payload = p_cache.ptr() + CACHE_HEADER_SIZE;
+	ERR_FAIL_COND_V(payload_size != uint32_t(p_cache.size() - CACHE_HEADER_SIZE), ERR_FILE_CORRUPT);
+	ERR_FAIL_COND_V(payload_hash != hash_djb2_buffer(payload, payload_size), ERR_FILE_CORRUPT);
+
+	p_script->fully_qualified_name = p_script->path;
+
+	Reader reader(payload, payload_size);
+	List<GDScript *> classes;
+	Error err = _load_class_tree(reader, p_script, classes);
+	for (List<GDScript *>::Element *E = classes.front(); E && err == OK; E = E->next()) {
+		err = _load_class(reader, p_script, E->get());
+	}
+	if (err == OK && reader.pos != reader.size) {
+		err = ERR_FILE_CORRUPT;
+	}
+
+	if (err != OK) {
+		_clear_class(p_script);
+		return err;
+	}
+
+	for (List<GDScript *>::Element *E = classes.front(); E; E = E->next()) {
+		E->get()->valid = true;
+	}
+	for (Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		p_script->_set_subclass_path(E->get(), p_script->path);
+	}
+
+	return OK;
+}
+
+Error GDScriptBytecodeCache::load_from_file(GDScript *p_script, const String &p_source_path) {
+	// The editor always works with the source.
+	if (Engine::get_singleton()->is_editor_hint()) {
+		return ERR_UNAVAILABLE;
+	}
+
+	String cache_path = get_cache_path(p_source_path);
+	if (!FileAccess::exists(cache_path)) {
+		return ERR_FILE_NOT_FOUND;
+	}
+
+	Vector<uint8_t> cache = FileAccess::get_file_as_array(cache_path);
+	Vector<uint8_t> source = FileAccess::get_file_as_array(p_source_path);
+
+	Error err = load(p_script, cache, source);
+	if (err != OK) {
+		print_verbose("GDScript bytecode cache: can't use '" + cache_path + "', compiling '" + p_source_path + "' instead.");
+	}
+	return err;
+}
@@ -0,0 +1,58 @@
+/**************************************************************************/
+/*  gdscript_bytecode_cache.h                                             */
+/**************************************************************************/
+
+
+#ifndef GDSCRIPT_BYTECODE_CACHE_H
+#define GDSCRIPT_BYTECODE_CACHE_H
+
+#include "gdscript.h"
+
+// Compiled scripts saved at export time, so the game can skip parsing and compiling them at load.
+// A cache is only used when it was made by the same engine (version, ClassDB constants, opcodes
+// and built-in functions), for the same kind of build (debug or release) and from the exact
+// source file it sits next to. In any other case the loader compiles the source as usual.
+
+class GDScriptBytecodeCache {
+public:
+	enum {
+		FORMAT_VERSION = 1,
+	};
+
+private:
+	struct Writer;
+	struct Reader;
+
+	static Error _save_script_ref(Writer &p_writer, const Script *p_script, const GDScript *p_main);
+	static Error _save_constant(Writer &p_writer, const Variant &p_value, const GDScript *p_main);
+	static Error _save_data_type(Writer &p_writer, const GDScriptDataType &p_type, const GDScript *p_main);
+	static Error _save_function(Writer &p_writer, const GDScriptFunction *p_function, const GDScript *p_main);
+	static void _save_class_tree(Writer &p_writer, const GDScript *p_script, List<const GDScript *> &r_classes);
+	static Error _save_class(Writer &p_writer, const GDScript *p_script, const GDScript *p_main);
+
+	static Error _load_script_ref(Reader &p_reader, GDScript *p_main, Ref<Script> &r_script);
+	static Error _load_constant(Reader &p_reader, GDScript *p_main, Variant &r_value);
+	static Error _load_data_type(Reader &p_reader, GDScript *p_main, const GDScript *p_owner, GDScriptDataType &r_type);
+	static Error _load_function(Reader &p_reader, GDScript *p_main, GDScript *p_script, GDScriptFunction *p_function);
+	static Error _load_class_tree(Reader &p_reader, GDScript *p_script, List<GDScript *> &r_classes);
+	static Error _load_class(Reader &p_reader, GDScript *p_main, GDScript *p_script);
+	static void _clear_class(GDScript *p_script);
+
+public:
+	// The cache of "res://a.gd" or "res://a.gdc" is "res://a.gdbc".
+	static String get_cache_path(const String &p_source_path);
+	static uint64_t get_engine_hash();
+
+	// Serializes a compiled script. p_source is the file the cache stands for, as read by the loader.
+	// p_debug tells whether the script was compiled with debug code (lines, asserts, breakpoints).
+	static Error save(const Ref<GDScript> &p_script, const Vector<uint8_t> &p_source, bool p_debug, Vector<uint8_t> &r_cache);
+	// Parses and compiles the source into a new script and serializes it, for export.
+	static Error compile(const String &p_path, const String &p_source_code, const Vector<uint8_t> &p_source, bool p_debug, Vector<uint8_t> &r_cache);
+
+	// Fills a new script (with its path already set) from the cache, the script is left empty on failure.
+	static Error load(GDScript *p_script, const Vector<uint8_t> &p_cache, const Vector<uint8_t> &p_source);
+	// Loads the cache next to the source file if there is a valid one.
+	static Error load_from_file(GDScript *p_script, const String &p_source_path);
+};
+
+#endif // GDSCRIPT_BYTECODE_CACHE_H
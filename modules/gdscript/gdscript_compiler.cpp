@@ -34,6 +34,46 @@ bool GDScriptCompiler::_is_class_member_property(GDScript *owner, const StringNa
 	return ClassDB::has_property(nc->get_name(), p_name);
 }
 
+// Whether evaluating the expression can call functions or property getters, which could change self.
+bool GDScriptCompiler::_can_run_code(CodeGen &codegen, const GDScriptParser::Node *p_expression) {
+	switch (p_expression->type) {
+		case GDScriptParser::Node::TYPE_CONSTANT:
+		case GDScriptParser::Node::TYPE_SELF: {
+			return false;
+		}
+		case GDScriptParser::Node::TYPE_IDENTIFIER: {
+			return _is_class_member_property(codegen, static_cast<const GDScriptParser::IdentifierNode *>(p_expression)->name);
+		}
+		case GDScriptParser::Node::TYPE_OPERATOR: {
+			const GDScriptParser::OperatorNode *on = static_cast<const GDScriptParser::OperatorNode *>(p_expression);
+			switch (on->op) {
+				case GDScriptParser::OperatorNode::OP_CALL:
+				case GDScriptParser::OperatorNode::OP_PARENT_CALL:
+				case GDScriptParser::OperatorNode::OP_YIELD:
+				case GDScriptParser::OperatorNode::OP_INDEX:
+				case GDScriptParser::OperatorNode::OP_INDEX_NAMED:
+				case GDScriptParser::OperatorNode::OP_IN: {
+					return true;
+				}
+				default: {
+					if (on->op >= GDScriptParser::OperatorNode::OP_INIT_ASSIGN && on->op <= GDScriptParser::OperatorNode::OP_ASSIGN_BIT_XOR) {
+						return true;
+					}
+				}
+			}
+			for (int i = 0; i < on->arguments.size(); i++) {
+				if (_can_run_code(codegen, on->arguments[i])) {
+					return true;
+				}
+			}
+			return false;
+		}
+		default: {
+			return true;
+		}
+	}
+}
+
 void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::Node *p_node) {
 	if (error != "") {
 		return;
@@ -65,9 +105,30 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	return true;
 }
 
+Variant::Type GDScriptCompiler::_get_builtin_type(const GDScriptParser::Node *p_expression) const {
+	GDScriptParser::DataType datatype = p_expression->get_datatype();
+	if (!datatype.has_type || datatype.is_meta_type || datatype.kind != GDScriptParser::DataType::BUILTIN) {
+		return Variant::NIL;
+	}
+	return datatype.builtin_type;
+}
+
 bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level, bool p_initializer, int p_index_addr) {
 	ERR_FAIL_COND_V(on->arguments.size() != 2, false);
 
+	Variant::Type type_a = _get_builtin_type(on->arguments[0]);
+	Variant::Type type_b = _get_builtin_type(on->arguments[1]);
+
+	// An int constant used with a float (e.g. `speed * 2`) can use a float opcode, those also
+	// take ints. The constant is kept as an int, as the other operand may not be a float at
+	// runtime (e.g. an untyped value returned from a typed function), and int with int must
+	// still give an int.
+	if (type_a == Variant::INT && on->arguments[0]->type == GDScriptParser::Node::TYPE_CONSTANT && GDScriptFunction::get_typed_operator_opcode(op, Variant::REAL, type_b) != GDScriptFunction::OPCODE_OPERATOR) {
+		type_a = Variant::REAL;
+	} else if (type_b == Variant::INT && on->arguments[1]->type == GDScriptParser::Node::TYPE_CONSTANT && GDScriptFunction::get_typed_operator_opcode(op, type_a, Variant::REAL) != GDScriptFunction::OPCODE_OPERATOR) {
+		type_b = Variant::REAL;
+	}
+
 	int src_address_a = _parse_expression(codegen, on->arguments[0], p_stack_level, false, p_initializer, p_index_addr);
 	if (src_address_a < 0) {
 		return false;
@@ -81,13 +142,52 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 		return false;
 	}
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	// operands the parser could type get a specialized opcode, which doesn't need the operator
+	GDScriptFunction::Opcode opcode = GDScriptFunction::get_typed_operator_opcode(op, type_a, type_b);
+	codegen.opcodes.push_back(opcode); // perform operator
+	if (opcode == GDScriptFunction::OPCODE_OPERATOR) {
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
 }
 
+bool GDScriptCompiler::_can_ptrcall(CodeGen &codegen, const GDScriptParser::OperatorNode *p_call) const {
+#ifdef PTRCALL_ENABLED
+	const GDScriptParser::Node *base = p_call->arguments[0];
+	if (base->type == GDScriptParser::Node::TYPE_SELF && codegen.function_node && codegen.function_node->_static) {
+		return false;
+	}
+
+	GDScriptParser::DataType base_type = base->get_datatype();
+	if (!base_type.has_type || base_type.is_meta_type || base_type.kind == GDScriptParser::DataType::BUILTIN) {
+		return false;
+	}
+	StringName native_type = _gdtype_from_datatype(base_type, codegen.script).native_type;
+	if (native_type == StringName()) {
+		return false;
+	}
+
+	// The receiver is only known to inherit the class, the method bind used at runtime comes
+	// from the inline cache and the argument types are checked again when calling.
+	const StringName &name = static_cast<const GDScriptParser::IdentifierNode *>(p_call->arguments[1])->name;
+	MethodBind *method = ClassDB::get_method(native_type, name);
+	if (!method || !GDScriptFunction::can_ptrcall(method) || method->get_argument_count() != p_call->arguments.size() - 2) {
+		return false;
+	}
+	for (int i = 0; i < method->get_argument_count(); i++) {
+		Variant::Type type = method->get_argument_type(i);
+		if (type != Variant::NIL && type != _get_builtin_type(p_call->arguments[i + 2])) {
+			return false;
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
 GDScriptDataType GDScriptCompiler::_gdtype_from_datatype(const GDScriptParser::DataType &p_datatype, GDScript *p_owner) const {
 	if (!p_datatype.has_type) {
 		return GDScriptDataType();
@@ -157,48 +257,37 @@ GDScriptDataType GDScriptCompiler::_gdtype_from_datatype(const GDScriptParser::D
 	return result;
 }
 
-int GDScriptCompiler::_parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::OperatorNode *p_expression, int p_stack_level, int p_index_addr) {
-	Variant::Operator var_op = Variant::OP_MAX;
-
-	switch (p_expression->op) {
+// Operator of a compound assignment, OP_MAX for a plain one.
+static Variant::Operator _get_assign_operator(GDScriptParser::OperatorNode::Operator p_op) {
+	switch (p_op) {
 		case GDScriptParser::OperatorNode::OP_ASSIGN_ADD:
-			var_op = Variant::OP_ADD;
-			break;
+			return Variant::OP_ADD;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_SUB:
-			var_op = Variant::OP_SUBTRACT;
-			break;
+			return Variant::OP_SUBTRACT;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_MUL:
-			var_op = Variant::OP_MULTIPLY;
-			break;
+			return Variant::OP_MULTIPLY;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_DIV:
-			var_op = Variant::OP_DIVIDE;
-			break;
+			return Variant::OP_DIVIDE;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_MOD:
-			var_op = Variant::OP_MODULE;
-			break;
+			return Variant::OP_MODULE;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_SHIFT_LEFT:
-			var_op = Variant::OP_SHIFT_LEFT;
-			break;
+			return Variant::OP_SHIFT_LEFT;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_SHIFT_RIGHT:
-			var_op = Variant::OP_SHIFT_RIGHT;
-			break;
+			return Variant::OP_SHIFT_RIGHT;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_BIT_AND:
-			var_op = Variant::OP_BIT_AND;
-			break;
+			return Variant::OP_BIT_AND;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_BIT_OR:
-			var_op = Variant::OP_BIT_OR;
-			break;
+			return Variant::OP_BIT_OR;
 		case GDScriptParser::OperatorNode::OP_ASSIGN_BIT_XOR:
-			var_op = Variant::OP_BIT_XOR;
-			break;
-		case GDScriptParser::OperatorNode::OP_INIT_ASSIGN:
-		case GDScriptParser::OperatorNode::OP_ASSIGN: {
-			//none
-		} break;
-		default: {
-			ERR_FAIL_V(-1);
-		}
+			return Variant::OP_BIT_XOR;
+		default:
+			return Variant::OP_MAX;
 	}
+}
+
+int GDScriptCompiler::_parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::OperatorNode *p_expression, int p_stack_level, int p_index_addr) {
+	ERR_FAIL_COND_V(p_expression->op < GDScriptParser::OperatorNode::OP_INIT_ASSIGN || p_expression->op > GDScriptParser::OperatorNode::OP_ASSIGN_BIT_XOR, -1);
+	Variant::Operator var_op = _get_assign_operator(p_expression->op);
 
 	bool initializer = p_expression->op == GDScriptParser::OperatorNode::OP_INIT_ASSIGN;
 
@@ -643,11 +732,18 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
-						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
+						if (_can_ptrcall(codegen, on)) {
+							codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL_PTRCALL : GDScriptFunction::OPCODE_CALL_PTRCALL_RETURN);
+						} else {
+							codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
+						}
 						codegen.opcodes.push_back(on->arguments.size() - 2);
 						codegen.alloc_call(on->arguments.size() - 2);
 						for (int i = 0; i < arguments.size(); i++) {
 							codegen.opcodes.push_back(arguments[i]);
+							if (i == 1) {
+								codegen.opcodes.push_back(codegen.alloc_inline_cache()); // after the method name
+							}
 						}
 					}
 				} break;
@@ -739,6 +835,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					if (named) {
+						codegen.opcodes.push_back(codegen.alloc_inline_cache());
+					}
 
 				} break;
 				case GDScriptParser::OperatorNode::OP_AND: {
@@ -1081,6 +1180,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
+							if (named) {
+								codegen.opcodes.push_back(codegen.alloc_inline_cache());
+							}
 							slevel++;
 							codegen.alloc_stack(slevel);
 							int dst_pos = (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS) | slevel;
@@ -1090,6 +1192,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							//add in reverse order, since it will be reverted
 
 							setchain.push_back(dst_pos);
+							if (named) {
+								setchain.push_back(codegen.alloc_inline_cache());
+							}
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
 							setchain.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
@@ -1127,6 +1232,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
+						if (named) {
+							codegen.opcodes.push_back(codegen.alloc_inline_cache());
+						}
 						codegen.opcodes.push_back(set_value);
 
 						for (int i = 0; i < setchain.size(); i++) {
@@ -1139,14 +1247,30 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						//assignment to member property
 
 						int slevel = p_stack_level;
+						StringName name = static_cast<GDScriptParser::IdentifierNode *>(on->arguments[0])->name;
+
+						// compound assignment, the property is read, operated and written back by a single opcode,
+						// unless the value can run code, which must see and may change the property before it's read
+						Variant::Operator var_op = _get_assign_operator(on->op);
+						if (var_op != Variant::OP_MAX && !_can_run_code(codegen, on->arguments[1])) {
+							int value_address = _parse_expression(codegen, on->arguments[1], slevel);
+							if (value_address < 0) {
+								return -1;
+							}
+
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR_MEMBER);
+							codegen.opcodes.push_back(var_op);
+							codegen.opcodes.push_back(codegen.get_name_map_pos(name));
+							codegen.opcodes.push_back(value_address);
+
+							return GDScriptFunction::ADDR_TYPE_NIL << GDScriptFunction::ADDR_BITS;
+						}
 
 						int src_address = _parse_assign_right_expression(codegen, on, slevel);
 						if (src_address < 0) {
 							return -1;
 						}
 
-						StringName name = static_cast<GDScriptParser::IdentifierNode *>(on->arguments[0])->name;
-
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_MEMBER);
 						codegen.opcodes.push_back(codegen.get_name_map_pos(name));
 						codegen.opcodes.push_back(src_address);
@@ -1289,6 +1413,157 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 	}
 }
 
+// Emits a jump taken when the condition is false, and returns the position of its (still unset) target.
+// Comparisons are fused with the jump, which saves a dispatch and the temporary holding the result.
+int GDScriptCompiler::_parse_jump_if_not(CodeGen &codegen, const GDScriptParser::Node *p_condition, int p_stack_level) {
+	if (p_condition->type == GDScriptParser::Node::TYPE_OPERATOR) {
+		const GDScriptParser::OperatorNode *on = static_cast<const GDScriptParser::OperatorNode *>(p_condition);
+		Variant::Operator op = Variant::OP_MAX;
+		switch (on->op) {
+			case GDScriptParser::OperatorNode::OP_EQUAL:
+				op = Variant::OP_EQUAL;
+				break;
+			case GDScriptParser::OperatorNode::OP_NOT_EQUAL:
+				op = Variant::OP_NOT_EQUAL;
+				break;
+			case GDScriptParser::OperatorNode::OP_LESS:
+				op = Variant::OP_LESS;
+				break;
+			case GDScriptParser::OperatorNode::OP_LESS_EQUAL:
+				op = Variant::OP_LESS_EQUAL;
+				break;
+			case GDScriptParser::OperatorNode::OP_GREATER:
+				op = Variant::OP_GREATER;
+				break;
+			case GDScriptParser::OperatorNode::OP_GREATER_EQUAL:
+				op = Variant::OP_GREATER_EQUAL;
+				break;
+			default:
+				break;
+		}
+
+		if (op != Variant::OP_MAX) {
+			int slevel = p_stack_level;
+			int src_address_a = _parse_expression(codegen, on->arguments[0], slevel);
+			if (src_address_a < 0) {
+				return -1;
+			}
+			if (src_address_a & GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS) {
+				slevel++; //uses stack for return, increase stack
+			}
+			int src_address_b = _parse_expression(codegen, on->arguments[1], slevel);
+			if (src_address_b < 0) {
+				return -1;
+			}
+
+			codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT_COMPARE);
+			codegen.opcodes.push_back(op);
+			codegen.opcodes.push_back(src_address_a);
+			codegen.opcodes.push_back(src_address_b);
+			codegen.opcodes.push_back(0);
+			return codegen.opcodes.size() - 1;
+		}
+	}
+
+	int ret = _parse_expression(codegen, p_condition, p_stack_level, false);
+	if (ret < 0) {
+		return -1;
+	}
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
+	codegen.opcodes.push_back(ret);
+	codegen.opcodes.push_back(0);
+	return codegen.opcodes.size() - 1;
+}
+
+// Counts from, from + step... up to (excluding) to, like the array returned by range() but without building it.
+Error GDScriptCompiler::_parse_range_loop(CodeGen &codegen, const GDScriptParser::ControlFlowNode *p_for, const GDScriptParser::OperatorNode *p_range, int p_stack_level) {
+	int slevel = p_stack_level;
+	int iter_stack_pos = slevel;
+	int iterator_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
+	int counter_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
+	int to_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
+	int step_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
+	codegen.alloc_stack(slevel);
+
+	// range(to), range(from, to) or range(from, to, step)
+	int argcount = p_range->arguments.size() - 1;
+	const GDScriptParser::Node *from_arg = argcount > 1 ? p_range->arguments[1] : nullptr;
+	const GDScriptParser::Node *to_arg = argcount > 1 ? p_range->arguments[2] : p_range->arguments[1];
+	const GDScriptParser::Node *step_arg = argcount > 2 ? p_range->arguments[3] : nullptr;
+
+	// The arguments are evaluated once, in order. The bounds are kept in their own slots for the whole loop.
+	int arg_slevel = slevel;
+	int from_addr = codegen.get_constant_pos(0) | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS);
+	if (from_arg) {
+		from_addr = _parse_expression(codegen, from_arg, arg_slevel);
+		if (from_addr < 0) {
+			return ERR_COMPILATION_FAILED;
+		}
+		if ((from_addr >> GDScriptFunction::ADDR_BITS & GDScriptFunction::ADDR_TYPE_STACK) == GDScriptFunction::ADDR_TYPE_STACK) {
+			arg_slevel++;
+			codegen.alloc_stack(arg_slevel);
+		}
+	}
+
+	int to_addr = _parse_expression(codegen, to_arg, arg_slevel);
+	if (to_addr < 0) {
+		return ERR_COMPILATION_FAILED;
+	}
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_ASSIGN);
+	codegen.opcodes.push_back(to_pos);
+	codegen.opcodes.push_back(to_addr);
+
+	int step_addr = codegen.get_constant_pos(1) | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS);
+	if (step_arg) {
+		step_addr = _parse_expression(codegen, step_arg, arg_slevel);
+		if (step_addr < 0) {
+			return ERR_COMPILATION_FAILED;
+		}
+	}
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_ASSIGN);
+	codegen.opcodes.push_back(step_pos);
+	codegen.opcodes.push_back(step_addr);
+
+	codegen.push_stack_identifiers();
+	codegen.add_stack_identifier(static_cast<const GDScriptParser::IdentifierNode *>(p_for->arguments[0])->name, iter_stack_pos);
+
+	//begin loop
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN_RANGE);
+	codegen.opcodes.push_back(counter_pos);
+	codegen.opcodes.push_back(from_addr);
+	codegen.opcodes.push_back(to_pos);
+	codegen.opcodes.push_back(step_pos);
+	codegen.opcodes.push_back(codegen.opcodes.size() + 4);
+	codegen.opcodes.push_back(iterator_pos);
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+	codegen.opcodes.push_back(codegen.opcodes.size() + 9);
+	//break loop
+	int break_pos = codegen.opcodes.size();
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP);
+	codegen.opcodes.push_back(0);
+	//next loop
+	int continue_pos = codegen.opcodes.size();
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_RANGE);
+	codegen.opcodes.push_back(counter_pos);
+	codegen.opcodes.push_back(to_pos);
+	codegen.opcodes.push_back(step_pos);
+	codegen.opcodes.push_back(break_pos);
+	codegen.opcodes.push_back(iterator_pos);
+
+	Error err = _parse_block(codegen, p_for->body, slevel, break_pos, continue_pos);
+	if (err) {
+		return err;
+	}
+
+	codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP);
+	codegen.opcodes.push_back(continue_pos);
+	codegen.opcodes.write[break_pos + 1] = codegen.opcodes.size();
+
+	codegen.pop_stack_identifiers();
+
+	return OK;
+}
+
 Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::BlockNode *p_block, int p_stack_level, int p_break_addr, int p_continue_addr) {
 	codegen.push_stack_identifiers();
 	codegen.current_line = p_block->line;
@@ -1299,6 +1574,9 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 		switch (s->type) {
 			case GDScriptParser::Node::TYPE_NEWLINE: {
 #ifdef DEBUG_ENABLED
+				if (strip_debug) {
+					break;
+				}
 				const GDScriptParser::NewLineNode *nl = static_cast<const GDScriptParser::NewLineNode *>(s);
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
 				codegen.opcodes.push_back(nl->line);
@@ -1343,6 +1621,9 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 
 						for (int j = 0; j < match->compiled_pattern_branches.size(); j++) {
 							GDScriptParser::MatchNode::CompiledPatternBranch branch = match->compiled_pattern_branches[j];
+							if (branch.compiled_pattern->type == GDScriptParser::Node::TYPE_CONSTANT && !static_cast<const GDScriptParser::ConstantNode *>(branch.compiled_pattern)->value.booleanize()) {
+								continue; // Folded pattern that can't match.
+							}
 
 							// jump over continue
 							// jump unconditionally
@@ -1383,15 +1664,22 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 					} break;
 
 					case GDScriptParser::ControlFlowNode::CF_IF: {
-						int ret2 = _parse_expression(codegen, cf->arguments[0], p_stack_level, false);
-						if (ret2 < 0) {
-							return ERR_PARSE_ERROR;
+						if (cf->arguments[0]->type == GDScriptParser::Node::TYPE_CONSTANT) {
+							// Folded condition, only the branch that can run is compiled.
+							const GDScriptParser::BlockNode *block = static_cast<const GDScriptParser::ConstantNode *>(cf->arguments[0])->value.booleanize() ? cf->body : cf->body_else;
+							if (block) {
+								Error err = _parse_block(codegen, block, p_stack_level, p_break_addr, p_continue_addr);
+								if (err) {
+									return err;
+								}
+							}
+							break;
 						}
 
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-						codegen.opcodes.push_back(ret2);
-						int else_addr = codegen.opcodes.size();
-						codegen.opcodes.push_back(0); //temporary
+						int else_addr = _parse_jump_if_not(codegen, cf->arguments[0], p_stack_level);
+						if (else_addr < 0) {
+							return ERR_PARSE_ERROR;
+						}
 
 						Error err = _parse_block(codegen, cf->body, p_stack_level, p_break_addr, p_continue_addr);
 						if (err) {
@@ -1404,8 +1692,12 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 							codegen.opcodes.push_back(0);
 							codegen.opcodes.write[else_addr] = codegen.opcodes.size();
 
-							codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
-							codegen.opcodes.push_back(cf->body_else->line);
+#ifdef DEBUG_ENABLED
+							if (!strip_debug) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
+								codegen.opcodes.push_back(cf->body_else->line);
+							}
+#endif
 							codegen.current_line = cf->body_else->line;
 
 							Error err2 = _parse_block(codegen, cf->body_else, p_stack_level, p_break_addr, p_continue_addr);
@@ -1421,6 +1713,17 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 
 					} break;
 					case GDScriptParser::ControlFlowNode::CF_FOR: {
+						if (cf->arguments[1]->type == GDScriptParser::Node::TYPE_OPERATOR) {
+							const GDScriptParser::OperatorNode *op = static_cast<const GDScriptParser::OperatorNode *>(cf->arguments[1]);
+							if (op->op == GDScriptParser::OperatorNode::OP_CALL && op->arguments.size() >= 2 && op->arguments.size() <= 4 && op->arguments[0]->type == GDScriptParser::Node::TYPE_BUILT_IN_FUNCTION && static_cast<const GDScriptParser::BuiltInFunctionNode *>(op->arguments[0])->function == GDScriptFunctions::GEN_RANGE) {
+								Error err = _parse_range_loop(codegen, cf, op, p_stack_level);
+								if (err) {
+									return err;
+								}
+								break;
+							}
+						}
+
 						int slevel = p_stack_level;
 						int iter_stack_pos = slevel;
 						int iterator_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
@@ -1441,8 +1744,11 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(ret2);
 
+						// counting loops over an int don't need the generic iteration
+						bool int_loop = _get_builtin_type(cf->arguments[1]) == Variant::INT;
+
 						//begin loop
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN);
+						codegen.opcodes.push_back(int_loop ? GDScriptFunction::OPCODE_ITERATE_BEGIN_INT : GDScriptFunction::OPCODE_ITERATE_BEGIN);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(codegen.opcodes.size() + 4);
@@ -1455,7 +1761,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(0); //skip code for next
 						//next loop
 						int continue_pos = codegen.opcodes.size();
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE);
+						codegen.opcodes.push_back(int_loop ? GDScriptFunction::OPCODE_ITERATE_INT : GDScriptFunction::OPCODE_ITERATE);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(break_pos);
@@ -1474,6 +1780,12 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 
 					} break;
 					case GDScriptParser::ControlFlowNode::CF_WHILE: {
+						// A folded condition either never enters the loop or doesn't need to be checked.
+						bool constant_condition = cf->arguments[0]->type == GDScriptParser::Node::TYPE_CONSTANT;
+						if (constant_condition && !static_cast<const GDScriptParser::ConstantNode *>(cf->arguments[0])->value.booleanize()) {
+							break;
+						}
+
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP);
 						codegen.opcodes.push_back(codegen.opcodes.size() + 3);
 						int break_addr = codegen.opcodes.size();
@@ -1481,13 +1793,13 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(0);
 						int continue_addr = codegen.opcodes.size();
 
-						int ret2 = _parse_expression(codegen, cf->arguments[0], p_stack_level, false);
-						if (ret2 < 0) {
-							return ERR_PARSE_ERROR;
+						if (!constant_condition) {
+							int exit_addr = _parse_jump_if_not(codegen, cf->arguments[0], p_stack_level);
+							if (exit_addr < 0) {
+								return ERR_PARSE_ERROR;
+							}
+							codegen.opcodes.write[exit_addr] = break_addr;
 						}
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
-						codegen.opcodes.push_back(ret2);
-						codegen.opcodes.push_back(break_addr);
 						Error err = _parse_block(codegen, cf->body, p_stack_level, break_addr, continue_addr);
 						if (err) {
 							return err;
@@ -1538,6 +1850,9 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			} break;
 			case GDScriptParser::Node::TYPE_ASSERT: {
 #ifdef DEBUG_ENABLED
+				if (strip_debug) {
+					break;
+				}
 				// try subblocks
 
 				const GDScriptParser::AssertNode *as = static_cast<const GDScriptParser::AssertNode *>(s);
@@ -1562,6 +1877,9 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			} break;
 			case GDScriptParser::Node::TYPE_BREAKPOINT: {
 #ifdef DEBUG_ENABLED
+				if (strip_debug) {
+					break;
+				}
 				// try subblocks
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_BREAKPOINT);
 #endif
@@ -1602,7 +1920,8 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.stack_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
-	codegen.debug_stack = ScriptDebugger::get_singleton() != nullptr;
+	codegen.inline_cache_count = 0;
+	codegen.debug_stack = debug_stack && !strip_debug;
 	Vector<StringName> argnames;
 
 	int stack_level = 0;
@@ -1766,6 +2085,15 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_code_size = 0;
 	}
 
+	if (codegen.inline_cache_count) {
+		gdfunc->inline_caches.resize(codegen.inline_cache_count);
+		gdfunc->_inline_caches_ptr = gdfunc->inline_caches.ptrw();
+		gdfunc->_inline_cache_count = codegen.inline_cache_count;
+	} else {
+		gdfunc->_inline_caches_ptr = nullptr;
+		gdfunc->_inline_cache_count = 0;
+	}
+
 	if (defarg_addr.size()) {
 		gdfunc->default_arguments = defarg_addr;
 		gdfunc->_default_arg_count = defarg_addr.size() - 1;
@@ -2168,6 +2496,8 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 
 	source = p_script->get_path();
 
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
 	// The best fully qualified name for a base level script is its file path
 	p_script->fully_qualified_name = p_script->path;
 
@@ -2187,6 +2517,9 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 		return err;
 	}
 
+	// Functions and member indices are final now, caches filled while compiling must go.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
 	return OK;
 }
 
@@ -2200,5 +2533,15 @@ int GDScriptCompiler::get_error_column() const {
 	return err_column;
 }
 
+void GDScriptCompiler::set_strip_debug(bool p_strip) {
+	strip_debug = p_strip;
+}
+
+void GDScriptCompiler::set_debug_stack(bool p_enable) {
+	debug_stack = p_enable;
+}
+
 GDScriptCompiler::GDScriptCompiler() {
+	strip_debug = false;
+	debug_stack = ScriptDebugger::get_singleton() != nullptr;
 }
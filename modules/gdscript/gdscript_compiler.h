@@ -105,6 +105,11 @@ class GDScriptCompiler {
 			}
 		}
 
+		int inline_cache_count;
+		int alloc_inline_cache() {
+			return inline_cache_count++;
+		}
+
 		int current_line;
 		int stack_max;
 		int call_max;
@@ -112,16 +117,21 @@ class GDScriptCompiler {
 
 	bool _is_class_member_property(CodeGen &codegen, const StringName &p_name);
 	bool _is_class_member_property(GDScript *owner, const StringName &p_name);
+	bool _can_run_code(CodeGen &codegen, const GDScriptParser::Node *p_expression);
 
 	void _set_error(const String &p_error, const GDScriptParser::Node *p_node);
 
 	bool _create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level);
+	Variant::Type _get_builtin_type(const GDScriptParser::Node *p_expression) const;
+	bool _can_ptrcall(CodeGen &codegen, const GDScriptParser::OperatorNode *p_call) const;
 	bool _create_binary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level, bool p_initializer = false, int p_index_addr = 0);
 
 	GDScriptDataType _gdtype_from_datatype(const GDScriptParser::DataType &p_datatype, GDScript *p_owner = nullptr) const;
 
 	int _parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::OperatorNode *p_expression, int p_stack_level, int p_index_addr = 0);
 	int _parse_expression(CodeGen &codegen, const GDScriptParser::Node *p_expression, int p_stack_level, bool p_root = false, bool p_initializer = false, int p_index_addr = 0);
+	int _parse_jump_if_not(CodeGen &codegen, const GDScriptParser::Node *p_condition, int p_stack_level);
+	Error _parse_range_loop(CodeGen &codegen, const GDScriptParser::ControlFlowNode *p_for, const GDScriptParser::OperatorNode *p_range, int p_stack_level);
 	Error _parse_block(CodeGen &codegen, const GDScriptParser::BlockNode *p_block, int p_stack_level = 0, int p_break_addr = -1, int p_continue_addr = -1);
 	Error _parse_function(GDScript *p_script, const GDScriptParser::ClassNode *p_class, const GDScriptParser::FunctionNode *p_func, bool p_for_ready = false);
 	Error _parse_class_level(GDScript *p_script, const GDScriptParser::ClassNode *p_class, bool p_keep_state);
@@ -131,6 +141,8 @@ class GDScriptCompiler {
 	int err_column;
 	StringName source;
 	String error;
+	bool strip_debug;
+	bool debug_stack;
 
 public:
 	Error compile(const GDScriptParser *p_parser, GDScript *p_script, bool p_keep_state = false);
@@ -139,6 +151,11 @@ public:
 	int get_error_line() const;
 	int get_error_column() const;
 
+	// Leaves out line markers, asserts and breakpoints as a release build does.
+	void set_strip_debug(bool p_strip);
+	// Records the local variables of each block for the debugger, enabled by default when running under the debugger.
+	void set_debug_stack(bool p_enable);
+
 	GDScriptCompiler();
 };
 
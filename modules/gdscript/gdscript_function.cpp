@@ -5,9 +5,14 @@
 
 #include "gdscript_function.h"
 
+#include "core/class_db.h"
+#include "core/core_string_names.h"
+#include "core/engine.h"
 #include "core/os/os.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
+#include "gdscript_sampling_profiler.h"
 
 Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant &static_ref, Variant *p_stack, String &r_error) const {
 	int address = p_address & ADDR_MASK;
@@ -158,10 +163,426 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 	return err_text;
 }
 
+// Inline caches only know how GDScript resolves names, receivers with a script
+// in another language (or a placeholder) always take the regular path.
+static _FORCE_INLINE_ bool _get_cache_receiver(Object *p_obj, GDScriptInstance *&r_instance) {
+	ScriptInstance *si = p_obj->get_script_instance();
+	if (!si) {
+		r_instance = nullptr;
+		return true;
+	}
+	if (si->get_language() != GDScriptLanguage::get_singleton()) {
+		return false;
+	}
+#ifdef TOOLS_ENABLED
+	if (si->is_placeholder()) {
+		return false;
+	}
+#endif
+	r_instance = static_cast<GDScriptInstance *>(si);
+	return true;
+}
+
+void GDScriptFunction::_count_inline_cache(bool p_hit) {
+#ifdef DEBUG_ENABLED
+	if (GDScriptLanguage::get_singleton()->profiling) {
+		if (p_hit) {
+			profile.inline_cache_hits++;
+			profile.frame_inline_cache_hits++;
+		} else {
+			profile.inline_cache_misses++;
+			profile.frame_inline_cache_misses++;
+		}
+	}
+#endif
+}
+
+// Mirrors Object::call() and GDScriptInstance::call().
+bool GDScriptFunction::_fill_call_cache(InlineCache &p_cache, Object *p_obj, const GDScript *p_script, const StringName &p_method) const {
+	p_cache.version = 0;
+
+	if (p_method == CoreStringNames::get_singleton()->_free) {
+		return false;
+	}
+
+	const GDScript *sptr = p_script;
+	while (sptr) {
+		const Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_method);
+		if (E) {
+			p_cache.kind = InlineCache::KIND_SCRIPT_FUNCTION;
+			p_cache.function = E->get();
+			p_cache.script = p_script;
+			p_cache.version = GDScriptLanguage::get_singleton()->get_inline_cache_version();
+			return true;
+		}
+		sptr = sptr->_base;
+	}
+
+	MethodBind *method = ClassDB::get_method(p_obj->get_class_name(), p_method);
+	if (!method) {
+		return false;
+	}
+
+	p_cache.kind = InlineCache::KIND_METHOD_BIND;
+	p_cache.method = method;
+	p_cache.ptrcall = can_ptrcall(method);
+	p_cache.script = p_script;
+	p_cache.native_class = p_obj->get_class_name();
+	p_cache.version = GDScriptLanguage::get_singleton()->get_inline_cache_version();
+	return true;
+}
+
+// Mirrors Object::get(), GDScriptInstance::get() and ClassDB::get_property().
+bool GDScriptFunction::_fill_get_named_cache(InlineCache &p_cache, Object *p_obj, const GDScript *p_script, const StringName &p_name) const {
+	p_cache.version = 0;
+
+	if (p_script) {
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			if (E->get().getter) {
+				return false;
+			}
+			p_cache.kind = InlineCache::KIND_MEMBER;
+			p_cache.index = E->get().index;
+			p_cache.script = p_script;
+			p_cache.version = GDScriptLanguage::get_singleton()->get_inline_cache_version();
+			return true;
+		}
+
+		// Constants and _get() come before native properties.
+		for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (sptr->constants.has(p_name) || sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._get)) {
+				return false;
+			}
+		}
+	}
+
+	// Indexed properties and properties without a bound getter are called by name, so a script can override them.
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(p_obj->get_class_name(), p_name);
+	if (!psg || !psg->_getptr || psg->index >= 0) {
+		return false;
+	}
+	bool is_constant = false;
+	ClassDB::get_integer_constant(p_obj->get_class_name(), p_name, &is_constant);
+	if (is_constant) {
+		return false;
+	}
+
+	p_cache.kind = InlineCache::KIND_PROPERTY;
+	p_cache.method = psg->_getptr;
+	p_cache.index = -1;
+	p_cache.script = p_script;
+	p_cache.native_class = p_obj->get_class_name();
+	p_cache.version = GDScriptLanguage::get_singleton()->get_inline_cache_version();
+	return true;
+}
+
+// Mirrors Object::set(), GDScriptInstance::set() and ClassDB::set_property().
+bool GDScriptFunction::_fill_set_named_cache(InlineCache &p_cache, Object *p_obj, const GDScript *p_script, const StringName &p_name) const {
+	p_cache.version = 0;
+
+#ifdef TOOLS_ENABLED
+	// Object::set() also marks the object as edited, which only matters to the editor.
+	if (Engine::get_singleton()->is_editor_hint()) {
+		return false;
+	}
+#endif
+
+	if (p_script) {
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			const GDScript::MemberInfo &member = E->get();
+			if (member.setter || (member.data_type.has_type && member.data_type.kind != GDScriptDataType::BUILTIN)) {
+				return false;
+			}
+			p_cache.kind = InlineCache::KIND_MEMBER;
+			p_cache.index = member.index;
+			p_cache.member_type = member.data_type.has_type ? member.data_type.builtin_type : Variant::NIL;
+			p_cache.script = p_script;
+			p_cache.version = GDScriptLanguage::get_singleton()->get_inline_cache_version();
+			return true;
+		}
+
+		for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._set)) {
+				return false;
+			}
+		}
+	}
+
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(p_obj->get_class_name(), p_name);
+	if (!psg || !psg->_setptr) {
+		return false;
+	}
+
+	p_cache.kind = InlineCache::KIND_PROPERTY;
+	p_cache.method = psg->_setptr;
+	p_cache.index = psg->index;
+	p_cache.script = p_script;
+	p_cache.native_class = p_obj->get_class_name();
+	p_cache.version = GDScriptLanguage::get_singleton()->get_inline_cache_version();
+	return true;
+}
+
+// The cached accessors return false when the regular path must be taken instead,
+// which also reports errors such as calling a method on a freed instance.
+
+#ifdef PTRCALL_ENABLED
+// Calls a native method passing pointers to the argument payloads, without converting them to the
+// declared types. Returns false if the arguments don't have exactly the declared types.
+static bool _ptrcall_method(MethodBind *p_method, Object *p_obj, const Variant **p_args, int p_argcount, Variant *r_ret) {
+	if (p_argcount != p_method->get_argument_count()) {
+		return false; // default arguments
+	}
+
+	const void **argptrs = (const void **)alloca(sizeof(void *) * MAX(p_argcount, 1));
+	bool ret_is_argument = false;
+	for (int i = 0; i < p_argcount; i++) {
+		Variant::Type type = p_method->get_argument_type(i);
+		if (type == Variant::NIL) {
+			argptrs[i] = p_args[i]; // takes a Variant
+		} else if (p_args[i]->get_type() == type) {
+			argptrs[i] = VariantInternal::get_opaque_pointer(p_args[i]);
+		} else {
+			return false;
+		}
+		ret_is_argument = ret_is_argument || p_args[i] == r_ret;
+	}
+
+	if (!p_method->has_return()) {
+		p_method->ptrcall(p_obj, argptrs, nullptr);
+		if (r_ret) {
+			*r_ret = Variant();
+		}
+		return true;
+	}
+
+	// the result is written in place, unless that would overwrite an argument
+	Variant temp;
+	Variant *ret = (r_ret && !ret_is_argument) ? r_ret : &temp;
+	Variant::Type ret_type = p_method->get_argument_type(-1);
+	if (ret_type == Variant::NIL) {
+		p_method->ptrcall(p_obj, argptrs, ret);
+	} else {
+		VariantInternal::initialize(ret, ret_type);
+		p_method->ptrcall(p_obj, argptrs, VariantInternal::get_opaque_pointer(ret));
+	}
+	if (r_ret && ret != r_ret) {
+		*r_ret = temp;
+	}
+	return true;
+}
+#endif
+
+bool GDScriptFunction::can_ptrcall(const MethodBind *p_method) {
+#ifdef PTRCALL_ENABLED
+	if (p_method->is_vararg()) {
+		return false;
+	}
+	// objects are passed as a pointer to the object (or Ref), enums as 32 bits integers
+	for (int i = -1; i < p_method->get_argument_count(); i++) {
+		if (i == -1 && !p_method->has_return()) {
+			continue;
+		}
+		PropertyInfo info = i == -1 ? p_method->get_return_info() : p_method->get_argument_info(i);
+		if (info.type == Variant::OBJECT || (info.usage & PROPERTY_USAGE_CLASS_IS_ENUM)) {
+			return false;
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool GDScriptFunction::_call_cached(InlineCache &p_cache, const Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_err, bool p_ptrcall) {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+	Object *obj = p_base->operator Object *();
+	GDScriptInstance *instance;
+	if (unlikely(!obj) || !_get_cache_receiver(obj, instance)) {
+		return false;
+	}
+	const GDScript *script = instance ? instance->script.ptr() : nullptr;
+
+	bool hit = p_cache.version == GDScriptLanguage::get_singleton()->get_inline_cache_version() && p_cache.script == script &&
+			(p_cache.kind == InlineCache::KIND_SCRIPT_FUNCTION || p_cache.native_class == obj->get_class_name());
+	_count_inline_cache(hit);
+	if (!hit && !_fill_call_cache(p_cache, obj, script, p_method)) {
+		return false;
+	}
+
+	r_err.error = Variant::CallError::CALL_OK;
+	Variant ret;
+	{
+#ifdef DEBUG_ENABLED
+		_ObjectDebugLock debug_lock(obj);
+#endif
+		bool called = false;
+#ifdef PTRCALL_ENABLED
+		// When the result goes where the receiver is (a temporary such as `X.new().method()`), it's
+		// only assigned after the call, since that may release the receiver.
+		if (p_ptrcall && p_cache.kind == InlineCache::KIND_METHOD_BIND && p_cache.ptrcall) {
+			Variant *ptrcall_ret = r_ret == p_base ? &ret : r_ret;
+			called = _ptrcall_method(p_cache.method, obj, p_args, p_argcount, ptrcall_ret);
+			if (called && ptrcall_ret == r_ret) {
+				return true;
+			}
+		}
+#endif
+		if (called) {
+			// the result is in ret
+		} else if (p_cache.kind == InlineCache::KIND_SCRIPT_FUNCTION) {
+			ret = p_cache.function->call(instance, p_args, p_argcount, r_err);
+		} else {
+			ret = p_cache.method->call(obj, p_args, p_argcount, r_err);
+		}
+	}
+
+	if (r_err.error == Variant::CallError::CALL_OK && r_ret) {
+		*r_ret = ret;
+	}
+	return true;
+}
+
+bool GDScriptFunction::_get_named_cached(InlineCache &p_cache, const Variant *p_base, const StringName &p_name, Variant *r_dst) {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+	Object *obj = p_base->operator Object *();
+	GDScriptInstance *instance;
+	if (unlikely(!obj) || !_get_cache_receiver(obj, instance)) {
+		return false;
+	}
+	const GDScript *script = instance ? instance->script.ptr() : nullptr;
+
+	bool hit = p_cache.version == GDScriptLanguage::get_singleton()->get_inline_cache_version() && p_cache.script == script &&
+			(p_cache.kind == InlineCache::KIND_MEMBER || p_cache.native_class == obj->get_class_name());
+	_count_inline_cache(hit);
+	if (!hit && !_fill_get_named_cache(p_cache, obj, script, p_name)) {
+		return false;
+	}
+
+	// The destination may be the variant holding the last reference to the object, copy first.
+	Variant ret;
+	if (p_cache.kind == InlineCache::KIND_MEMBER) {
+		ret = instance->members[p_cache.index];
+	} else {
+		Variant::CallError ce;
+		ret = p_cache.method->call(obj, nullptr, 0, ce);
+	}
+	*r_dst = ret;
+	return true;
+}
+
+bool GDScriptFunction::_set_named_cached(InlineCache &p_cache, const Variant *p_base, const StringName &p_name, const Variant *p_value, bool &r_valid) {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+	Object *obj = p_base->operator Object *();
+	GDScriptInstance *instance;
+	if (unlikely(!obj) || !_get_cache_receiver(obj, instance)) {
+		return false;
+	}
+	const GDScript *script = instance ? instance->script.ptr() : nullptr;
+
+	bool hit = p_cache.version == GDScriptLanguage::get_singleton()->get_inline_cache_version() && p_cache.script == script &&
+			(p_cache.kind == InlineCache::KIND_MEMBER || p_cache.native_class == obj->get_class_name());
+	_count_inline_cache(hit);
+	if (!hit && !_fill_set_named_cache(p_cache, obj, script, p_name)) {
+		return false;
+	}
+
+	if (p_cache.kind == InlineCache::KIND_MEMBER) {
+		if (p_cache.member_type != Variant::NIL && p_value->get_type() != p_cache.member_type) {
+			return false; // needs a conversion
+		}
+		instance->members.write[p_cache.index] = *p_value;
+		r_valid = true;
+	} else {
+		Variant::CallError ce;
+		if (p_cache.index >= 0) {
+			Variant index = p_cache.index;
+			const Variant *args[2] = { &index, p_value };
+			p_cache.method->call(obj, args, 2, ce);
+		} else {
+			p_cache.method->call(obj, &p_value, 1, ce);
+		}
+		r_valid = ce.error == Variant::CallError::CALL_OK;
+	}
+	return true;
+}
+
+// Generic path of the typed operator opcodes, taken when the operands don't have the expected types
+// (typed code can still hold other types at runtime, e.g. the result of an untyped call).
+static bool _evaluate_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst, String &r_err_text) {
+	bool valid;
+#ifdef DEBUG_ENABLED
+	Variant ret;
+	Variant::evaluate(p_op, *p_a, *p_b, ret, valid);
+	if (!valid) {
+		if (ret.get_type() == Variant::STRING) {
+			//return a string when invalid with the error
+			r_err_text = ret;
+			r_err_text += " in operator '" + Variant::get_operator_name(p_op) + "'.";
+		} else {
+			r_err_text = "Invalid operands '" + Variant::get_type_name(p_a->get_type()) + "' and '" + Variant::get_type_name(p_b->get_type()) + "' in operator '" + Variant::get_operator_name(p_op) + "'.";
+		}
+		return false;
+	}
+	*r_dst = ret;
+#else
+	Variant::evaluate(p_op, *p_a, *p_b, *r_dst, valid);
+#endif
+	return true;
+}
+
+// Fast path of OPCODE_JUMP_IF_NOT_COMPARE, for operands of the same numeric type.
+template <class T>
+static _FORCE_INLINE_ bool _compare(Variant::Operator p_op, T p_a, T p_b) {
+	switch (p_op) {
+		case Variant::OP_EQUAL:
+			return p_a == p_b;
+		case Variant::OP_NOT_EQUAL:
+			return p_a != p_b;
+		case Variant::OP_LESS:
+			return p_a < p_b;
+		case Variant::OP_LESS_EQUAL:
+			return p_a <= p_b;
+		case Variant::OP_GREATER:
+			return p_a > p_b;
+		default:
+			return p_a >= p_b;
+	}
+}
+
 #if defined(__GNUC__)
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_ADD_INT_INT,                 \
+		&&OPCODE_SUBTRACT_INT_INT,            \
+		&&OPCODE_MULTIPLY_INT_INT,            \
+		&&OPCODE_EQUAL_INT_INT,               \
+		&&OPCODE_NOT_EQUAL_INT_INT,           \
+		&&OPCODE_LESS_INT_INT,                \
+		&&OPCODE_LESS_EQUAL_INT_INT,          \
+		&&OPCODE_GREATER_INT_INT,             \
+		&&OPCODE_GREATER_EQUAL_INT_INT,       \
+		&&OPCODE_ADD_FLOAT_FLOAT,             \
+		&&OPCODE_SUBTRACT_FLOAT_FLOAT,        \
+		&&OPCODE_MULTIPLY_FLOAT_FLOAT,        \
+		&&OPCODE_DIVIDE_FLOAT_FLOAT,          \
+		&&OPCODE_LESS_FLOAT_FLOAT,            \
+		&&OPCODE_LESS_EQUAL_FLOAT_FLOAT,      \
+		&&OPCODE_GREATER_FLOAT_FLOAT,         \
+		&&OPCODE_GREATER_EQUAL_FLOAT_FLOAT,   \
+		&&OPCODE_ADD_VECTOR2_VECTOR2,         \
+		&&OPCODE_SUBTRACT_VECTOR2_VECTOR2,    \
+		&&OPCODE_MULTIPLY_VECTOR2_VECTOR2,    \
+		&&OPCODE_MULTIPLY_VECTOR2_FLOAT,      \
+		&&OPCODE_DIVIDE_VECTOR2_FLOAT,        \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
@@ -170,6 +591,7 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_GET_NAMED,                   \
 		&&OPCODE_SET_MEMBER,                  \
 		&&OPCODE_GET_MEMBER,                  \
+		&&OPCODE_OPERATOR_MEMBER,             \
 		&&OPCODE_ASSIGN,                      \
 		&&OPCODE_ASSIGN_TRUE,                 \
 		&&OPCODE_ASSIGN_FALSE,                \
@@ -184,6 +606,8 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_CONSTRUCT_DICTIONARY,        \
 		&&OPCODE_CALL,                        \
 		&&OPCODE_CALL_RETURN,                 \
+		&&OPCODE_CALL_PTRCALL,                \
+		&&OPCODE_CALL_PTRCALL_RETURN,         \
 		&&OPCODE_CALL_BUILT_IN,               \
 		&&OPCODE_CALL_SELF,                   \
 		&&OPCODE_CALL_SELF_BASE,              \
@@ -193,10 +617,15 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_JUMP,                        \
 		&&OPCODE_JUMP_IF,                     \
 		&&OPCODE_JUMP_IF_NOT,                 \
+		&&OPCODE_JUMP_IF_NOT_COMPARE,         \
 		&&OPCODE_JUMP_TO_DEF_ARGUMENT,        \
 		&&OPCODE_RETURN,                      \
 		&&OPCODE_ITERATE_BEGIN,               \
 		&&OPCODE_ITERATE,                     \
+		&&OPCODE_ITERATE_BEGIN_INT,           \
+		&&OPCODE_ITERATE_INT,                 \
+		&&OPCODE_ITERATE_BEGIN_RANGE,         \
+		&&OPCODE_ITERATE_RANGE,               \
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
@@ -214,6 +643,7 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 #define OPCODE_SWITCH(m_test) DISPATCH_OPCODE;
 #define OPCODE_BREAK goto OPSEXIT
 #define OPCODE_OUT goto OPSOUT
+#define OPCODE_FALLTHROUGH
 #else
 #define OPCODES_TABLE
 #define OPCODE(m_op) case m_op:
@@ -224,8 +654,83 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 #define OPCODE_SWITCH(m_test) switch (m_test)
 #define OPCODE_BREAK break
 #define OPCODE_OUT break
+#define OPCODE_FALLTHROUGH FALLTHROUGH
 #endif
 
+// Reads the operands of a float opcode, which may also be ints (int constants used with floats
+// are compiled to float opcodes). At least one of them must be a float, so int with int still
+// gives an int. Ints are converted the same way Variant::evaluate() does.
+static _FORCE_INLINE_ bool _get_float_operands(const Variant *p_a, const Variant *p_b, double &r_a, double &r_b) {
+	Variant::Type type_a = p_a->get_type();
+	Variant::Type type_b = p_b->get_type();
+	if (likely(type_a == Variant::REAL && type_b == Variant::REAL)) {
+		r_a = *VariantInternal::get_real(p_a);
+		r_b = *VariantInternal::get_real(p_b);
+		return true;
+	}
+	if (type_a == Variant::REAL && type_b == Variant::INT) {
+		r_a = *VariantInternal::get_real(p_a);
+		r_b = *VariantInternal::get_int(p_b);
+		return true;
+	}
+	if (type_a == Variant::INT && type_b == Variant::REAL) {
+		r_a = *VariantInternal::get_int(p_a);
+		r_b = *VariantInternal::get_real(p_b);
+		return true;
+	}
+	return false;
+}
+
+// Operand types are still checked, anything unexpected is evaluated like OPCODE_OPERATOR.
+#define OPCODE_TYPED_OPERATOR(m_opcode, m_op, m_type_a, m_get_a, m_operator, m_type_b, m_get_b, m_set_ret)          \
+	OPCODE(m_opcode) {                                                                                              \
+		CHECK_SPACE(4);                                                                                             \
+		GET_VARIANT_PTR(a, 1);                                                                                      \
+		GET_VARIANT_PTR(b, 2);                                                                                      \
+		GET_VARIANT_PTR(dst, 3);                                                                                    \
+		if (likely(a->get_type() == Variant::m_type_a && b->get_type() == Variant::m_type_b)) {                     \
+			VariantInternal::m_set_ret(dst, *VariantInternal::m_get_a(a) m_operator * VariantInternal::m_get_b(b)); \
+		} else if (!_evaluate_operator(Variant::m_op, a, b, dst, err_text)) {                                       \
+			OPCODE_BREAK;                                                                                           \
+		}                                                                                                           \
+		ip += 4;                                                                                                    \
+	}                                                                                                               \
+	DISPATCH_OPCODE;
+
+#define OPCODE_TYPED_FLOAT_OPERATOR(m_opcode, m_op, m_operator, m_set_ret)    \
+	OPCODE(m_opcode) {                                                        \
+		CHECK_SPACE(4);                                                       \
+		GET_VARIANT_PTR(a, 1);                                                \
+		GET_VARIANT_PTR(b, 2);                                                \
+		GET_VARIANT_PTR(dst, 3);                                              \
+		double real_a, real_b;                                                \
+		if (likely(_get_float_operands(a, b, real_a, real_b))) {              \
+			VariantInternal::m_set_ret(dst, real_a m_operator real_b);        \
+		} else if (!_evaluate_operator(Variant::m_op, a, b, dst, err_text)) { \
+			OPCODE_BREAK;                                                     \
+		}                                                                     \
+		ip += 4;                                                              \
+	}                                                                         \
+	DISPATCH_OPCODE;
+
+// The float operand may also be an int constant.
+#define OPCODE_TYPED_VECTOR2_FLOAT_OPERATOR(m_opcode, m_op, m_operator)                                                   \
+	OPCODE(m_opcode) {                                                                                                    \
+		CHECK_SPACE(4);                                                                                                   \
+		GET_VARIANT_PTR(a, 1);                                                                                            \
+		GET_VARIANT_PTR(b, 2);                                                                                            \
+		GET_VARIANT_PTR(dst, 3);                                                                                          \
+		if (likely(a->get_type() == Variant::VECTOR2 && b->get_type() == Variant::REAL)) {                                \
+			VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) m_operator *VariantInternal::get_real(b)); \
+		} else if (a->get_type() == Variant::VECTOR2 && b->get_type() == Variant::INT) {                                  \
+			VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) m_operator *VariantInternal::get_int(b));  \
+		} else if (!_evaluate_operator(Variant::m_op, a, b, dst, err_text)) {                                             \
+			OPCODE_BREAK;                                                                                                 \
+		}                                                                                                                 \
+		ip += 4;                                                                                                          \
+	}                                                                                                                     \
+	DISPATCH_OPCODE;
+
 Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state) {
 	OPCODES_TABLE;
 
@@ -241,6 +746,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	Variant *stack = nullptr;
 	Variant **call_args;
 	int defarg = 0;
+	bool stack_moved = false; // the variants of the stack belong to a function state after a yield
 
 #ifdef DEBUG_ENABLED
 
@@ -255,11 +761,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	if (p_state) {
 		//use existing (supplied) state (yielded)
-		stack = (Variant *)p_state->stack.ptr();
-		call_args = (Variant **)&p_state->stack.ptr()[sizeof(Variant) * p_state->stack_size]; //ptr() to avoid bounds check
+		stack = (Variant *)p_state->stack;
+		call_args = (Variant **)&p_state->stack[sizeof(Variant) * p_state->stack_size];
 		line = p_state->line;
 		ip = p_state->ip;
-		alloca_size = p_state->stack.size();
+		alloca_size = p_state->alloca_size;
 		script = p_state->script;
 		p_instance = p_state->instance;
 		defarg = p_state->defarg;
@@ -344,6 +850,28 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 	static_ref = script;
 
+	const bool use_inline_caches = _inline_cache_count && Thread::get_caller_id() == Thread::get_main_id();
+
+	// Operand addresses are decoded once per call into a base and a bound for each address type,
+	// so most operands are a lookup instead of going through _get_variant(). The types whose variants
+	// can move or need a lookup during the call (members, class constants, globals) have no bound.
+	Variant *address_bases[ADDR_TYPE_MAX] = {};
+	uint32_t address_limits[ADDR_TYPE_MAX] = {};
+	if (p_instance) {
+		address_bases[ADDR_TYPE_SELF] = &self;
+		address_limits[ADDR_TYPE_SELF] = 1;
+	}
+	address_bases[ADDR_TYPE_CLASS] = &static_ref;
+	address_limits[ADDR_TYPE_CLASS] = 1;
+	address_bases[ADDR_TYPE_LOCAL_CONSTANT] = _constants_ptr;
+	address_limits[ADDR_TYPE_LOCAL_CONSTANT] = _constant_count;
+	address_bases[ADDR_TYPE_STACK] = stack;
+	address_limits[ADDR_TYPE_STACK] = _stack_size;
+	address_bases[ADDR_TYPE_STACK_VARIABLE] = stack;
+	address_limits[ADDR_TYPE_STACK_VARIABLE] = _stack_size;
+	address_bases[ADDR_TYPE_NIL] = &nil;
+	address_limits[ADDR_TYPE_NIL] = 1;
+
 	String err_text;
 
 #ifdef DEBUG_ENABLED
@@ -363,18 +891,34 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #define CHECK_SPACE(m_space) \
 	GD_ERR_BREAK((ip + m_space) > _code_size)
 
-#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                                   \
-	Variant *m_v;                                                                                          \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, static_ref, stack, err_text); \
-	if (unlikely(!m_v))                                                                                    \
-		OPCODE_BREAK;
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                               \
+	Variant *m_v;                                                                                      \
+	{                                                                                                  \
+		uint32_t address = _code_ptr[ip + m_code_ofs];                                                 \
+		uint32_t address_type = address >> ADDR_BITS;                                                  \
+		if (likely(address_type < ADDR_TYPE_MAX && (address & ADDR_MASK) < address_limits[address_type])) { \
+			m_v = address_bases[address_type] + (address & ADDR_MASK);                                \
+		} else {                                                                                       \
+			m_v = _get_variant(address, p_instance, script, self, static_ref, stack, err_text);        \
+			if (unlikely(!m_v))                                                                        \
+				OPCODE_BREAK;                                                                          \
+		}                                                                                              \
+	}
 
 #else
 #define GD_ERR_BREAK(m_cond)
 #define CHECK_SPACE(m_space)
-#define GET_VARIANT_PTR(m_v, m_code_ofs) \
-	Variant *m_v;                        \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, static_ref, stack, err_text);
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                               \
+	Variant *m_v;                                                                                      \
+	{                                                                                                  \
+		uint32_t address = _code_ptr[ip + m_code_ofs];                                                 \
+		uint32_t address_type = address >> ADDR_BITS;                                                 \
+		if (likely(address_type < ADDR_TYPE_MAX && (address & ADDR_MASK) < address_limits[address_type])) { \
+			m_v = address_bases[address_type] + (address & ADDR_MASK);                                \
+		} else {                                                                                       \
+			m_v = _get_variant(address, p_instance, script, self, static_ref, stack, err_text);        \
+		}                                                                                              \
+	}
 
 #endif
 
@@ -389,6 +933,12 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		profile.call_count++;
 		profile.frame_call_count++;
 	}
+
+	// The sampler reads the current line through the frame, so lines cost nothing more.
+	GDScriptSamplingProfiler::ThreadStack *sampling_stack = nullptr;
+	if (GDScriptSamplingProfiler::is_active()) {
+		sampling_stack = GDScriptSamplingProfiler::enter_function(this, &line);
+	}
 	bool exit_ok = false;
 	bool yielded = false;
 #endif
@@ -436,6 +986,45 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE_TYPED_OPERATOR(OPCODE_ADD_INT_INT, OP_ADD, INT, get_int, +, INT, get_int, set_int)
+			OPCODE_TYPED_OPERATOR(OPCODE_SUBTRACT_INT_INT, OP_SUBTRACT, INT, get_int, -, INT, get_int, set_int)
+			OPCODE_TYPED_OPERATOR(OPCODE_MULTIPLY_INT_INT, OP_MULTIPLY, INT, get_int, *, INT, get_int, set_int)
+			OPCODE_TYPED_OPERATOR(OPCODE_EQUAL_INT_INT, OP_EQUAL, INT, get_int, ==, INT, get_int, set_bool)
+			OPCODE_TYPED_OPERATOR(OPCODE_NOT_EQUAL_INT_INT, OP_NOT_EQUAL, INT, get_int, !=, INT, get_int, set_bool)
+			OPCODE_TYPED_OPERATOR(OPCODE_LESS_INT_INT, OP_LESS, INT, get_int, <, INT, get_int, set_bool)
+			OPCODE_TYPED_OPERATOR(OPCODE_LESS_EQUAL_INT_INT, OP_LESS_EQUAL, INT, get_int, <=, INT, get_int, set_bool)
+			OPCODE_TYPED_OPERATOR(OPCODE_GREATER_INT_INT, OP_GREATER, INT, get_int, >, INT, get_int, set_bool)
+			OPCODE_TYPED_OPERATOR(OPCODE_GREATER_EQUAL_INT_INT, OP_GREATER_EQUAL, INT, get_int, >=, INT, get_int, set_bool)
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_ADD_FLOAT_FLOAT, OP_ADD, +, set_real)
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_SUBTRACT_FLOAT_FLOAT, OP_SUBTRACT, -, set_real)
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_MULTIPLY_FLOAT_FLOAT, OP_MULTIPLY, *, set_real)
+
+			OPCODE(OPCODE_DIVIDE_FLOAT_FLOAT) {
+				CHECK_SPACE(4);
+				GET_VARIANT_PTR(a, 1);
+				GET_VARIANT_PTR(b, 2);
+				GET_VARIANT_PTR(dst, 3);
+				// division by zero is reported by the generic path
+				double real_a, real_b;
+				if (likely(_get_float_operands(a, b, real_a, real_b) && real_b != 0.0)) {
+					VariantInternal::set_real(dst, real_a / real_b);
+				} else if (!_evaluate_operator(Variant::OP_DIVIDE, a, b, dst, err_text)) {
+					OPCODE_BREAK;
+				}
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_LESS_FLOAT_FLOAT, OP_LESS, <, set_bool)
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_LESS_EQUAL_FLOAT_FLOAT, OP_LESS_EQUAL, <=, set_bool)
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_GREATER_FLOAT_FLOAT, OP_GREATER, >, set_bool)
+			OPCODE_TYPED_FLOAT_OPERATOR(OPCODE_GREATER_EQUAL_FLOAT_FLOAT, OP_GREATER_EQUAL, >=, set_bool)
+			OPCODE_TYPED_OPERATOR(OPCODE_ADD_VECTOR2_VECTOR2, OP_ADD, VECTOR2, get_vector2, +, VECTOR2, get_vector2, set_vector2)
+			OPCODE_TYPED_OPERATOR(OPCODE_SUBTRACT_VECTOR2_VECTOR2, OP_SUBTRACT, VECTOR2, get_vector2, -, VECTOR2, get_vector2, set_vector2)
+			OPCODE_TYPED_OPERATOR(OPCODE_MULTIPLY_VECTOR2_VECTOR2, OP_MULTIPLY, VECTOR2, get_vector2, *, VECTOR2, get_vector2, set_vector2)
+			OPCODE_TYPED_VECTOR2_FLOAT_OPERATOR(OPCODE_MULTIPLY_VECTOR2_FLOAT, OP_MULTIPLY, *)
+			OPCODE_TYPED_VECTOR2_FLOAT_OPERATOR(OPCODE_DIVIDE_VECTOR2_FLOAT, OP_DIVIDE, /)
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 				CHECK_SPACE(4);
 
@@ -574,18 +1163,23 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_SET_NAMED) {
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(dst, 1);
-				GET_VARIANT_PTR(value, 3);
+				GET_VARIANT_PTR(value, 4);
 
 				int indexname = _code_ptr[ip + 2];
 
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_cache_count);
+
 				bool valid;
-				dst->set_named(*index, *value, &valid);
+				if (!use_inline_caches || !_set_named_cached(_inline_caches_ptr[cache_idx], dst, *index, value, valid)) {
+					dst->set_named(*index, *value, &valid);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -594,21 +1188,29 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(src, 1);
-				GET_VARIANT_PTR(dst, 3);
+				GET_VARIANT_PTR(dst, 4);
 
 				int indexname = _code_ptr[ip + 2];
 
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_cache_count);
+
+				if (use_inline_caches && _get_named_cached(_inline_caches_ptr[cache_idx], src, *index, dst)) {
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
@@ -628,7 +1230,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -676,6 +1278,43 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_MEMBER) {
+				CHECK_SPACE(4);
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+				int indexname = _code_ptr[ip + 2];
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				const StringName *index = &_global_names_ptr[indexname];
+				GET_VARIANT_PTR(value, 3);
+
+				Variant member;
+				Variant result;
+				bool valid;
+#ifndef DEBUG_ENABLED
+				ClassDB::get_property(p_instance->owner, *index, member);
+				Variant::evaluate(op, member, *value, result, valid);
+				ClassDB::set_property(p_instance->owner, *index, result, &valid);
+#else
+				if (!ClassDB::get_property(p_instance->owner, *index, member)) {
+					err_text = "Internal error getting property: " + String(*index);
+					OPCODE_BREAK;
+				}
+				if (!_evaluate_operator(op, &member, value, &result, err_text)) {
+					OPCODE_BREAK;
+				}
+				bool ok = ClassDB::set_property(p_instance->owner, *index, result, &valid);
+				if (!ok) {
+					err_text = "Internal error setting property: " + String(*index);
+					OPCODE_BREAK;
+				} else if (!valid) {
+					err_text = "Error setting property '" + String(*index) + "' with value of type " + Variant::get_type_name(result.get_type()) + ".";
+					OPCODE_BREAK;
+				}
+#endif
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_ASSIGN) {
 				CHECK_SPACE(3);
 				GET_VARIANT_PTR(dst, 1);
@@ -987,10 +1626,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_CALL_PTRCALL)
+			OPCODE(OPCODE_CALL_PTRCALL_RETURN)
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
-				CHECK_SPACE(4);
-				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN;
+				CHECK_SPACE(5);
+				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN || _code_ptr[ip] == OPCODE_CALL_PTRCALL_RETURN;
+				bool ptrcall = _code_ptr[ip] == OPCODE_CALL_PTRCALL || _code_ptr[ip] == OPCODE_CALL_PTRCALL_RETURN;
 
 				int argc = _code_ptr[ip + 1];
 				GET_VARIANT_PTR(base, 2);
@@ -999,8 +1641,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
 
+				int cache_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_cache_count);
+
 				GD_ERR_BREAK(argc < 0);
-				ip += 4;
+				ip += 5;
 				CHECK_SPACE(argc + 1);
 				Variant **argptrs = call_args;
 
@@ -1018,11 +1663,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #endif
 				Variant::CallError err;
+				Variant *ret = nullptr;
 				if (call_ret) {
-					GET_VARIANT_PTR(ret, argc);
+					GET_VARIANT_PTR(r, argc);
+					ret = r;
+				}
+				if (!use_inline_caches || !_call_cached(_inline_caches_ptr[cache_idx], base, *methodname, (const Variant **)argptrs, argc, ret, err, ptrcall)) {
 					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
-				} else {
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, nullptr, err);
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -1193,27 +1840,39 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Ref<GDScriptFunctionState> gdfs = memnew(GDScriptFunctionState);
 				gdfs->function = this;
 
-				gdfs->state.stack.resize(alloca_size);
-				//copy variant stack
-				for (int i = 0; i < _stack_size; i++) {
-					memnew_placement(&gdfs->state.stack.write[sizeof(Variant) * i], Variant(stack[i]));
+				// Variants can be moved with a plain copy, so the stack is moved to the state instead of
+				// being copied and destroyed. A resumed call hands over the stack it got from its state.
+				if (p_state) {
+					gdfs->state.stack = p_state->stack;
+					p_state->stack = nullptr;
+					p_state->stack_size = 0;
+				} else {
+					gdfs->state.stack = _alloc_state_stack();
+					if (_stack_size) {
+						memcpy((void *)gdfs->state.stack, (const void *)stack, sizeof(Variant) * _stack_size);
+					}
 				}
+				stack_moved = true;
 				gdfs->state.stack_size = _stack_size;
 				gdfs->state.self = self;
 				gdfs->state.alloca_size = alloca_size;
 				gdfs->state.ip = ip + ipofs;
 				gdfs->state.line = line;
 				gdfs->state.script = _script;
-				GDScriptLanguage::singleton->lock.lock();
+				gdfs->state.instance = p_instance;
 
-				_script->pending_func_states.add(&gdfs->scripts_list);
+				{
+					SpinLock &script_lock = GDScriptLanguage::singleton->get_func_state_lock(_script);
+					script_lock.lock();
+					_script->pending_func_states.add(&gdfs->scripts_list);
+					script_lock.unlock();
+				}
 				if (p_instance) {
-					gdfs->state.instance = p_instance;
+					SpinLock &instance_lock = GDScriptLanguage::singleton->get_func_state_lock(p_instance);
+					instance_lock.lock();
 					p_instance->pending_func_states.add(&gdfs->instances_list);
-				} else {
-					gdfs->state.instance = nullptr;
+					instance_lock.unlock();
 				}
-				GDScriptLanguage::singleton->lock.unlock();
 #ifdef DEBUG_ENABLED
 				gdfs->state.function_name = name;
 				gdfs->state.script_path = _script->get_path();
@@ -1331,6 +1990,37 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_JUMP_IF_NOT_COMPARE) {
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op < Variant::OP_EQUAL || op > Variant::OP_GREATER_EQUAL);
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+
+				bool result;
+				if (a->get_type() == Variant::INT && b->get_type() == Variant::INT) {
+					result = _compare(op, *VariantInternal::get_int(a), *VariantInternal::get_int(b));
+				} else if (a->get_type() == Variant::REAL && b->get_type() == Variant::REAL) {
+					result = _compare(op, *VariantInternal::get_real(a), *VariantInternal::get_real(b));
+				} else {
+					Variant ret;
+					if (!_evaluate_operator(op, a, b, &ret, err_text)) {
+						OPCODE_BREAK;
+					}
+					result = ret.booleanize();
+				}
+
+				if (!result) {
+					int to = _code_ptr[ip + 4];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 5;
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT) {
 				CHECK_SPACE(2);
 				ip = _default_arg_ptr[defarg];
@@ -1347,6 +2037,29 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				OPCODE_BREAK;
 			}
 
+			OPCODE(OPCODE_ITERATE_BEGIN_INT) {
+				CHECK_SPACE(8); //space for this a regular iterate
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				if (likely(container->get_type() == Variant::INT)) {
+					if (*VariantInternal::get_int(container) <= 0) {
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						GET_VARIANT_PTR(iterator, 4);
+
+						VariantInternal::set_int(counter, 0);
+						VariantInternal::set_int(iterator, 0);
+						ip += 5; //skip regular iterate which is always next
+					}
+					DISPATCH_OPCODE;
+				}
+			}
+			OPCODE_FALLTHROUGH; // not an int after all, iterate it like any other container
+
 			OPCODE(OPCODE_ITERATE_BEGIN) {
 				CHECK_SPACE(8); //space for this a regular iterate
 
@@ -1379,6 +2092,94 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_ITERATE_INT) {
+				CHECK_SPACE(4);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				if (likely(container->get_type() == Variant::INT && counter->get_type() == Variant::INT)) {
+					int64_t idx = *VariantInternal::get_int(counter) + 1;
+					if (idx >= *VariantInternal::get_int(container)) {
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						GET_VARIANT_PTR(iterator, 4);
+
+						VariantInternal::set_int(counter, idx);
+						VariantInternal::set_int(iterator, idx);
+						ip += 5; //loop again
+					}
+					DISPATCH_OPCODE;
+				}
+			}
+			OPCODE_FALLTHROUGH;
+
+			OPCODE(OPCODE_ITERATE_BEGIN_RANGE) {
+				CHECK_SPACE(12); //space for this and the range iterate
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(from, 2);
+				GET_VARIANT_PTR(to, 3);
+				GET_VARIANT_PTR(step, 4);
+
+#ifdef DEBUG_ENABLED
+				if (!from->is_num() || !to->is_num() || !step->is_num()) {
+					err_text = "Arguments of range() must be numbers.";
+					OPCODE_BREAK;
+				}
+#endif
+				int64_t idx = *from;
+				int64_t end = *to;
+				int64_t incr = *step;
+#ifdef DEBUG_ENABLED
+				if (incr == 0) {
+					err_text = "Step argument of range() is zero.";
+					OPCODE_BREAK;
+				}
+#endif
+				// to and step are in slots of their own, OPCODE_ITERATE_RANGE reads them as ints.
+				VariantInternal::set_int(to, end);
+				VariantInternal::set_int(step, incr);
+
+				if (incr > 0 ? idx >= end : (incr == 0 || idx <= end)) {
+					int jumpto = _code_ptr[ip + 5];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 6);
+
+					VariantInternal::set_int(counter, idx);
+					VariantInternal::set_int(iterator, idx);
+					ip += 7; //skip the range iterate which is always next
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_RANGE) {
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(to, 2);
+				GET_VARIANT_PTR(step, 3);
+
+				int64_t incr = *VariantInternal::get_int(step);
+				int64_t idx = *VariantInternal::get_int(counter) + incr;
+				if (incr > 0 ? idx >= *VariantInternal::get_int(to) : idx <= *VariantInternal::get_int(to)) {
+					int jumpto = _code_ptr[ip + 4];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 5);
+
+					VariantInternal::set_int(counter, idx);
+					VariantInternal::set_int(iterator, idx);
+					ip += 6; //loop again
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_ITERATE) {
 				CHECK_SPACE(4);
 
@@ -1531,6 +2332,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	OPCODES_OUT
 #ifdef DEBUG_ENABLED
+	if (sampling_stack) {
+		GDScriptSamplingProfiler::exit_function(sampling_stack);
+	}
+
 	if (GDScriptLanguage::get_singleton()->profiling) {
 		uint64_t time_taken = OS::get_singleton()->get_ticks_usec() - function_start_time;
 		profile.total_time += time_taken;
@@ -1550,7 +2355,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		}
 #endif
 
-		if (_stack_size) {
+		if (_stack_size && !stack_moved) {
 			//free stack
 			for (int i = 0; i < _stack_size; i++) {
 				stack[i].~Variant();
@@ -1581,6 +2386,252 @@ StringName GDScriptFunction::get_global_name(int p_idx) const {
 	return global_names[p_idx];
 }
 
+int GDScriptFunction::get_inline_cache_count() const {
+	return _inline_cache_count;
+}
+
+static const struct {
+	GDScriptFunction::Opcode opcode;
+	Variant::Operator op;
+	Variant::Type type_a;
+	Variant::Type type_b;
+} _typed_operators[] = {
+	{ GDScriptFunction::OPCODE_ADD_INT_INT, Variant::OP_ADD, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_SUBTRACT_INT_INT, Variant::OP_SUBTRACT, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_MULTIPLY_INT_INT, Variant::OP_MULTIPLY, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_EQUAL_INT_INT, Variant::OP_EQUAL, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_NOT_EQUAL_INT_INT, Variant::OP_NOT_EQUAL, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_LESS_INT_INT, Variant::OP_LESS, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_LESS_EQUAL_INT_INT, Variant::OP_LESS_EQUAL, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_GREATER_INT_INT, Variant::OP_GREATER, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_GREATER_EQUAL_INT_INT, Variant::OP_GREATER_EQUAL, Variant::INT, Variant::INT },
+	{ GDScriptFunction::OPCODE_ADD_FLOAT_FLOAT, Variant::OP_ADD, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_SUBTRACT_FLOAT_FLOAT, Variant::OP_SUBTRACT, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_MULTIPLY_FLOAT_FLOAT, Variant::OP_MULTIPLY, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_DIVIDE_FLOAT_FLOAT, Variant::OP_DIVIDE, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_LESS_FLOAT_FLOAT, Variant::OP_LESS, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_LESS_EQUAL_FLOAT_FLOAT, Variant::OP_LESS_EQUAL, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_GREATER_FLOAT_FLOAT, Variant::OP_GREATER, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_GREATER_EQUAL_FLOAT_FLOAT, Variant::OP_GREATER_EQUAL, Variant::REAL, Variant::REAL },
+	{ GDScriptFunction::OPCODE_ADD_VECTOR2_VECTOR2, Variant::OP_ADD, Variant::VECTOR2, Variant::VECTOR2 },
+	{ GDScriptFunction::OPCODE_SUBTRACT_VECTOR2_VECTOR2, Variant::OP_SUBTRACT, Variant::VECTOR2, Variant::VECTOR2 },
+	{ GDScriptFunction::OPCODE_MULTIPLY_VECTOR2_VECTOR2, Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::VECTOR2 },
+	{ GDScriptFunction::OPCODE_MULTIPLY_VECTOR2_FLOAT, Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::REAL },
+	{ GDScriptFunction::OPCODE_DIVIDE_VECTOR2_FLOAT, Variant::OP_DIVIDE, Variant::VECTOR2, Variant::REAL },
+};
+
+GDScriptFunction::Opcode GDScriptFunction::get_typed_operator_opcode(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b) {
+	for (uint32_t i = 0; i < sizeof(_typed_operators) / sizeof(_typed_operators[0]); i++) {
+		if (_typed_operators[i].op == p_op && _typed_operators[i].type_a == p_type_a && _typed_operators[i].type_b == p_type_b) {
+			return _typed_operators[i].opcode;
+		}
+	}
+	return OPCODE_OPERATOR;
+}
+
+Variant::Operator GDScriptFunction::get_typed_operator(Opcode p_opcode) {
+	for (uint32_t i = 0; i < sizeof(_typed_operators) / sizeof(_typed_operators[0]); i++) {
+		if (_typed_operators[i].opcode == p_opcode) {
+			return _typed_operators[i].op;
+		}
+	}
+	return Variant::OP_MAX;
+}
+
+// Follows the operand layout of every opcode in call(), keep both in sync.
+bool GDScriptFunction::get_address_operands(LocalVector<int> &r_positions) const {
+	const int *c = code.ptr();
+	int size = code.size();
+	int ip = 0;
+
+#define ADDRESS(m_ofs) r_positions.push_back(ip + (m_ofs))
+
+	while (ip < size) {
+		int len;
+		switch (c[ip]) {
+			case OPCODE_OPERATOR:
+			case OPCODE_JUMP_IF_NOT_COMPARE: {
+				len = 5;
+				ADDRESS(2);
+				ADDRESS(3);
+				if (c[ip] == OPCODE_OPERATOR) {
+					ADDRESS(4); // The other one is the jump.
+				}
+			} break;
+			case OPCODE_ADD_INT_INT:
+			case OPCODE_SUBTRACT_INT_INT:
+			case OPCODE_MULTIPLY_INT_INT:
+			case OPCODE_EQUAL_INT_INT:
+			case OPCODE_NOT_EQUAL_INT_INT:
+			case OPCODE_LESS_INT_INT:
+			case OPCODE_LESS_EQUAL_INT_INT:
+			case OPCODE_GREATER_INT_INT:
+			case OPCODE_GREATER_EQUAL_INT_INT:
+			case OPCODE_ADD_FLOAT_FLOAT:
+			case OPCODE_SUBTRACT_FLOAT_FLOAT:
+			case OPCODE_MULTIPLY_FLOAT_FLOAT:
+			case OPCODE_DIVIDE_FLOAT_FLOAT:
+			case OPCODE_LESS_FLOAT_FLOAT:
+			case OPCODE_LESS_EQUAL_FLOAT_FLOAT:
+			case OPCODE_GREATER_FLOAT_FLOAT:
+			case OPCODE_GREATER_EQUAL_FLOAT_FLOAT:
+			case OPCODE_ADD_VECTOR2_VECTOR2:
+			case OPCODE_SUBTRACT_VECTOR2_VECTOR2:
+			case OPCODE_MULTIPLY_VECTOR2_VECTOR2:
+			case OPCODE_MULTIPLY_VECTOR2_FLOAT:
+			case OPCODE_DIVIDE_VECTOR2_FLOAT:
+			case OPCODE_EXTENDS_TEST:
+			case OPCODE_SET:
+			case OPCODE_GET:
+			case OPCODE_ASSIGN_TYPED_NATIVE:
+			case OPCODE_ASSIGN_TYPED_SCRIPT:
+			case OPCODE_CAST_TO_NATIVE:
+			case OPCODE_CAST_TO_SCRIPT: {
+				len = 4;
+				ADDRESS(1);
+				ADDRESS(2);
+				ADDRESS(3);
+			} break;
+			case OPCODE_IS_BUILTIN: {
+				len = 4;
+				ADDRESS(1);
+				ADDRESS(3);
+			} break;
+			case OPCODE_ASSIGN_TYPED_BUILTIN:
+			case OPCODE_CAST_TO_BUILTIN: {
+				len = 4;
+				ADDRESS(2);
+				ADDRESS(3);
+			} break;
+			case OPCODE_SET_NAMED:
+			case OPCODE_GET_NAMED: {
+				len = 5;
+				ADDRESS(1);
+				ADDRESS(4);
+			} break;
+			case OPCODE_SET_MEMBER:
+			case OPCODE_GET_MEMBER: {
+				len = 3;
+				ADDRESS(2);
+			} break;
+			case OPCODE_OPERATOR_MEMBER: {
+				len = 4;
+				ADDRESS(3);
+			} break;
+			case OPCODE_ASSIGN:
+			case OPCODE_JUMP_IF:
+			case OPCODE_JUMP_IF_NOT:
+			case OPCODE_ASSERT: {
+				len = 3;
+				ADDRESS(1);
+				if (c[ip] == OPCODE_ASSIGN || c[ip] == OPCODE_ASSERT) {
+					ADDRESS(2); // Otherwise the jump.
+				}
+			} break;
+			case OPCODE_ASSIGN_TRUE:
+			case OPCODE_ASSIGN_FALSE:
+			case OPCODE_YIELD_RESUME:
+			case OPCODE_RETURN: {
+				len = 2;
+				ADDRESS(1);
+			} break;
+			case OPCODE_CONSTRUCT:
+			case OPCODE_CALL_BUILT_IN:
+			case OPCODE_CALL_SELF_BASE: {
+				// Type, function or name, argument count, arguments and destination.
+				if (ip + 2 >= size) {
+					return false;
+				}
+				int argc = c[ip + 2];
+				len = 4 + argc;
+				for (int i = 0; i <= argc; i++) {
+					ADDRESS(3 + i);
+				}
+			} break;
+			case OPCODE_CONSTRUCT_ARRAY:
+			case OPCODE_CONSTRUCT_DICTIONARY: {
+				if (ip + 1 >= size) {
+					return false;
+				}
+				int argc = c[ip + 1] * (c[ip] == OPCODE_CONSTRUCT_DICTIONARY ? 2 : 1);
+				len = 3 + argc;
+				for (int i = 0; i <= argc; i++) {
+					ADDRESS(2 + i);
+				}
+			} break;
+			case OPCODE_CALL:
+			case OPCODE_CALL_RETURN:
+			case OPCODE_CALL_PTRCALL:
+			case OPCODE_CALL_PTRCALL_RETURN: {
+				// Argument count, base, name, inline cache, arguments and destination.
+				if (ip + 1 >= size) {
+					return false;
+				}
+				int argc = c[ip + 1];
+				len = 6 + argc;
+				ADDRESS(2);
+				for (int i = 0; i <= argc; i++) {
+					ADDRESS(5 + i);
+				}
+			} break;
+			case OPCODE_YIELD:
+			case OPCODE_JUMP_TO_DEF_ARGUMENT:
+			case OPCODE_BREAKPOINT:
+			case OPCODE_END: {
+				len = 1;
+			} break;
+			case OPCODE_YIELD_SIGNAL: {
+				len = 3;
+				ADDRESS(1);
+				ADDRESS(2);
+			} break;
+			case OPCODE_JUMP:
+			case OPCODE_LINE: {
+				len = 2;
+			} break;
+			case OPCODE_ITERATE_BEGIN:
+			case OPCODE_ITERATE:
+			case OPCODE_ITERATE_BEGIN_INT:
+			case OPCODE_ITERATE_INT: {
+				// Counter, container, exit, iterator.
+				len = 5;
+				ADDRESS(1);
+				ADDRESS(2);
+				ADDRESS(4);
+			} break;
+			case OPCODE_ITERATE_BEGIN_RANGE: {
+				// Counter, from, to, step, exit, iterator.
+				len = 7;
+				ADDRESS(1);
+				ADDRESS(2);
+				ADDRESS(3);
+				ADDRESS(4);
+				ADDRESS(6);
+			} break;
+			case OPCODE_ITERATE_RANGE: {
+				// Counter, to, step, exit, iterator.
+				len = 6;
+				ADDRESS(1);
+				ADDRESS(2);
+				ADDRESS(3);
+				ADDRESS(5);
+			} break;
+			default: {
+				return false;
+			}
+		}
+
+		if (len < 1 || ip + len > size) {
+			return false;
+		}
+		ip += len;
+	}
+
+#undef ADDRESS
+
+	return true;
+}
+
 int GDScriptFunction::get_default_argument_count() const {
 	return _default_arg_count;
 }
@@ -1673,6 +2724,8 @@ GDScriptFunction::GDScriptFunction() :
 		function_list(this) {
 	_stack_size = 0;
 	_call_size = 0;
+	_inline_caches_ptr = nullptr;
+	_inline_cache_count = 0;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
 	_func_cname = nullptr;
@@ -1690,11 +2743,58 @@ GDScriptFunction::GDScriptFunction() :
 	profile.last_frame_call_count = 0;
 	profile.last_frame_self_time = 0;
 	profile.last_frame_total_time = 0;
+	profile.inline_cache_hits = 0;
+	profile.inline_cache_misses = 0;
+	profile.frame_inline_cache_hits = 0;
+	profile.frame_inline_cache_misses = 0;
+	profile.last_frame_inline_cache_hits = 0;
+	profile.last_frame_inline_cache_misses = 0;
 
 #endif
 }
 
+uint8_t *GDScriptFunction::_alloc_state_stack() {
+	uint32_t size = sizeof(Variant *) * _call_size + sizeof(Variant) * _stack_size;
+	if (size == 0) {
+		return nullptr;
+	}
+
+	state_stack_lock.lock();
+	if (state_stack_pool.size()) {
+		uint8_t *stack = state_stack_pool[state_stack_pool.size() - 1];
+		state_stack_pool.resize(state_stack_pool.size() - 1);
+		state_stack_lock.unlock();
+		return stack;
+	}
+	state_stack_lock.unlock();
+
+	return (uint8_t *)memalloc(size);
+}
+
+void GDScriptFunction::_free_state_stack(uint8_t *p_stack) {
+	if (!p_stack) {
+		return;
+	}
+
+	state_stack_lock.lock();
+	if (state_stack_pool.size() < STATE_STACK_POOL_MAX) {
+		state_stack_pool.push_back(p_stack);
+		state_stack_lock.unlock();
+		return;
+	}
+	state_stack_lock.unlock();
+
+	memfree(p_stack);
+}
+
 GDScriptFunction::~GDScriptFunction() {
+	// Inline caches in other functions may point to this one.
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
+	for (uint32_t i = 0; i < state_stack_pool.size(); i++) {
+		memfree(state_stack_pool[i]);
+	}
+
 #ifdef DEBUG_ENABLED
 	GDScriptLanguage::get_singleton()->lock.lock();
 	GDScriptLanguage::get_singleton()->function_list.remove(&function_list);
@@ -1742,16 +2842,23 @@ bool GDScriptFunctionState::is_valid(bool p_extended_check) const {
 	}
 
 	if (p_extended_check) {
-#ifndef NO_THREADS
-		MutexLock lock(GDScriptLanguage::get_singleton()->lock);
-#endif
 		// Script gone?
-		if (!scripts_list.in_list()) {
+		SpinLock &script_lock = GDScriptLanguage::get_singleton()->get_func_state_lock(state.script);
+		script_lock.lock();
+		bool script_valid = scripts_list.in_list();
+		script_lock.unlock();
+		if (!script_valid) {
 			return false;
 		}
 		// Class instance gone? (if not static function)
-		if (state.instance && !instances_list.in_list()) {
-			return false;
+		if (state.instance) {
+			SpinLock &instance_lock = GDScriptLanguage::get_singleton()->get_func_state_lock(state.instance);
+			instance_lock.lock();
+			bool instance_valid = instances_list.in_list();
+			instance_lock.unlock();
+			if (!instance_valid) {
+				return false;
+			}
 		}
 	}
 
@@ -1761,32 +2868,42 @@ bool GDScriptFunctionState::is_valid(bool p_extended_check) const {
 Variant GDScriptFunctionState::resume(const Variant &p_arg) {
 	ERR_FAIL_COND_V(!function, Variant());
 	{
-#ifndef NO_THREADS
-		MutexLock lock(GDScriptLanguage::singleton->lock);
-#endif
-		if (!scripts_list.in_list()) {
+		// The lists are only checked and left here, a state is never added to them again.
+		SpinLock &script_lock = GDScriptLanguage::singleton->get_func_state_lock(state.script);
+		script_lock.lock();
+		bool script_valid = scripts_list.in_list();
+		scripts_list.remove_from_list();
+		script_lock.unlock();
+		if (!script_valid) {
 #ifdef DEBUG_ENABLED
 			ERR_FAIL_V_MSG(Variant(), "Resumed function '" + state.function_name + "()' after yield, but script is gone. At script: " + state.script_path + ":" + itos(state.line));
 #else
 			return Variant();
 #endif
 		}
-		if (state.instance && !instances_list.in_list()) {
+		if (state.instance) {
+			SpinLock &instance_lock = GDScriptLanguage::singleton->get_func_state_lock(state.instance);
+			instance_lock.lock();
+			bool instance_valid = instances_list.in_list();
+			instances_list.remove_from_list();
+			instance_lock.unlock();
+			if (!instance_valid) {
 #ifdef DEBUG_ENABLED
-			ERR_FAIL_V_MSG(Variant(), "Resumed function '" + state.function_name + "()' after yield, but class instance is gone. At script: " + state.script_path + ":" + itos(state.line));
+				ERR_FAIL_V_MSG(Variant(), "Resumed function '" + state.function_name + "()' after yield, but class instance is gone. At script: " + state.script_path + ":" + itos(state.line));
 #else
-			return Variant();
+				return Variant();
 #endif
+			}
 		}
-		// Do these now to avoid locking again after the call
-		scripts_list.remove_from_list();
-		instances_list.remove_from_list();
 	}
 
 	state.result = p_arg;
 	Variant::CallError err;
 	Variant ret = function->call(nullptr, nullptr, 0, err, &state);
 
+	// Unless the call yielded again and took it, the stack goes back to the function for its next yield.
+	_release_stack(function);
+
 	bool completed = true;
 
 	// If the return value is a GDScriptFunctionState reference,
@@ -1820,13 +2937,26 @@ Variant GDScriptFunctionState::resume(const Variant &p_arg) {
 }
 
 void GDScriptFunctionState::_clear_stack() {
+	_release_stack(nullptr);
+}
+
+void GDScriptFunctionState::_release_stack(GDScriptFunction *p_function) {
 	if (state.stack_size) {
-		Variant *stack = (Variant *)state.stack.ptr();
+		Variant *stack = (Variant *)state.stack;
 		for (int i = 0; i < state.stack_size; i++) {
 			stack[i].~Variant();
 		}
 		state.stack_size = 0;
 	}
+
+	if (state.stack) {
+		if (p_function) {
+			p_function->_free_state_stack(state.stack);
+		} else {
+			memfree(state.stack);
+		}
+		state.stack = nullptr;
+	}
 }
 
 void GDScriptFunctionState::_bind_methods() {
@@ -1841,12 +2971,23 @@ GDScriptFunctionState::GDScriptFunctionState() :
 		scripts_list(this),
 		instances_list(this) {
 	function = nullptr;
+	state.script = nullptr;
+	state.instance = nullptr;
+	state.stack = nullptr;
+	state.stack_size = 0;
 }
 
 GDScriptFunctionState::~GDScriptFunctionState() {
-	_clear_stack();
-	GDScriptLanguage::singleton->lock.lock();
+	// Leave the lists first, so clearing the pending states of a script or instance won't find this one.
+	SpinLock &script_lock = GDScriptLanguage::singleton->get_func_state_lock(state.script);
+	script_lock.lock();
 	scripts_list.remove_from_list();
+	script_lock.unlock();
+
+	SpinLock &instance_lock = GDScriptLanguage::singleton->get_func_state_lock(state.instance);
+	instance_lock.lock();
 	instances_list.remove_from_list();
-	GDScriptLanguage::singleton->lock.unlock();
+	instance_lock.unlock();
+
+	_clear_stack();
 }
@@ -6,6 +6,8 @@
 #ifndef GDSCRIPT_FUNCTION_H
 #define GDSCRIPT_FUNCTION_H
 
+#include "core/local_vector.h"
+#include "core/os/spin_lock.h"
 #include "core/os/thread.h"
 #include "core/pair.h"
 #include "core/reference.h"
@@ -135,6 +137,29 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		// OPCODE_OPERATOR specialized for operand types known at compile time (no operator operand).
+		OPCODE_ADD_INT_INT,
+		OPCODE_SUBTRACT_INT_INT,
+		OPCODE_MULTIPLY_INT_INT,
+		OPCODE_EQUAL_INT_INT,
+		OPCODE_NOT_EQUAL_INT_INT,
+		OPCODE_LESS_INT_INT,
+		OPCODE_LESS_EQUAL_INT_INT,
+		OPCODE_GREATER_INT_INT,
+		OPCODE_GREATER_EQUAL_INT_INT,
+		OPCODE_ADD_FLOAT_FLOAT,
+		OPCODE_SUBTRACT_FLOAT_FLOAT,
+		OPCODE_MULTIPLY_FLOAT_FLOAT,
+		OPCODE_DIVIDE_FLOAT_FLOAT,
+		OPCODE_LESS_FLOAT_FLOAT,
+		OPCODE_LESS_EQUAL_FLOAT_FLOAT,
+		OPCODE_GREATER_FLOAT_FLOAT,
+		OPCODE_GREATER_EQUAL_FLOAT_FLOAT,
+		OPCODE_ADD_VECTOR2_VECTOR2,
+		OPCODE_SUBTRACT_VECTOR2_VECTOR2,
+		OPCODE_MULTIPLY_VECTOR2_VECTOR2,
+		OPCODE_MULTIPLY_VECTOR2_FLOAT,
+		OPCODE_DIVIDE_VECTOR2_FLOAT,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
@@ -143,6 +168,7 @@ public:
 		OPCODE_GET_NAMED,
 		OPCODE_SET_MEMBER,
 		OPCODE_GET_MEMBER,
+		OPCODE_OPERATOR_MEMBER, // get, operate and set a property of self, for compound assignments (position += v)
 		OPCODE_ASSIGN,
 		OPCODE_ASSIGN_TRUE,
 		OPCODE_ASSIGN_FALSE,
@@ -157,6 +183,8 @@ public:
 		OPCODE_CONSTRUCT_DICTIONARY,
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
+		OPCODE_CALL_PTRCALL, // same operands as OPCODE_CALL, for native methods with known argument types
+		OPCODE_CALL_PTRCALL_RETURN,
 		OPCODE_CALL_BUILT_IN,
 		OPCODE_CALL_SELF,
 		OPCODE_CALL_SELF_BASE,
@@ -166,10 +194,15 @@ public:
 		OPCODE_JUMP,
 		OPCODE_JUMP_IF,
 		OPCODE_JUMP_IF_NOT,
+		OPCODE_JUMP_IF_NOT_COMPARE, // comparison (operator, a, b) fused with the jump, the result isn't stored
 		OPCODE_JUMP_TO_DEF_ARGUMENT,
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_BEGIN_INT, // same operands as OPCODE_ITERATE_BEGIN, for containers known to be int
+		OPCODE_ITERATE_INT,
+		OPCODE_ITERATE_BEGIN_RANGE, // range() with its arguments: counter, from, to, step, exit address, iterator
+		OPCODE_ITERATE_RANGE, // counter, to, step, exit address, iterator
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
@@ -189,7 +222,8 @@ public:
 		ADDR_TYPE_STACK_VARIABLE = 6,
 		ADDR_TYPE_GLOBAL = 7,
 		ADDR_TYPE_NAMED_GLOBAL = 8,
-		ADDR_TYPE_NIL = 9
+		ADDR_TYPE_NIL = 9,
+		ADDR_TYPE_MAX
 	};
 
 	struct StackDebug {
@@ -199,8 +233,45 @@ public:
 		StringName identifier;
 	};
 
+	// Monomorphic inline cache, one per OPCODE_CALL, OPCODE_GET_NAMED and OPCODE_SET_NAMED site.
+	// The compiler emits the index of the cache after the name operand. The cache remembers what
+	// the name resolved to for the last receiver, and is trusted as long as the receiver has the
+	// same script (or native class, when the name resolved to native code) and no script was
+	// compiled or freed since. Anything that can't be cached takes the regular path.
+	// Caches are only used on the main thread, so filling them needs no synchronization.
+	struct InlineCache {
+		enum Kind {
+			KIND_EMPTY,
+			KIND_SCRIPT_FUNCTION,
+			KIND_METHOD_BIND,
+			KIND_MEMBER,
+			KIND_PROPERTY,
+		};
+
+		Kind kind;
+		uint32_t version;
+		const GDScript *script;
+		StringName native_class;
+		GDScriptFunction *function;
+		MethodBind *method; // method, or native property getter/setter
+		int index; // script member index, or native property index
+		Variant::Type member_type; // typed script members only accept this type in the fast path
+		bool ptrcall; // the method can be called with ptrcall when the arguments have the exact types
+
+		InlineCache() :
+				kind(KIND_EMPTY),
+				version(0),
+				script(nullptr),
+				function(nullptr),
+				method(nullptr),
+				index(-1),
+				member_type(Variant::NIL),
+				ptrcall(false) {}
+	};
+
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptBytecodeCache;
 
 	StringName source;
 
@@ -213,6 +284,8 @@ private:
 	const StringName *_named_globals_ptr;
 	int _named_globals_count;
 #endif
+	InlineCache *_inline_caches_ptr;
+	int _inline_cache_count;
 	const int *_default_arg_ptr;
 	int _default_arg_count;
 	const int *_code_ptr;
@@ -233,6 +306,7 @@ private:
 #endif
 	Vector<int> default_arguments;
 	Vector<int> code;
+	Vector<InlineCache> inline_caches;
 	Vector<GDScriptDataType> argument_types;
 	GDScriptDataType return_type;
 
@@ -245,7 +319,27 @@ private:
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant &static_ref, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
+	_FORCE_INLINE_ void _count_inline_cache(bool p_hit);
+	bool _fill_call_cache(InlineCache &p_cache, Object *p_obj, const GDScript *p_script, const StringName &p_method) const;
+	bool _fill_get_named_cache(InlineCache &p_cache, Object *p_obj, const GDScript *p_script, const StringName &p_name) const;
+	bool _fill_set_named_cache(InlineCache &p_cache, Object *p_obj, const GDScript *p_script, const StringName &p_name) const;
+	_FORCE_INLINE_ bool _call_cached(InlineCache &p_cache, const Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_err, bool p_ptrcall);
+	_FORCE_INLINE_ bool _get_named_cached(InlineCache &p_cache, const Variant *p_base, const StringName &p_name, Variant *r_dst);
+	_FORCE_INLINE_ bool _set_named_cached(InlineCache &p_cache, const Variant *p_base, const StringName &p_name, const Variant *p_value, bool &r_valid);
+
 	friend class GDScriptLanguage;
+	friend class GDScriptFunctionState;
+
+	// Stacks of yielded calls, kept by the function state until it resumes, then reused by the
+	// next yield. All of them have the size of the stack of the function (variants and call arguments).
+	enum {
+		STATE_STACK_POOL_MAX = 64,
+	};
+	SpinLock state_stack_lock;
+	LocalVector<uint8_t *> state_stack_pool;
+
+	uint8_t *_alloc_state_stack();
+	void _free_state_stack(uint8_t *p_stack);
 
 	SelfList<GDScriptFunction> function_list;
 #ifdef DEBUG_ENABLED
@@ -263,6 +357,12 @@ private:
 		uint64_t last_frame_call_count;
 		uint64_t last_frame_self_time;
 		uint64_t last_frame_total_time;
+		uint64_t inline_cache_hits;
+		uint64_t inline_cache_misses;
+		uint64_t frame_inline_cache_hits;
+		uint64_t frame_inline_cache_misses;
+		uint64_t last_frame_inline_cache_hits;
+		uint64_t last_frame_inline_cache_misses;
 	} profile;
 
 #endif
@@ -275,7 +375,7 @@ public:
 		StringName function_name;
 		String script_path;
 #endif
-		Vector<uint8_t> stack;
+		uint8_t *stack; // alloca_size bytes, the variants are moved here from the stack of the call
 		int stack_size;
 		Variant self;
 		uint32_t alloca_size;
@@ -293,6 +393,18 @@ public:
 	StringName get_global_name(int p_idx) const;
 	StringName get_name() const;
 	int get_max_stack_size() const;
+	int get_inline_cache_count() const;
+
+	// Whether a native method can be called with ptrcall, given arguments of the types it declares.
+	static bool can_ptrcall(const MethodBind *p_method);
+
+	// Returns the specialized opcode for the operator on these operand types, or OPCODE_OPERATOR if there is none.
+	static Opcode get_typed_operator_opcode(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b);
+	// Returns the operator performed by a specialized opcode, or Variant::OP_MAX.
+	static Variant::Operator get_typed_operator(Opcode p_opcode);
+	// Walks the code and lists the positions of the operands that are addresses, returns false on
+	// code it can't decode.
+	bool get_address_operands(LocalVector<int> &r_positions) const;
 	int get_default_argument_count() const;
 	int get_default_argument_addr(int p_idx) const;
 	GDScriptDataType get_return_type() const;
@@ -342,6 +454,8 @@ public:
 	Variant resume(const Variant &p_arg = Variant());
 
 	void _clear_stack();
+	// Like _clear_stack(), but the memory goes back to the pool of p_function, which must still exist.
+	void _release_stack(GDScriptFunction *p_function);
 
 	GDScriptFunctionState();
 	~GDScriptFunctionState();
@@ -3182,70 +3182,7 @@ void GDScriptParser::_parse_block(BlockNode *p_block, bool p_static) {
 				if (container->type == Node::TYPE_OPERATOR) {
 					OperatorNode *op = static_cast<OperatorNode *>(container);
 					if (op->op == OperatorNode::OP_CALL && op->arguments[0]->type == Node::TYPE_BUILT_IN_FUNCTION && static_cast<BuiltInFunctionNode *>(op->arguments[0])->function == GDScriptFunctions::GEN_RANGE) {
-						//iterating a range, so see if range() can be optimized without allocating memory, by replacing it by vectors (which can work as iterable too!)
-
-						Vector<Node *> args;
-						Vector<double> constants;
-
-						bool constant = true;
-
-						for (int i = 1; i < op->arguments.size(); i++) {
-							args.push_back(op->arguments[i]);
-							if (op->arguments[i]->type == Node::TYPE_CONSTANT) {
-								ConstantNode *c = static_cast<ConstantNode *>(op->arguments[i]);
-								if (c->value.get_type() == Variant::REAL || c->value.get_type() == Variant::INT) {
-									constants.push_back(c->value);
-								} else {
-									constant = false;
-								}
-							} else {
-								constant = false;
-							}
-						}
-
-						if (args.size() > 0 && args.size() < 4) {
-							if (constant) {
-								ConstantNode *cn = alloc_node<ConstantNode>();
-								switch (args.size()) {
-									case 1:
-										cn->value = (int)constants[0];
-										break;
-									case 2:
-										cn->value = Vector2(constants[0], constants[1]);
-										break;
-									case 3:
-										cn->value = Vector3(constants[0], constants[1], constants[2]);
-										break;
-								}
-								cn->datatype = _type_from_variant(cn->value);
-								container = cn;
-							} else {
-								OperatorNode *on = alloc_node<OperatorNode>();
-								on->op = OperatorNode::OP_CALL;
-
-								TypeNode *tn = alloc_node<TypeNode>();
-								on->arguments.push_back(tn);
-
-								switch (args.size()) {
-									case 1:
-										tn->vtype = Variant::INT;
-										break;
-									case 2:
-										tn->vtype = Variant::VECTOR2;
-										break;
-									case 3:
-										tn->vtype = Variant::VECTOR3;
-										break;
-								}
-
-								for (int i = 0; i < args.size(); i++) {
-									on->arguments.push_back(args[i]);
-								}
-
-								container = on;
-							}
-						}
-
+						// The compiler turns range() into a counted loop, the array is never built.
 						iter_type.has_type = true;
 						iter_type.kind = DataType::BUILTIN;
 						iter_type.builtin_type = Variant::INT;
@@ -8579,6 +8516,397 @@ void GDScriptParser::_check_block_types(BlockNode *p_block) {
 #endif // DEBUG_ENABLED
 }
 
+// Looks up a constant the way the compiler resolves identifiers: the class and its bases, then the
+// integer constants of its native base, then the same for each outer class when p_search_owners is set.
+// Fails on names that are inner classes, or constants whose value isn't known at parse time.
+bool GDScriptParser::_find_class_constant(ClassNode *p_class, const StringName &p_identifier, bool p_search_owners, Variant &r_value) const {
+	for (ClassNode *c = p_class; c; c = p_search_owners ? c->owner : nullptr) {
+		DataType base_type;
+		ClassNode *base = c;
+		while (base) {
+			if (base->constant_expressions.has(p_identifier)) {
+				const Node *expr = base->constant_expressions[p_identifier].expression;
+				if (expr->type != Node::TYPE_CONSTANT) {
+					return false;
+				}
+				r_value = static_cast<const ConstantNode *>(expr)->value;
+				return true;
+			}
+			for (int i = 0; i < base->subclasses.size(); i++) {
+				if (base->subclasses[i]->name == p_identifier) {
+					return false;
+				}
+			}
+
+			base_type = base->base_type;
+			base = base_type.kind == DataType::CLASS ? base_type.class_type : nullptr;
+		}
+
+		Ref<Script> scr;
+		StringName native;
+		if (base_type.kind == DataType::GDSCRIPT || base_type.kind == DataType::SCRIPT) {
+			scr = base_type.script_type;
+		} else if (base_type.kind == DataType::NATIVE) {
+			native = base_type.native_type;
+		}
+
+		while (scr.is_valid()) {
+			Map<StringName, Variant> constants;
+			scr->get_constants(&constants);
+			if (constants.has(p_identifier)) {
+				r_value = constants[p_identifier];
+				return true;
+			}
+			native = scr->get_instance_base_type();
+			scr = scr->get_base_script();
+		}
+
+		if (native != StringName()) {
+			if (!ClassDB::class_exists(native)) {
+				native = "_" + native.operator String();
+			}
+			bool valid = false;
+			int constant = ClassDB::get_integer_constant(native, p_identifier, &valid);
+			if (valid) {
+				r_value = constant;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Whether the identifier is a member variable or property of the class, which take precedence over constants.
+bool GDScriptParser::_is_class_member(ClassNode *p_class, const StringName &p_identifier) const {
+	DataType base_type;
+	ClassNode *base = p_class;
+	while (base) {
+		for (int i = 0; i < base->variables.size(); i++) {
+			if (base->variables[i].identifier == p_identifier) {
+				return true;
+			}
+		}
+
+		base_type = base->base_type;
+		base = base_type.kind == DataType::CLASS ? base_type.class_type : nullptr;
+	}
+
+	Ref<Script> scr;
+	StringName native;
+	if (base_type.kind == DataType::GDSCRIPT || base_type.kind == DataType::SCRIPT) {
+		scr = base_type.script_type;
+	} else if (base_type.kind == DataType::NATIVE) {
+		native = base_type.native_type;
+	}
+
+	while (scr.is_valid()) {
+		List<PropertyInfo> properties;
+		scr->get_script_property_list(&properties);
+		for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next()) {
+			if (E->get().name == p_identifier) {
+				return true;
+			}
+		}
+		native = scr->get_instance_base_type();
+		scr = scr->get_base_script();
+	}
+
+	if (native != StringName()) {
+		if (!ClassDB::class_exists(native)) {
+			native = "_" + native.operator String();
+		}
+		if (ClassDB::has_property(native, p_identifier)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Replaces an expression by its value. Only values that can't be modified through the reference are
+// folded, objects and containers keep being read from the class at runtime.
+GDScriptParser::Node *GDScriptParser::_fold_constant(const Variant &p_value, const Node *p_source) {
+	if (p_value.get_type() >= Variant::_RID) {
+		return nullptr;
+	}
+
+	ConstantNode *cn = alloc_node<ConstantNode>();
+	cn->value = p_value;
+	cn->datatype = _type_from_variant(p_value);
+	cn->line = p_source->line;
+	cn->column = p_source->column;
+	return cn;
+}
+
+// Reduces an expression after folding its identifiers. An operation that fails on constants isn't an
+// error here, it's left for the runtime to report as it did before.
+GDScriptParser::Node *GDScriptParser::_reduce_folded(Node *p_node) {
+	Node *reduced = _reduce_expression(p_node, false);
+	if (error_set) {
+		error_set = false;
+		error = String();
+		error_line = -1;
+		error_column = -1;
+		return p_node;
+	}
+	return reduced;
+}
+
+GDScriptParser::Node *GDScriptParser::_fold_expression(Node *p_node, ClassNode *p_class, const Set<StringName> &p_locals, const ConstantNode *p_match_value) {
+	switch (p_node->type) {
+		case Node::TYPE_IDENTIFIER: {
+			const IdentifierNode *in = static_cast<const IdentifierNode *>(p_node);
+			if (p_match_value && in->name == "#match_value") {
+				return _fold_constant(p_match_value->value, p_node);
+			}
+			if (p_locals.has(in->name) || _is_class_member(p_class, in->name)) {
+				return p_node;
+			}
+
+			Variant value;
+			if (_find_class_constant(p_class, in->name, true, value)) {
+				Node *cn = _fold_constant(value, p_node);
+				if (cn) {
+					return cn;
+				}
+			}
+			return p_node;
+		} break;
+		case Node::TYPE_ARRAY: {
+			ArrayNode *an = static_cast<ArrayNode *>(p_node);
+			for (int i = 0; i < an->elements.size(); i++) {
+				an->elements.write[i] = _fold_expression(an->elements[i], p_class, p_locals, p_match_value);
+			}
+			return p_node;
+		} break;
+		case Node::TYPE_DICTIONARY: {
+			DictionaryNode *dn = static_cast<DictionaryNode *>(p_node);
+			for (int i = 0; i < dn->elements.size(); i++) {
+				dn->elements.write[i].key = _fold_expression(dn->elements[i].key, p_class, p_locals, p_match_value);
+				dn->elements.write[i].value = _fold_expression(dn->elements[i].value, p_class, p_locals, p_match_value);
+			}
+			return p_node;
+		} break;
+		case Node::TYPE_CAST: {
+			CastNode *cn = static_cast<CastNode *>(p_node);
+			cn->source_node = _fold_expression(cn->source_node, p_class, p_locals, p_match_value);
+			return p_node;
+		} break;
+		case Node::TYPE_OPERATOR: {
+			OperatorNode *op = static_cast<OperatorNode *>(p_node);
+
+			switch (op->op) {
+				case OperatorNode::OP_INIT_ASSIGN:
+				case OperatorNode::OP_ASSIGN:
+				case OperatorNode::OP_ASSIGN_ADD:
+				case OperatorNode::OP_ASSIGN_SUB:
+				case OperatorNode::OP_ASSIGN_MUL:
+				case OperatorNode::OP_ASSIGN_DIV:
+				case OperatorNode::OP_ASSIGN_MOD:
+				case OperatorNode::OP_ASSIGN_SHIFT_LEFT:
+				case OperatorNode::OP_ASSIGN_SHIFT_RIGHT:
+				case OperatorNode::OP_ASSIGN_BIT_AND:
+				case OperatorNode::OP_ASSIGN_BIT_OR:
+				case OperatorNode::OP_ASSIGN_BIT_XOR: {
+					// The target stays as written, only the value is folded.
+					op->arguments.write[1] = _fold_expression(op->arguments[1], p_class, p_locals, p_match_value);
+					return p_node;
+				} break;
+				case OperatorNode::OP_CALL: {
+					// Method names aren't expressions.
+					bool constructor = op->arguments[0]->type == Node::TYPE_TYPE || op->arguments[0]->type == Node::TYPE_BUILT_IN_FUNCTION;
+					for (int i = 0; i < op->arguments.size(); i++) {
+						if (i == 1 && !constructor) {
+							continue;
+						}
+						op->arguments.write[i] = _fold_expression(op->arguments[i], p_class, p_locals, p_match_value);
+					}
+				} break;
+				case OperatorNode::OP_PARENT_CALL: {
+					for (int i = 1; i < op->arguments.size(); i++) {
+						op->arguments.write[i] = _fold_expression(op->arguments[i], p_class, p_locals, p_match_value);
+					}
+					return p_node;
+				} break;
+				case OperatorNode::OP_IS:
+				case OperatorNode::OP_IS_BUILTIN: {
+					op->arguments.write[0] = _fold_expression(op->arguments[0], p_class, p_locals, p_match_value);
+					return p_node;
+				} break;
+				case OperatorNode::OP_INDEX_NAMED: {
+					const StringName &member = static_cast<IdentifierNode *>(op->arguments[1])->name;
+					if (op->arguments[0]->type == Node::TYPE_IDENTIFIER) {
+						// Constants of inner classes and of preloaded scripts: Inner.CONSTANT, Preloaded.CONSTANT.
+						const StringName &base_name = static_cast<IdentifierNode *>(op->arguments[0])->name;
+						if (!p_locals.has(base_name) && !_is_class_member(p_class, base_name)) {
+							Variant value;
+							bool found = false;
+							for (ClassNode *c = p_class; c && !found; c = c->owner) {
+								for (int i = 0; i < c->subclasses.size(); i++) {
+									if (c->subclasses[i]->name == base_name) {
+										found = _find_class_constant(c->subclasses[i], member, false, value);
+										break;
+									}
+								}
+							}
+							if (!found && _find_class_constant(p_class, base_name, true, value)) {
+								Ref<Script> scr = value;
+								found = false;
+								while (scr.is_valid() && !found) {
+									Map<StringName, Variant> constants;
+									scr->get_constants(&constants);
+									if (constants.has(member)) {
+										value = constants[member];
+										found = true;
+									}
+									scr = scr->get_base_script();
+								}
+							}
+							if (found) {
+								Node *cn = _fold_constant(value, op);
+								if (cn) {
+									return cn;
+								}
+							}
+						}
+					}
+					op->arguments.write[0] = _fold_expression(op->arguments[0], p_class, p_locals, p_match_value);
+				} break;
+				default: {
+					for (int i = 0; i < op->arguments.size(); i++) {
+						op->arguments.write[i] = _fold_expression(op->arguments[i], p_class, p_locals, p_match_value);
+					}
+				} break;
+			}
+
+			// Short-circuits and the ternary only need their condition to be constant.
+			if (op->arguments.size() && op->arguments[0]->type == Node::TYPE_CONSTANT) {
+				bool condition = static_cast<ConstantNode *>(op->arguments[0])->value.booleanize();
+				if (op->op == OperatorNode::OP_AND && !condition) {
+					return _fold_constant(false, op);
+				} else if (op->op == OperatorNode::OP_OR && condition) {
+					return _fold_constant(true, op);
+				} else if (op->op == OperatorNode::OP_TERNARY_IF) {
+					return condition ? op->arguments[1] : op->arguments[2];
+				}
+			}
+
+			return _reduce_folded(op);
+		} break;
+		default: {
+			return p_node;
+		} break;
+	}
+}
+
+void GDScriptParser::_collect_block_locals(const BlockNode *p_block, Set<StringName> &r_locals) const {
+	for (const Map<StringName, LocalVarNode *>::Element *E = p_block->variables.front(); E; E = E->next()) {
+		r_locals.insert(E->key());
+	}
+
+	for (int i = 0; i < p_block->statements.size(); i++) {
+		if (p_block->statements[i]->type != Node::TYPE_CONTROL_FLOW) {
+			continue;
+		}
+		const ControlFlowNode *cf = static_cast<const ControlFlowNode *>(p_block->statements[i]);
+		if (cf->cf_type == ControlFlowNode::CF_FOR) {
+			r_locals.insert(static_cast<const IdentifierNode *>(cf->arguments[0])->name);
+		}
+		if (cf->body) {
+			_collect_block_locals(cf->body, r_locals);
+		}
+		if (cf->body_else) {
+			_collect_block_locals(cf->body_else, r_locals);
+		}
+		if (cf->cf_type == ControlFlowNode::CF_MATCH) {
+			for (int j = 0; j < cf->match->compiled_pattern_branches.size(); j++) {
+				_collect_block_locals(cf->match->compiled_pattern_branches[j].body, r_locals);
+			}
+		}
+	}
+}
+
+void GDScriptParser::_fold_block(BlockNode *p_block, ClassNode *p_class, const Set<StringName> &p_locals) {
+	for (int i = 0; i < p_block->statements.size(); i++) {
+		Node *statement = p_block->statements[i];
+
+		switch (statement->type) {
+			case Node::TYPE_CONTROL_FLOW: {
+				ControlFlowNode *cf = static_cast<ControlFlowNode *>(statement);
+				for (int j = cf->cf_type == ControlFlowNode::CF_FOR ? 1 : 0; j < cf->arguments.size(); j++) {
+					cf->arguments.write[j] = _fold_expression(cf->arguments[j], p_class, p_locals);
+				}
+
+				if (cf->cf_type == ControlFlowNode::CF_MATCH) {
+					MatchNode *match = cf->match;
+					match->val_to_match = _fold_expression(match->val_to_match, p_class, p_locals);
+
+					// A constant value decides the patterns here, the compiler drops the branches that can't match.
+					const ConstantNode *match_value = nullptr;
+					if (match->val_to_match->type == Node::TYPE_CONSTANT && static_cast<ConstantNode *>(match->val_to_match)->value.get_type() < Variant::_RID) {
+						match_value = static_cast<ConstantNode *>(match->val_to_match);
+					}
+					for (int j = 0; j < match->compiled_pattern_branches.size(); j++) {
+						MatchNode::CompiledPatternBranch &branch = match->compiled_pattern_branches.write[j];
+						branch.compiled_pattern = _fold_expression(branch.compiled_pattern, p_class, p_locals, match_value);
+						_fold_block(branch.body, p_class, p_locals);
+					}
+				}
+
+				if (cf->body) {
+					_fold_block(cf->body, p_class, p_locals);
+				}
+				if (cf->body_else) {
+					_fold_block(cf->body_else, p_class, p_locals);
+				}
+			} break;
+			case Node::TYPE_ASSERT: {
+				AssertNode *an = static_cast<AssertNode *>(statement);
+				an->condition = _fold_expression(an->condition, p_class, p_locals);
+				if (an->message) {
+					an->message = _fold_expression(an->message, p_class, p_locals);
+				}
+			} break;
+			case Node::TYPE_LOCAL_VAR:
+			case Node::TYPE_NEWLINE:
+			case Node::TYPE_BREAKPOINT: {
+			} break;
+			default: {
+				p_block->statements.write[i] = _fold_expression(statement, p_class, p_locals);
+			} break;
+		}
+	}
+}
+
+// Replaces the class constants used in code by their values once the whole script is resolved, so the
+// compiler can emit them as plain constants, evaluate the expressions made of them and skip the branches
+// they rule out.
+void GDScriptParser::_fold_class_constants(ClassNode *p_class) {
+	for (int i = 0; i < p_class->functions.size() + p_class->static_functions.size(); i++) {
+		FunctionNode *function = i < p_class->functions.size() ? p_class->functions[i] : p_class->static_functions[i - p_class->functions.size()];
+
+		Set<StringName> locals;
+		for (int j = 0; j < function->arguments.size(); j++) {
+			locals.insert(function->arguments[j]);
+		}
+		_collect_block_locals(function->body, locals);
+
+		for (int j = 0; j < function->default_values.size(); j++) {
+			function->default_values.write[j] = _fold_expression(function->default_values[j], p_class, locals);
+		}
+		_fold_block(function->body, p_class, locals);
+	}
+
+	Set<StringName> class_locals;
+	_fold_block(p_class->initializer, p_class, class_locals);
+	_fold_block(p_class->ready, p_class, class_locals);
+
+	for (int i = 0; i < p_class->subclasses.size(); i++) {
+		_fold_class_constants(p_class->subclasses[i]);
+	}
+}
+
 void GDScriptParser::_set_error(const String &p_error, int p_line, int p_column) {
 	if (error_set) {
 		return; //allow no further errors
@@ -8754,6 +9082,10 @@ Error GDScriptParser::_parse(const String &p_base_path) {
 	}
 #endif // DEBUG_ENABLED
 
+	if (!validating && !for_completion) {
+		_fold_class_constants(main_class);
+	}
+
 	return OK;
 }
 
@@ -607,6 +607,16 @@ private:
 	void _check_class_blocks_types(ClassNode *p_class);
 	void _check_function_types(FunctionNode *p_function);
 	void _check_block_types(BlockNode *p_block);
+
+	bool _find_class_constant(ClassNode *p_class, const StringName &p_identifier, bool p_search_owners, Variant &r_value) const;
+	bool _is_class_member(ClassNode *p_class, const StringName &p_identifier) const;
+	Node *_fold_constant(const Variant &p_value, const Node *p_source);
+	Node *_reduce_folded(Node *p_node);
+	Node *_fold_expression(Node *p_node, ClassNode *p_class, const Set<StringName> &p_locals, const ConstantNode *p_match_value = nullptr);
+	void _collect_block_locals(const BlockNode *p_block, Set<StringName> &r_locals) const;
+	void _fold_block(BlockNode *p_block, ClassNode *p_class, const Set<StringName> &p_locals);
+	void _fold_class_constants(ClassNode *p_class);
+
 	_FORCE_INLINE_ void _mark_line_as_safe(int p_line) const {
 #ifdef DEBUG_ENABLED
 		if (safe_lines) {
@@ -0,0 +1,305 @@
+/**************************************************************************/
+/*  gdscript_preloader.cpp                                                */
+/**************************************************************************/
+
+
+#include "gdscript_preloader.h"
+
+#include "core/io/resource_loader.h"
+#include "core/os/file_access.h"
+#include "core/os/frame_profiler.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+#include "core/project_settings.h"
+#include "core/script_language.h"
+#include "gdscript_bytecode_cache.h"
+#include "gdscript_tokenizer.h"
+
+static bool _is_script_path(const String &p_path) {
+	String ext = p_path.get_extension().to_lower();
+	return ext == "gd" || ext == "gdc" || ext == "gde";
+}
+
+void GDScriptPreloader::_add_resource(const String &p_path) {
+	if (visited.has(p_path)) {
+		return;
+	}
+	visited.insert(p_path);
+
+	if (_is_script_path(p_path)) {
+		script_indices.set(p_path, scripts.size());
+		ScriptInfo si;
+		si.path = p_path;
+		scripts.push_back(si);
+		return;
+	}
+
+	// Scenes and other resources only matter for the scripts they use.
+	List<String> dependencies;
+	ResourceLoader::get_dependencies(p_path, &dependencies);
+	for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+		_add_resource(E->get());
+	}
+}
+
+// Looks for "extends" and constant "preload()" paths in the tokens, resolved like the parser does.
+// Preloads of named constants aren't found, those are loaded on demand when the script is compiled.
+static void _scan_tokens(GDScriptTokenizer *p_tokenizer, const String &p_base_path, Vector<String> &r_dependencies, StringName &r_base_class) {
+	bool extends_found = false;
+	while (p_tokenizer->get_token() != GDScriptTokenizer::TK_EOF && p_tokenizer->get_token() != GDScriptTokenizer::TK_ERROR) {
+		switch (p_tokenizer->get_token()) {
+			case GDScriptTokenizer::TK_PR_PRELOAD: {
+				if (p_tokenizer->get_token(1) != GDScriptTokenizer::TK_PARENTHESIS_OPEN || p_tokenizer->get_token(2) != GDScriptTokenizer::TK_CONSTANT || p_tokenizer->get_token(3) != GDScriptTokenizer::TK_PARENTHESIS_CLOSE) {
+					break;
+				}
+				const Variant &constant = p_tokenizer->get_token_constant(2);
+				if (constant.get_type() != Variant::STRING) {
+					break;
+				}
+				String path = constant;
+				if (!path.is_abs_path() && p_base_path != "") {
+					path = p_base_path.plus_file(path);
+				}
+				r_dependencies.push_back(path.replace("///", "//").simplify_path());
+			} break;
+			case GDScriptTokenizer::TK_PR_EXTENDS: {
+				if (p_tokenizer->get_token(1) == GDScriptTokenizer::TK_CONSTANT) {
+					const Variant &constant = p_tokenizer->get_token_constant(1);
+					if (constant.get_type() == Variant::STRING) {
+						String path = constant;
+						if (path.is_rel_path()) {
+							path = p_base_path.plus_file(path).simplify_path();
+						}
+						r_dependencies.push_back(path);
+					}
+				} else if (p_tokenizer->get_token(1) == GDScriptTokenizer::TK_IDENTIFIER && !extends_found) {
+					// Only the one of the main class, which comes first.
+					r_base_class = p_tokenizer->get_token_identifier(1);
+				}
+				extends_found = true;
+			} break;
+			default: {
+			}
+		}
+		p_tokenizer->advance();
+	}
+}
+
+// Runs on the worker pool. Only reads and tokenizes files, which doesn't load anything. The scripts are
+// parsed once, when they are compiled, since parsing resolves preloads and base classes by loading them.
+void GDScriptPreloader::_scan_script(uint32_t p_index, ScriptInfo *p_scripts) {
+	ScriptInfo &si = p_scripts[p_index];
+
+	String file_path = ResourceLoader::path_remap(si.path);
+	if (file_path.ends_with(".gde")) {
+		return; // Encrypted, its dependencies are loaded when it's compiled.
+	}
+
+	Vector<uint8_t> buffer = FileAccess::get_file_as_array(file_path);
+	if (buffer.empty()) {
+		return;
+	}
+
+	// Errors are left to be reported when the script is compiled.
+	if (file_path.ends_with(".gd")) {
+		String source;
+		if (source.parse_utf8((const char *)buffer.ptr(), buffer.size())) {
+			return;
+		}
+		if (tokenize && !FileAccess::exists(GDScriptBytecodeCache::get_cache_path(file_path))) {
+			si.tokens = GDScriptTokenizerBuffer::parse_code_string(source);
+			si.tokenized = !si.tokens.empty();
+		}
+		if (si.tokenized) {
+			GDScriptTokenizerBuffer tokenizer;
+			if (tokenizer.set_code_buffer(si.tokens) == OK) {
+				_scan_tokens(&tokenizer, si.path.get_base_dir(), si.dependencies, si.base_class);
+			}
+		} else {
+			GDScriptTokenizerText tokenizer;
+			tokenizer.set_code(source);
+			_scan_tokens(&tokenizer, si.path.get_base_dir(), si.dependencies, si.base_class);
+		}
+	} else {
+		GDScriptTokenizerBuffer tokenizer;
+		if (tokenizer.set_code_buffer(buffer) == OK) {
+			_scan_tokens(&tokenizer, si.path.get_base_dir(), si.dependencies, si.base_class);
+		}
+	}
+}
+
+// Kahn's algorithm: a script goes in the wave after the last of its dependencies.
+// Scripts in a dependency cycle can't be ordered, they go together in a last wave.
+void GDScriptPreloader::_sort_waves(Vector<Vector<int>> &r_waves) const {
+	int count = scripts.size();
+	Vector<int> pending;
+	pending.resize(count);
+	Vector<Vector<int>> users;
+	users.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		const ScriptInfo &si = scripts[i];
+		Set<int> depends_on;
+		for (int j = 0; j < si.dependencies.size(); j++) {
+			const int *index = script_indices.getptr(si.dependencies[j]);
+			if (index && *index != i) {
+				depends_on.insert(*index);
+			}
+		}
+		if (si.base_class != StringName() && ScriptServer::is_global_class(si.base_class)) {
+			const int *index = script_indices.getptr(ScriptServer::get_global_class_path(si.base_class));
+			if (index && *index != i) {
+				depends_on.insert(*index);
+			}
+		}
+
+		pending.write[i] = depends_on.size();
+		for (Set<int>::Element *E = depends_on.front(); E; E = E->next()) {
+			users.write[E->get()].push_back(i);
+		}
+	}
+
+	Vector<int> wave;
+	for (int i = 0; i < count; i++) {
+		if (pending[i] == 0) {
+			wave.push_back(i);
+		}
+	}
+
+	int sorted = 0;
+	while (wave.size()) {
+		r_waves.push_back(wave);
+		sorted += wave.size();
+
+		Vector<int> next;
+		for (int i = 0; i < wave.size(); i++) {
+			const Vector<int> &wave_users = users[wave[i]];
+			for (int j = 0; j < wave_users.size(); j++) {
+				int user = wave_users[j];
+				pending.write[user]--;
+				if (pending[user] == 0) {
+					next.push_back(user);
+				}
+			}
+		}
+		wave = next;
+	}
+
+	if (sorted < count) {
+		Vector<int> cycles;
+		for (int i = 0; i < count; i++) {
+			if (pending[i] > 0) {
+				cycles.push_back(i);
+			}
+		}
+		r_waves.push_back(cycles);
+	}
+}
+
+void GDScriptPreloader::preload(const Vector<String> &p_paths) {
+	FRAME_PROFILE_SCOPE("GDScriptPreloader::preload");
+
+	uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+
+	tokenize = true;
+#ifdef DEBUG_ENABLED
+	// Tokens don't keep comments, so the warnings disabled by them would be reported again.
+	if (ScriptDebugger::get_singleton() || GLOBAL_GET("debug/gdscript/warnings/treat_warnings_as_errors").booleanize()) {
+		tokenize = false;
+	}
+#endif
+
+	for (int i = 0; i < p_paths.size(); i++) {
+		_add_resource(p_paths[i]);
+	}
+
+	// Scanning a script can find more scripts, which are scanned in the next round.
+	ThreadWorkPool pool;
+	pool.init();
+	int scanned = 0;
+	while (scanned < scripts.size()) {
+		FRAME_PROFILE_SCOPE("GDScriptPreloader::scan");
+		int count = scripts.size();
+		pool.do_work(count - scanned, this, &GDScriptPreloader::_scan_script, scripts.ptrw() + scanned);
+
+		for (int i = scanned; i < count; i++) {
+			Vector<String> dependencies = scripts[i].dependencies;
+			for (int j = 0; j < dependencies.size(); j++) {
+				_add_resource(dependencies[j]);
+			}
+			if (scripts[i].base_class != StringName() && ScriptServer::is_global_class(scripts[i].base_class)) {
+				_add_resource(ScriptServer::get_global_class_path(scripts[i].base_class));
+			}
+		}
+		scanned = count;
+	}
+	int thread_count = pool.get_thread_count();
+	pool.finish();
+
+	Vector<Vector<int>> waves;
+	_sort_waves(waves);
+
+	int tokenized = 0;
+	mutex.lock();
+	for (int i = 0; i < scripts.size(); i++) {
+		if (scripts[i].tokenized) {
+			tokens.set(ResourceLoader::path_remap(scripts[i].path), scripts[i].tokens);
+			tokenized++;
+		}
+	}
+	mutex.unlock();
+	compiling.set();
+
+	uint64_t compile_begin_usec = OS::get_singleton()->get_ticks_usec();
+
+	{
+		FRAME_PROFILE_SCOPE("GDScriptPreloader::compile");
+		for (int i = 0; i < waves.size(); i++) {
+			const Vector<int> &wave = waves[i];
+			for (int j = 0; j < wave.size(); j++) {
+				RES res = ResourceLoader::load(scripts[wave[j]].path);
+				if (res.is_valid()) {
+					loaded.push_back(res);
+				}
+			}
+		}
+	}
+
+	compiling.clear();
+	uint64_t end_usec = OS::get_singleton()->get_ticks_usec();
+
+	print_verbose(vformat("GDScript preload: %d scripts (%d tokenized ahead) scanned in %.2f msec on %d threads.", scripts.size(), tokenized, (compile_begin_usec - begin_usec) / 1000.0, thread_count));
+	print_verbose(vformat("GDScript preload: compiled in %d waves in %.2f msec.", waves.size(), (end_usec - compile_begin_usec) / 1000.0));
+
+	scripts.clear();
+	script_indices.clear();
+	visited.clear();
+
+	// Left by scripts that failed to load.
+	mutex.lock();
+	tokens.clear();
+	mutex.unlock();
+}
+
+bool GDScriptPreloader::take_tokens(const String &p_file_path, Vector<uint8_t> &r_tokens) {
+	if (!compiling.is_set()) {
+		return false;
+	}
+
+	MutexLock lock(mutex);
+	const Vector<uint8_t> *t = tokens.getptr(p_file_path);
+	if (!t) {
+		return false;
+	}
+	r_tokens = *t;
+	tokens.erase(p_file_path);
+	return true;
+}
+
+void GDScriptPreloader::release() {
+	loaded.clear();
+}
+
+GDScriptPreloader::GDScriptPreloader() {
+	tokenize = false;
+}
@@ -0,0 +1,59 @@
+/**************************************************************************/
+/*  gdscript_preloader.h                                                  */
+/**************************************************************************/
+
+
+#ifndef GDSCRIPT_PRELOADER_H
+#define GDSCRIPT_PRELOADER_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/resource.h"
+#include "core/safe_refcount.h"
+#include "core/set.h"
+
+// Loads the scripts a game needs at startup in one batch, before the autoloads and the main scene.
+// The scripts are found by following the dependencies (extends and preload) of the given resources.
+// Reading, tokenizing and scanning the tokens of every script for dependencies runs on a worker pool,
+// then the scripts are parsed and compiled on the calling thread in topological waves, so every script
+// finds its base classes and preloads already loaded. Parsing and compiling can't be spread over threads,
+// as they load resources through the ResourceLoader, which only shares the resources being loaded within
+// a thread.
+// The compiled scripts are kept alive until release() (called on the first frame), so the loads of the
+// autoloads and the main scene that follow hit the resource cache.
+
+class GDScriptPreloader {
+	struct ScriptInfo {
+		String path;
+		Vector<uint8_t> tokens; // Tokenized source of .gd files, handed over to the loader.
+		Vector<String> dependencies;
+		StringName base_class; // Global class name used by "extends".
+		bool tokenized = false;
+	};
+
+	Vector<ScriptInfo> scripts;
+	HashMap<String, int> script_indices;
+	Set<String> visited;
+	bool tokenize;
+
+	Mutex mutex;
+	HashMap<String, Vector<uint8_t>> tokens; // By file path, as given to the loader.
+	Vector<RES> loaded;
+	SafeFlag compiling;
+
+	void _add_resource(const String &p_path);
+	void _scan_script(uint32_t p_index, ScriptInfo *p_scripts);
+	void _sort_waves(Vector<Vector<int>> &r_waves) const;
+
+public:
+	// Finds, parses and compiles all the scripts used by the given resources (scenes, scripts or others).
+	void preload(const Vector<String> &p_paths);
+	// The loader takes the tokens prepared for a .gd file instead of tokenizing it again.
+	bool take_tokens(const String &p_file_path, Vector<uint8_t> &r_tokens);
+	// Lets the preloaded scripts go, the ones still in use stay in the resource cache.
+	void release();
+
+	GDScriptPreloader();
+};
+
+#endif // GDSCRIPT_PRELOADER_H
@@ -0,0 +1,385 @@
+/**************************************************************************/
+/*  gdscript_sampling_profiler.cpp                                        */
+/**************************************************************************/
+
+
+#include "gdscript_sampling_profiler.h"
+
+#ifdef DEBUG_ENABLED
+
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "gdscript.h"
+
+GDScriptSamplingProfiler *GDScriptSamplingProfiler::singleton = nullptr;
+SafeFlag GDScriptSamplingProfiler::sampling;
+Mutex GDScriptSamplingProfiler::thread_mutex;
+LocalVector<GDScriptSamplingProfiler::ThreadStack *> GDScriptSamplingProfiler::thread_stacks;
+
+// The stack of a thread is registered on its first call while sampling, and lives until the thread exits.
+struct GDScriptSamplingThreadStackOwner {
+	GDScriptSamplingProfiler::ThreadStack *stack = nullptr;
+
+	~GDScriptSamplingThreadStackOwner() {
+		if (stack) {
+			GDScriptSamplingProfiler::unregister_thread(stack);
+		}
+	}
+};
+
+static thread_local GDScriptSamplingThreadStackOwner tls_stack_owner;
+
+GDScriptSamplingProfiler::ThreadStack *GDScriptSamplingProfiler::_get_thread_stack() {
+	if (likely(tls_stack_owner.stack)) {
+		return tls_stack_owner.stack;
+	}
+
+	ThreadStack *ts = memnew(ThreadStack);
+	ts->thread_id = Thread::get_caller_id();
+	ts->depth.set(0);
+
+	MutexLock lock(thread_mutex);
+	thread_stacks.push_back(ts);
+	tls_stack_owner.stack = ts;
+	return ts;
+}
+
+void GDScriptSamplingProfiler::unregister_thread(ThreadStack *p_stack) {
+	MutexLock lock(thread_mutex);
+	thread_stacks.erase(p_stack);
+	memdelete(p_stack);
+}
+
+void GDScriptSamplingProfiler::_thread_func(void *p_userdata) {
+	GDScriptSamplingProfiler *profiler = (GDScriptSamplingProfiler *)p_userdata;
+	while (sampling.is_set()) {
+		OS::get_singleton()->delay_usec(profiler->interval_usec);
+		profiler->_take_samples();
+	}
+}
+
+// The stacks are read while their threads keep running, a sample can mix frames from before and
+// after a call. That only misplaces a hit, the functions are validated before they are used.
+// The thread mutex keeps the stacks (and the threads owning the lines) alive during the copy.
+void GDScriptSamplingProfiler::_take_samples() {
+	MutexLock lock(thread_mutex);
+
+	for (uint32_t n = 0; n < thread_stacks.size(); n++) {
+		const ThreadStack *ts = thread_stacks[n];
+		uint32_t depth = ts->depth.get();
+		if (depth == 0) {
+			continue; // Not running a script.
+		}
+
+		uint64_t pos = write_pos.get();
+		if (pos - read_pos.get() >= SAMPLE_BUFFER_SIZE) {
+			dropped.increment();
+			continue;
+		}
+
+		Sample &s = samples[pos % SAMPLE_BUFFER_SIZE];
+		s.truncated = depth > MAX_DEPTH;
+		s.depth = MIN(depth, (uint32_t)MAX_DEPTH);
+		for (uint32_t i = 0; i < s.depth; i++) {
+			s.functions[i] = ts->frames[i].function;
+			s.lines[i] = *ts->frames[i].line;
+		}
+		write_pos.set(pos + 1);
+	}
+}
+
+struct _GDScriptFunctionPtrHash {
+	static _FORCE_INLINE_ uint32_t hash(const GDScriptFunction *p_function) { return hash_one_uint64((uint64_t)p_function); }
+};
+
+String GDScriptSamplingProfiler::_get_function_label(const GDScriptFunction *p_function) {
+	String path = p_function->get_source();
+	if (path == "") {
+		path = "<built-in>";
+	}
+	// Semicolons separate the frames of collapsed stacks.
+	return (path + ":" + String(p_function->get_name())).replace(";", ":");
+}
+
+void GDScriptSamplingProfiler::flush() {
+	uint64_t begin = read_pos.get();
+	uint64_t end = write_pos.get();
+	if (begin == end) {
+		return;
+	}
+
+	// Only the functions still in the list of the language can be dereferenced.
+	HashMap<const GDScriptFunction *, String, _GDScriptFunctionPtrHash> labels;
+	for (uint64_t pos = begin; pos < end; pos++) {
+		const Sample &s = samples[pos % SAMPLE_BUFFER_SIZE];
+		for (uint32_t i = 0; i < s.depth; i++) {
+			if (!labels.has(s.functions[i])) {
+				labels.set(s.functions[i], "<unknown>");
+			}
+		}
+	}
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	language->lock.lock();
+	for (SelfList<GDScriptFunction> *E = language->function_list.first(); E; E = E->next()) {
+		String *label = labels.getptr(E->self());
+		if (label) {
+			*label = _get_function_label(E->self());
+		}
+	}
+	language->lock.unlock();
+
+	LocalVector<String> frames;
+	for (uint64_t pos = begin; pos < end; pos++) {
+		const Sample &s = samples[pos % SAMPLE_BUFFER_SIZE];
+
+		frames.clear();
+		for (uint32_t i = 0; i < s.depth; i++) {
+			frames.push_back(labels[s.functions[i]] + ":" + itos(s.lines[i]));
+		}
+		if (s.truncated) {
+			frames.push_back("<truncated>");
+		}
+
+		String stack;
+		for (uint32_t i = 0; i < frames.size(); i++) {
+			// Recursive calls count once in the total of a line.
+			bool seen = false;
+			for (uint32_t j = 0; j < i; j++) {
+				if (frames[j] == frames[i]) {
+					seen = true;
+					break;
+				}
+			}
+			if (!seen) {
+				lines[frames[i]].total++;
+			}
+			stack += i == 0 ? frames[i] : ";" + frames[i];
+		}
+		lines[frames[frames.size() - 1]].self++;
+
+		uint64_t *hits = stacks.getptr(stack);
+		if (hits) {
+			(*hits)++;
+		} else {
+			stacks.set(stack, 1);
+		}
+		sample_count++;
+	}
+
+	read_pos.set(end);
+}
+
+void GDScriptSamplingProfiler::start() {
+	ERR_FAIL_COND_MSG(is_active(), "The GDScript sampling profiler is already running.");
+
+	sampling.set();
+	thread.start(_thread_func, this);
+}
+
+void GDScriptSamplingProfiler::stop() {
+	if (!is_active()) {
+		return;
+	}
+
+	sampling.clear();
+	thread.wait_to_finish();
+	flush();
+}
+
+void GDScriptSamplingProfiler::clear() {
+	ERR_FAIL_COND_MSG(is_active(), "Stop the GDScript sampling profiler before clearing it.");
+
+	read_pos.set(write_pos.get());
+	dropped.set(0);
+	stacks.clear();
+	lines.clear();
+	sample_count = 0;
+}
+
+void GDScriptSamplingProfiler::set_interval_usec(uint32_t p_usec) {
+	ERR_FAIL_COND(p_usec < 1);
+	interval_usec = p_usec;
+}
+
+uint32_t GDScriptSamplingProfiler::get_interval_usec() const {
+	return interval_usec;
+}
+
+uint64_t GDScriptSamplingProfiler::get_sample_count() const {
+	return sample_count;
+}
+
+uint64_t GDScriptSamplingProfiler::get_dropped_count() const {
+	return dropped.get();
+}
+
+String GDScriptSamplingProfiler::get_collapsed_stacks() const {
+	List<String> keys;
+	stacks.get_key_list(&keys);
+	keys.sort();
+
+	String collapsed;
+	for (List<String>::Element *E = keys.front(); E; E = E->next()) {
+		collapsed += E->get() + " " + itos(stacks[E->get()]) + "\n";
+	}
+	return collapsed;
+}
+
+struct _GDScriptProfileLine {
+	String label;
+	uint64_t self;
+	uint64_t total;
+
+	bool operator<(const _GDScriptProfileLine &p_other) const {
+		if (self != p_other.self) {
+			return self > p_other.self;
+		}
+		if (total != p_other.total) {
+			return total > p_other.total;
+		}
+		return label < p_other.label;
+	}
+};
+
+struct _GDScriptProfileNode {
+	String label;
+	uint64_t self = 0;
+	uint64_t total = 0;
+	LocalVector<uint32_t> children;
+};
+
+struct _GDScriptProfileChild {
+	uint64_t total;
+	uint32_t index;
+
+	bool operator<(const _GDScriptProfileChild &p_other) const {
+		return total > p_other.total;
+	}
+};
+
+static String _percent(uint64_t p_hits, uint64_t p_samples) {
+	return String::num(p_samples ? p_hits * 100.0 / p_samples : 0.0, 1).pad_decimals(1) + "%";
+}
+
+static void _print_call_tree(const LocalVector<_GDScriptProfileNode> &p_nodes, uint32_t p_index, int p_indent, uint64_t p_samples, String &r_report) {
+	const _GDScriptProfileNode &node = p_nodes[p_index];
+	r_report += String("  ").repeat(p_indent) + _percent(node.total, p_samples) + " " + itos(node.total) + " (self " + itos(node.self) + ") " + node.label + "\n";
+
+	LocalVector<_GDScriptProfileChild> children;
+	for (uint32_t i = 0; i < node.children.size(); i++) {
+		_GDScriptProfileChild child;
+		child.total = p_nodes[node.children[i]].total;
+		child.index = node.children[i];
+		children.push_back(child);
+	}
+	children.sort();
+	for (uint32_t i = 0; i < children.size(); i++) {
+		_print_call_tree(p_nodes, children[i].index, p_indent + 1, p_samples, r_report);
+	}
+}
+
+String GDScriptSamplingProfiler::get_report() const {
+	String report = vformat("GDScript sampling profile: %d samples taken every %d usec, %d dropped.\n", sample_count, interval_usec, dropped.get());
+
+	report += "\nLines (self %, self, total %, total, line):\n";
+	LocalVector<_GDScriptProfileLine> sorted_lines;
+	const String *key = nullptr;
+	while ((key = lines.next(key))) {
+		_GDScriptProfileLine line;
+		line.label = *key;
+		line.self = lines[*key].self;
+		line.total = lines[*key].total;
+		sorted_lines.push_back(line);
+	}
+	sorted_lines.sort();
+	for (uint32_t i = 0; i < sorted_lines.size(); i++) {
+		const _GDScriptProfileLine &line = sorted_lines[i];
+		report += vformat("%s %d %s %d %s\n", _percent(line.self, sample_count), line.self, _percent(line.total, sample_count), line.total, line.label);
+	}
+
+	// The call tree is built from the collapsed stacks, node 0 is the root.
+	LocalVector<_GDScriptProfileNode> nodes;
+	nodes.resize(1);
+	key = nullptr;
+	while ((key = stacks.next(key))) {
+		uint64_t hits = stacks[*key];
+		Vector<String> frames = key->split(";");
+		uint32_t index = 0;
+		for (int i = 0; i < frames.size(); i++) {
+			uint32_t child = 0;
+			for (uint32_t j = 0; j < nodes[index].children.size(); j++) {
+				if (nodes[nodes[index].children[j]].label == frames[i]) {
+					child = nodes[index].children[j];
+					break;
+				}
+			}
+			if (!child) {
+				child = nodes.size();
+				nodes.resize(child + 1);
+				nodes[child].label = frames[i];
+				nodes[index].children.push_back(child);
+			}
+			nodes[child].total += hits;
+			index = child;
+		}
+		nodes[index].self += hits;
+	}
+
+	report += "\nCall tree (total %, total, self, line):\n";
+	for (uint32_t i = 0; i < nodes[0].children.size(); i++) {
+		nodes[0].total += nodes[nodes[0].children[i]].total;
+	}
+	LocalVector<_GDScriptProfileChild> roots;
+	for (uint32_t i = 0; i < nodes[0].children.size(); i++) {
+		_GDScriptProfileChild root;
+		root.total = nodes[nodes[0].children[i]].total;
+		root.index = nodes[0].children[i];
+		roots.push_back(root);
+	}
+	roots.sort();
+	for (uint32_t i = 0; i < roots.size(); i++) {
+		_print_call_tree(nodes, roots[i].index, 0, sample_count, report);
+	}
+
+	return report;
+}
+
+Error GDScriptSamplingProfiler::save_collapsed_stacks(const String &p_path) const {
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Cannot save GDScript collapsed stacks to file '" + p_path + "'.");
+
+	f->store_string(get_collapsed_stacks());
+	f->close();
+	return OK;
+}
+
+Error GDScriptSamplingProfiler::save_report(const String &p_path) const {
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Cannot save GDScript sampling profile to file '" + p_path + "'.");
+
+	f->store_string(get_report());
+	f->close();
+	return OK;
+}
+
+GDScriptSamplingProfiler::GDScriptSamplingProfiler() {
+	ERR_FAIL_COND_MSG(singleton, "Singleton for GDScriptSamplingProfiler already exists.");
+	singleton = this;
+	interval_usec = 1000;
+	samples = memnew_arr(Sample, SAMPLE_BUFFER_SIZE);
+	write_pos.set(0);
+	read_pos.set(0);
+	dropped.set(0);
+	sample_count = 0;
+}
+
+GDScriptSamplingProfiler::~GDScriptSamplingProfiler() {
+	stop();
+	memdelete_arr(samples);
+	singleton = nullptr;
+}
+
+#endif // DEBUG_ENABLED
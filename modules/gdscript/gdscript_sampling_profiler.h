@@ -0,0 +1,134 @@
+/**************************************************************************/
+/*  gdscript_sampling_profiler.h                                          */
+/**************************************************************************/
+
+
+#ifndef GDSCRIPT_SAMPLING_PROFILER_H
+#define GDSCRIPT_SAMPLING_PROFILER_H
+
+#ifdef DEBUG_ENABLED
+
+#include "core/hash_map.h"
+#include "core/local_vector.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+#include "core/ustring.h"
+
+class GDScriptFunction;
+
+// Statistical profiler for GDScript, with line granularity.
+// While sampling, every call to a script function pushes the function and the address of its
+// current line (updated by OPCODE_LINE) on a small stack owned by the calling thread, which is
+// the only cost on the script side. A timer thread wakes up every interval and copies the stack
+// of each script thread into a lock-free ring of samples, which is aggregated on the main thread
+// by flush() (called every frame). Functions are only resolved to names while aggregating, and
+// only if they still exist, so samples of freed scripts are counted as unknown.
+// The results can be saved as collapsed stacks ("frame;frame;frame count" per line), the input
+// of flame graph tools, or as a text report with the hits of every line and the call tree.
+// Not available in release builds, as those don't track lines.
+
+class GDScriptSamplingProfiler {
+public:
+	enum {
+		MAX_DEPTH = 32, // Deeper calls are counted as a single truncated frame.
+		SAMPLE_BUFFER_SIZE = 4096,
+	};
+
+	struct Frame {
+		const GDScriptFunction *function;
+		const int *line;
+	};
+
+	// Written by the owning thread, read by the timer thread.
+	struct ThreadStack {
+		Thread::ID thread_id;
+		Frame frames[MAX_DEPTH];
+		SafeNumeric<uint32_t> depth;
+	};
+
+private:
+	struct Sample {
+		uint32_t depth;
+		bool truncated; // The calls deeper than MAX_DEPTH are not known.
+		const GDScriptFunction *functions[MAX_DEPTH]; // Outermost first.
+		int lines[MAX_DEPTH];
+	};
+
+	struct LineHits {
+		uint64_t self = 0;
+		uint64_t total = 0;
+	};
+
+	static GDScriptSamplingProfiler *singleton;
+	static SafeFlag sampling;
+	static Mutex thread_mutex;
+	static LocalVector<ThreadStack *> thread_stacks;
+
+	Thread thread;
+	uint32_t interval_usec;
+
+	// Single producer (the timer thread), single consumer (flush).
+	Sample *samples;
+	SafeNumeric<uint64_t> write_pos;
+	SafeNumeric<uint64_t> read_pos;
+	SafeNumeric<uint64_t> dropped;
+
+	HashMap<String, uint64_t> stacks; // Collapsed stack to hits.
+	HashMap<String, LineHits> lines; // "path:function:line" to hits.
+	uint64_t sample_count;
+
+	static ThreadStack *_get_thread_stack();
+	static void _thread_func(void *p_userdata);
+	void _take_samples();
+
+	static String _get_function_label(const GDScriptFunction *p_function);
+
+public:
+	static GDScriptSamplingProfiler *get_singleton() { return singleton; }
+
+	_FORCE_INLINE_ static bool is_active() { return sampling.is_set(); }
+
+	// Returns the stack the frame was pushed on, to be passed to exit_function().
+	_FORCE_INLINE_ static ThreadStack *enter_function(const GDScriptFunction *p_function, const int *p_line) {
+		ThreadStack *ts = _get_thread_stack();
+		uint32_t depth = ts->depth.get();
+		if (depth < MAX_DEPTH) {
+			ts->frames[depth].function = p_function;
+			ts->frames[depth].line = p_line;
+		}
+		ts->depth.increment();
+		return ts;
+	}
+
+	_FORCE_INLINE_ static void exit_function(ThreadStack *p_stack) {
+		p_stack->depth.decrement();
+	}
+
+	static void unregister_thread(ThreadStack *p_stack);
+
+	void start();
+	void stop();
+	void clear();
+
+	void set_interval_usec(uint32_t p_usec);
+	uint32_t get_interval_usec() const;
+
+	// Moves the pending samples into the aggregated results.
+	void flush();
+
+	uint64_t get_sample_count() const;
+	uint64_t get_dropped_count() const;
+
+	String get_collapsed_stacks() const;
+	String get_report() const;
+	Error save_collapsed_stacks(const String &p_path) const;
+	Error save_report(const String &p_path) const;
+
+	GDScriptSamplingProfiler();
+	~GDScriptSamplingProfiler();
+};
+
+#endif // DEBUG_ENABLED
+
+#endif // GDSCRIPT_SAMPLING_PROFILER_H
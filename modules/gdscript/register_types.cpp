@@ -10,6 +10,7 @@
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
 #include "gdscript.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_tokenizer.h"
 
 GDScriptLanguage *script_language_gd = nullptr;
@@ -31,7 +32,21 @@ Ref<ResourceFormatSaverGDScript> resource_saver_gd;
 class EditorExportGDScript : public EditorExportPlugin {
 	GDCLASS(EditorExportGDScript, EditorExportPlugin);
 
+	bool debug;
+
+	void _add_bytecode_cache(const String &p_path, const String &p_source_code, const Vector<uint8_t> &p_source) {
+		// Scripts that can't be cached are compiled when loaded, as usual.
+		Vector<uint8_t> cache;
+		if (GDScriptBytecodeCache::compile(p_path, p_source_code, p_source, debug, cache) == OK) {
+			add_file(GDScriptBytecodeCache::get_cache_path(p_path), cache, false);
+		}
+	}
+
 public:
+	virtual void _export_begin(const Set<String> &p_features, bool p_debug, const String &p_path, int p_flags) {
+		debug = p_debug;
+	}
+
 	virtual void _export_file(const String &p_path, const String &p_type, const Set<String> &p_features) {
 		int script_mode = EditorExportPreset::MODE_SCRIPT_COMPILED;
 		String script_key;
@@ -43,7 +58,7 @@ public:
 			script_key = preset->get_script_encryption_key().to_lower();
 		}
 
-		if (!p_path.ends_with(".gd") || script_mode == EditorExportPreset::MODE_SCRIPT_TEXT) {
+		if (!p_path.ends_with(".gd")) {
 			return;
 		}
 
@@ -54,6 +69,12 @@ public:
 
 		String txt;
 		txt.parse_utf8((const char *)file.ptr(), file.size());
+
+		if (script_mode == EditorExportPreset::MODE_SCRIPT_TEXT) {
+			_add_bytecode_cache(p_path, txt, file);
+			return;
+		}
+
 		file = GDScriptTokenizerBuffer::parse_code_string(txt);
 
 		if (!file.empty()) {
@@ -103,9 +124,14 @@ public:
 
 			} else {
 				add_file(p_path.get_basename() + ".gdc", file, true);
+				_add_bytecode_cache(p_path, txt, file);
 			}
 		}
 	}
+
+	EditorExportGDScript() {
+		debug = false;
+	}
 };
 
 static void _editor_init() {
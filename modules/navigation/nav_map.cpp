@@ -5,6 +5,8 @@
 
 #include "nav_map.h"
 
+#include "core/os/frame_profiler.h"
+
 #include "nav_region.h"
 #include "rvo_agent.h"
 
@@ -493,6 +495,8 @@ void NavMap::remove_agent_as_controlled(RvoAgent *agent) {
 }
 
 void NavMap::sync() {
+	FRAME_PROFILE_SCOPE("NavMap::sync");
+
 	// Check if we need to update the links.
 	if (regenerate_polygons) {
 		for (uint32_t r = 0; r < regions.size(); r++) {
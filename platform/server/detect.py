@@ -0,0 +1,135 @@
+import os
+import platform
+import sys
+
+# To match other platforms
+STACK_SIZE = 8388608
+
+def is_active():
+    return True
+
+def get_name():
+    return "Server"
+
+def can_build():
+    # Headless builds use the POSIX drivers, only Linux is supported for now.
+    if not sys.platform.startswith("linux"):
+        return False
+    return True
+
+def get_opts():
+    from SCons.Variables import BoolVariable
+
+    return [
+        BoolVariable("use_llvm", "Use the LLVM compiler", False),
+        BoolVariable("use_static_cpp", "Link libgcc and libstdc++ statically for better portability", True),
+        BoolVariable("use_ubsan", "Use LLVM/GCC compiler undefined behavior sanitizer (UBSAN)", False),
+        BoolVariable("use_asan", "Use LLVM/GCC compiler address sanitizer (ASAN))", False),
+        BoolVariable("use_lsan", "Use LLVM/GCC compiler leak sanitizer (LSAN))", False),
+        BoolVariable("use_tsan", "Use LLVM/GCC compiler thread sanitizer (TSAN))", False),
+        BoolVariable("debug_symbols", "Add debugging symbols to release/release_debug builds", True),
+        BoolVariable("separate_debug_symbols", "Create a separate file containing debugging symbols", False),
+        BoolVariable("execinfo", "Use libexecinfo on systems where glibc is not available", False),
+    ]
+
+def get_flags():
+    return []
+
+def configure(env):
+    ## Build type
+
+    if env["target"] == "release":
+        if env["optimize"] == "speed":  # optimize for speed (default)
+            env.Prepend(CCFLAGS=["-O3"])
+        elif env["optimize"] == "size":  # optimize for size
+            env.Prepend(CCFLAGS=["-Os"])
+
+        if env["debug_symbols"]:
+            env.Prepend(CCFLAGS=["-g2"])
+
+    elif env["target"] == "release_debug":
+        if env["optimize"] == "speed":  # optimize for speed (default)
+            env.Prepend(CCFLAGS=["-O2"])
+        elif env["optimize"] == "size":  # optimize for size
+            env.Prepend(CCFLAGS=["-Os"])
+
+        if env["debug_symbols"]:
+            env.Prepend(CCFLAGS=["-g2"])
+
+    elif env["target"] == "debug":
+        env.Prepend(CCFLAGS=["-g3"])
+        env.Append(LINKFLAGS=["-rdynamic"])
+
+    ## Architecture
+
+    is64 = sys.maxsize > 2**32
+    if env["bits"] == "default":
+        env["bits"] = "64" if is64 else "32"
+
+    ## Compiler configuration
+
+    if "CXX" in env and "clang" in os.path.basename(env["CXX"]):
+        # Convenience check to enforce the use_llvm overrides when CXX is clang(++)
+        env["use_llvm"] = True
+
+    if env["use_llvm"]:
+        if "clang++" not in os.path.basename(env["CXX"]):
+            env["CC"] = "clang"
+            env["CXX"] = "clang++"
+        env.extra_suffix = ".llvm" + env.extra_suffix
+
+    if env["use_ubsan"] or env["use_asan"] or env["use_lsan"] or env["use_tsan"]:
+        env.extra_suffix += "s"
+
+        if env["use_ubsan"]:
+            env.Append(CCFLAGS=["-fsanitize=undefined"])
+            env.Append(LINKFLAGS=["-fsanitize=undefined"])
+
+        if env["use_asan"]:
+            env.Append(CCFLAGS=["-fsanitize=address"])
+            env.Append(LINKFLAGS=["-fsanitize=address"])
+
+        if env["use_lsan"]:
+            env.Append(CCFLAGS=["-fsanitize=leak"])
+            env.Append(LINKFLAGS=["-fsanitize=leak"])
+
+        if env["use_tsan"]:
+            env.Append(CCFLAGS=["-fsanitize=thread"])
+            env.Append(LINKFLAGS=["-fsanitize=thread"])
+
+    if env["use_lto"]:
+        env.Append(CCFLAGS=["-flto"])
+        if not env["use_llvm"] and env.GetOption("num_jobs") > 1:
+            env.Append(LINKFLAGS=["-flto=" + str(env.GetOption("num_jobs"))])
+        else:
+            env.Append(LINKFLAGS=["-flto"])
+        if not env["use_llvm"]:
+            env["RANLIB"] = "gcc-ranlib"
+            env["AR"] = "gcc-ar"
+
+    env.Append(CCFLAGS=["-pipe"])
+    env.Append(LINKFLAGS=["-pipe"])
+
+    ## Dependencies
+
+    # No window, GL or audio system libraries are needed, the dummy
+    # rasterizer and audio driver are used.
+
+    ## Flags
+
+    env.Prepend(CPPPATH=["#platform/server"])
+    env.Append(CPPDEFINES=["SERVER_ENABLED", "UNIX_ENABLED"])
+
+    if platform.system() == "Linux":
+        env.Append(LIBS=["dl"])
+
+    if platform.system().find("BSD") >= 0 or env["execinfo"]:
+        env.Append(LIBS=["execinfo"])
+
+    # Link those statically for portability
+    if env["use_static_cpp"]:
+        env.Append(LINKFLAGS=["-static-libgcc", "-static-libstdc++"])
+
+    env.Append(LIBS=["pthread"])
+
+    env.Append(LINKFLAGS=["-Wl,-z,stack-size=" + str(STACK_SIZE)])
@@ -0,0 +1,179 @@
+/**************************************************************************/
+/*  os_server.cpp                                                         */
+/**************************************************************************/
+
+
+#include "os_server.h"
+
+#include "core/print_string.h"
+#include "drivers/dummy/rasterizer_dummy.h"
+#include "main/main.h"
+#include "servers/visual/visual_server_raster.h"
+
+int OS_Server::get_video_driver_count() const {
+	return 1;
+}
+
+const char *OS_Server::get_video_driver_name(int p_driver) const {
+	return "Dummy";
+}
+
+int OS_Server::get_current_video_driver() const {
+	return 0;
+}
+
+Error OS_Server::initialize(const VideoMode &p_desired, int p_video_driver, int p_audio_driver) {
+	current_videomode = p_desired;
+	main_loop = nullptr;
+
+	RasterizerDummy::make_current();
+
+	// The dummy rasterizer does no work, so a render thread would only add
+	// synchronization and memory overhead (command queue, RID preallocation).
+	visual_server = memnew(VisualServerRaster);
+	visual_server->init();
+
+	AudioDriverManager::initialize(p_audio_driver);
+
+	input = memnew(InputDefault);
+
+	resource_loader_dummy.instance();
+	ResourceLoader::add_resource_format_loader(resource_loader_dummy);
+
+	return OK;
+}
+
+void OS_Server::finalize() {
+	if (main_loop) {
+		memdelete(main_loop);
+	}
+	main_loop = nullptr;
+
+	visual_server->finish();
+	memdelete(visual_server);
+
+	memdelete(input);
+
+	ResourceLoader::remove_resource_format_loader(resource_loader_dummy);
+	resource_loader_dummy.unref();
+}
+
+void OS_Server::set_main_loop(MainLoop *p_main_loop) {
+	main_loop = p_main_loop;
+	input->set_main_loop(p_main_loop);
+}
+
+void OS_Server::delete_main_loop() {
+	if (main_loop) {
+		memdelete(main_loop);
+	}
+	main_loop = nullptr;
+}
+
+String OS_Server::get_name() const {
+	return "Server";
+}
+
+Point2 OS_Server::get_mouse_position() const {
+	return Point2();
+}
+
+int OS_Server::get_mouse_button_state() const {
+	return 0;
+}
+
+void OS_Server::set_window_title(const String &p_title) {
+}
+
+MainLoop *OS_Server::get_main_loop() const {
+	return main_loop;
+}
+
+bool OS_Server::can_draw() const {
+	return false; //can never draw
+}
+
+void OS_Server::set_video_mode(const VideoMode &p_video_mode, int p_screen) {
+}
+
+OS::VideoMode OS_Server::get_video_mode(int p_screen) const {
+	return current_videomode;
+}
+
+void OS_Server::get_fullscreen_mode_list(List<VideoMode> *p_list, int p_screen) const {
+}
+
+Size2 OS_Server::get_window_size() const {
+	return Vector2(current_videomode.width, current_videomode.height);
+}
+
+OS::PowerState OS_Server::get_power_state() {
+	return OS::POWERSTATE_UNKNOWN;
+}
+
+int OS_Server::get_power_seconds_left() {
+	return -1;
+}
+
+int OS_Server::get_power_percent_left() {
+	return -1;
+}
+
+bool OS_Server::_check_internal_feature_support(const String &p_feature) {
+	return p_feature == "pc" || p_feature == "server";
+}
+
+void OS_Server::run() {
+	force_quit = false;
+
+	if (!main_loop) {
+		return;
+	}
+
+	main_loop->init();
+
+	while (!force_quit) {
+		if (Main::iteration()) {
+			break;
+		}
+	};
+
+	main_loop->finish();
+}
+
+String OS_Server::get_config_path() const {
+	if (has_environment("XDG_CONFIG_HOME")) {
+		return get_environment("XDG_CONFIG_HOME");
+	} else if (has_environment("HOME")) {
+		return get_environment("HOME").plus_file(".config");
+	} else {
+		return ".";
+	}
+}
+
+String OS_Server::get_data_path() const {
+	if (has_environment("XDG_DATA_HOME")) {
+		return get_environment("XDG_DATA_HOME");
+	} else if (has_environment("HOME")) {
+		return get_environment("HOME").plus_file(".local/share");
+	} else {
+		return get_config_path();
+	}
+}
+
+String OS_Server::get_cache_path() const {
+	if (has_environment("XDG_CACHE_HOME")) {
+		return get_environment("XDG_CACHE_HOME");
+	} else if (has_environment("HOME")) {
+		return get_environment("HOME").plus_file(".cache");
+	} else {
+		return get_config_path();
+	}
+}
+
+OS_Server::OS_Server() {
+	visual_server = nullptr;
+	main_loop = nullptr;
+	input = nullptr;
+	force_quit = false;
+}
@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*  os_server.h                                                           */
+/**************************************************************************/
+
+
+#ifndef OS_SERVER_H
+#define OS_SERVER_H
+
+#include "core/os/input.h"
+#include "drivers/dummy/texture_loader_dummy.h"
+#include "drivers/unix/os_unix.h"
+#include "main/input_default.h"
+#include "servers/audio_server.h"
+#include "servers/visual/rasterizer.h"
+#include "servers/visual_server.h"
+
+// Headless OS for dedicated servers, automated tests and benchmarks.
+// Nothing is ever displayed or played: the dummy rasterizer replaces the renderer
+// (so no shaders are compiled and textures are never uploaded) and the dummy
+// audio driver (always registered last by AudioDriverManager) is the only one available.
+class OS_Server : public OS_Unix {
+	VisualServer *visual_server;
+	VideoMode current_videomode;
+	MainLoop *main_loop;
+
+	virtual void delete_main_loop();
+
+	bool force_quit;
+
+	InputDefault *input;
+
+	Ref<ResourceFormatDummyTexture> resource_loader_dummy;
+
+protected:
+	virtual int get_video_driver_count() const;
+	virtual const char *get_video_driver_name(int p_driver) const;
+	virtual int get_current_video_driver() const;
+
+	virtual Error initialize(const VideoMode &p_desired, int p_video_driver, int p_audio_driver);
+	virtual void finalize();
+
+	virtual void set_main_loop(MainLoop *p_main_loop);
+
+public:
+	virtual String get_name() const;
+
+	virtual Point2 get_mouse_position() const;
+	virtual int get_mouse_button_state() const;
+	virtual void set_window_title(const String &p_title);
+
+	virtual MainLoop *get_main_loop() const;
+
+	virtual bool can_draw() const;
+
+	virtual void set_video_mode(const VideoMode &p_video_mode, int p_screen = 0);
+	virtual VideoMode get_video_mode(int p_screen = 0) const;
+	virtual void get_fullscreen_mode_list(List<VideoMode> *p_list, int p_screen = 0) const;
+
+	virtual Size2 get_window_size() const;
+
+	void run();
+
+	virtual OS::PowerState get_power_state();
+	virtual int get_power_seconds_left();
+	virtual int get_power_percent_left();
+	virtual bool _check_internal_feature_support(const String &p_feature);
+
+	virtual String get_config_path() const;
+	virtual String get_data_path() const;
+	virtual String get_cache_path() const;
+
+	OS_Server();
+};
+
+#endif // OS_SERVER_H
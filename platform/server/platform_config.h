@@ -0,0 +1,6 @@
+/**************************************************************************/
+/*  platform_config.h                                                     */
+/**************************************************************************/
+
+
+#include <alloca.h>
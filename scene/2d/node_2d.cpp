@@ -106,11 +106,24 @@ void Node2D::_update_xform_values() {
 	_xform_dirty = false;
 }
 
+void Node2D::_send_transform() {
+	if (!is_inside_tree()) {
+		VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
+		return;
+	}
+
+	// Sent once per frame along with the other moved nodes, no matter how many times it moves.
+	// Nodes moved in a process thread go to a list of the thread, merged after the batch.
+	if (!canvas_transform.in_list()) {
+		SceneTree::_get_canvas_transform_list(get_tree())->add(&canvas_transform);
+	}
+}
+
 void Node2D::_update_transform() {
 	_mat.set_rotation_and_scale(angle, _scale);
 	_mat.elements[2] = pos;
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
+	_send_transform();
 
 	if (!is_inside_tree()) {
 		return;
@@ -278,7 +291,7 @@ void Node2D::set_transform(const Transform2D &p_transform) {
 	_mat = p_transform;
 	_xform_dirty = true;
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
+	_send_transform();
 
 	if (!is_inside_tree()) {
 		return;
@@ -423,7 +436,15 @@ StringName Node2D::get_property_store_alias(const StringName &p_property) const
 }
 #endif
 
-Node2D::Node2D() {
+void Node2D::_notification(int p_what) {
+	if (p_what == NOTIFICATION_EXIT_TREE && canvas_transform.in_list()) {
+		get_tree()->canvas_transform_list.remove(&canvas_transform);
+		VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
+	}
+}
+
+Node2D::Node2D() :
+		canvas_transform(this) {
 	angle = 0;
 	_scale = Vector2(1, 1);
 	_xform_dirty = false;
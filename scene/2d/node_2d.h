@@ -21,11 +21,15 @@ class Node2D : public CanvasItem {
 
 	bool _xform_dirty;
 
+	SelfList<Node> canvas_transform; // In the tree's list of transforms to send.
+
+	void _send_transform();
 	void _update_transform();
 
 	void _update_xform_values();
 
 protected:
+	void _notification(int p_what);
 	static void _bind_methods();
 
 public:
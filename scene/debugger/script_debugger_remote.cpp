@@ -840,10 +840,10 @@ void ScriptDebuggerRemote::_send_profiling_data(bool p_for_frame) {
 
 	if (p_for_frame) {
 		packet_peer_stream->put_var("profile_frame");
-		packet_peer_stream->put_var(8 + profile_frame_data.size() * 2 + to_send * 4);
+		packet_peer_stream->put_var(8 + profile_frame_data.size() * 2 + to_send * 6);
 	} else {
 		packet_peer_stream->put_var("profile_total");
-		packet_peer_stream->put_var(8 + to_send * 4);
+		packet_peer_stream->put_var(8 + to_send * 6);
 	}
 
 	packet_peer_stream->put_var(Engine::get_singleton()->get_idle_frames()); //total frame time
@@ -877,6 +877,8 @@ void ScriptDebuggerRemote::_send_profiling_data(bool p_for_frame) {
 		packet_peer_stream->put_var(profile_info_ptrs[i]->call_count);
 		packet_peer_stream->put_var(profile_info_ptrs[i]->total_time / 1000000.0);
 		packet_peer_stream->put_var(profile_info_ptrs[i]->self_time / 1000000.0);
+		packet_peer_stream->put_var(profile_info_ptrs[i]->inline_cache_hits);
+		packet_peer_stream->put_var(profile_info_ptrs[i]->inline_cache_misses);
 	}
 
 	if (p_for_frame) {
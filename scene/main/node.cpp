@@ -8,7 +8,9 @@
 #include "core/core_string_names.h"
 #include "core/io/resource_loader.h"
 #include "core/message_queue.h"
+#include "core/os/thread.h"
 #include "core/print_string.h"
+#include "core/safe_refcount.h"
 #include "instance_placeholder.h"
 #include "scene/resources/packed_scene.h"
 #include "scene/scene_string_names.h"
@@ -23,6 +25,16 @@ VARIANT_ENUM_CAST(Node::PhysicsInterpolationMode);
 
 int Node::orphan_node_count = 0;
 
+// Changed by anything that may make a cached get_node() result wrong, see LookupCache.
+static SafeNumeric<uint64_t> lookup_version(1);
+
+#ifdef DEBUG_ENABLED
+// Nodes processed on worker threads (see set_process_thread_group()) may only change themselves.
+#define ERR_FAIL_IN_PROCESS_THREAD() ERR_FAIL_COND_MSG(SceneTree::is_in_process_thread(), "The scene tree can't be changed while processing on a worker thread. Consider using call_deferred() instead.")
+#else
+#define ERR_FAIL_IN_PROCESS_THREAD()
+#endif
+
 void Node::_notification(int p_notification) {
 	switch (p_notification) {
 		case NOTIFICATION_PROCESS: {
@@ -53,6 +65,7 @@ void Node::_notification(int p_notification) {
 			} else {
 				data.pause_owner = this;
 			}
+			_update_process_paused();
 
 			if (data.physics_interpolation_mode == PHYSICS_INTERPOLATION_MODE_INHERIT) {
 				bool interpolate = true; // Root node default is for interpolation to be on
@@ -99,6 +112,10 @@ void Node::_notification(int p_notification) {
 				data.path_cache = nullptr;
 			}
 		} break;
+		case NOTIFICATION_PAUSED:
+		case NOTIFICATION_UNPAUSED: {
+			_update_process_paused();
+		} break;
 		case NOTIFICATION_PATH_CHANGED: {
 			if (data.path_cache) {
 				memdelete(data.path_cache);
@@ -227,6 +244,18 @@ void Node::_propagate_enter_tree() {
 	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
 		E->get().group = data.tree->add_to_group(E->key(), this);
 	}
+	if (data.idle_process) {
+		data.tree->_add_to_process_list(SceneTree::PROCESS_LIST_IDLE, this);
+	}
+	if (data.idle_process_internal) {
+		data.tree->_add_to_process_list(SceneTree::PROCESS_LIST_IDLE_INTERNAL, this);
+	}
+	if (data.physics_process) {
+		data.tree->_add_to_process_list(SceneTree::PROCESS_LIST_PHYSICS, this);
+	}
+	if (data.physics_process_internal) {
+		data.tree->_add_to_process_list(SceneTree::PROCESS_LIST_PHYSICS_INTERNAL, this);
+	}
 
 	notification(NOTIFICATION_ENTER_TREE);
 
@@ -354,6 +383,11 @@ void Node::_propagate_exit_tree() {
 		data.tree->remove_from_group(E->key(), this);
 		E->get().group = nullptr;
 	}
+	for (int i = 0; i < SceneTree::PROCESS_LIST_MAX; i++) {
+		if (data.process_slot[i] != -1) {
+			data.tree->_remove_from_process_list((SceneTree::ProcessListType)i, this);
+		}
+	}
 
 	data.viewport = nullptr;
 
@@ -368,6 +402,7 @@ void Node::_propagate_exit_tree() {
 }
 
 void Node::move_child(Node *p_child, int p_pos) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	ERR_FAIL_NULL(p_child);
 	ERR_FAIL_INDEX_MSG(p_pos, data.children.size() + 1, vformat("Invalid new child position: %d.", p_pos));
 	ERR_FAIL_COND_MSG(p_child->data.parent != this, "Child is not a child of this node.");
@@ -408,6 +443,11 @@ void Node::move_child(Node *p_child, int p_pos) {
 			E->get().group->changed = true;
 		}
 	}
+	for (int i = 0; i < SceneTree::PROCESS_LIST_MAX; i++) {
+		if (p_child->data.process_slot[i] != -1) {
+			data.tree->_make_process_list_changed((SceneTree::ProcessListType)i);
+		}
+	}
 
 	data.blocked--;
 }
@@ -444,11 +484,7 @@ void Node::set_physics_process(bool p_process) {
 
 	data.physics_process = p_process;
 
-	if (data.physics_process) {
-		add_to_group("physics_process", false);
-	} else {
-		remove_from_group("physics_process");
-	}
+	_set_in_process_list(SceneTree::PROCESS_LIST_PHYSICS, data.physics_process);
 
 	_change_notify("physics_process");
 }
@@ -464,11 +500,7 @@ void Node::set_physics_process_internal(bool p_process_internal) {
 
 	data.physics_process_internal = p_process_internal;
 
-	if (data.physics_process_internal) {
-		add_to_group("physics_process_internal", false);
-	} else {
-		remove_from_group("physics_process_internal");
-	}
+	_set_in_process_list(SceneTree::PROCESS_LIST_PHYSICS_INTERNAL, data.physics_process_internal);
 
 	_change_notify("physics_process_internal");
 }
@@ -482,15 +514,13 @@ void Node::set_pause_mode(PauseMode p_mode) {
 		return;
 	}
 
-	bool prev_inherits = data.pause_mode == PAUSE_MODE_INHERIT;
 	data.pause_mode = p_mode;
 	if (!is_inside_tree()) {
 		return; //pointless
 	}
-	if ((data.pause_mode == PAUSE_MODE_INHERIT) == prev_inherits) {
-		return; ///nothing changed
-	}
 
+	// Nodes inheriting from this one need their paused state resolved again even if they keep
+	// the same pause owner.
 	Node *owner = nullptr;
 
 	if (data.pause_mode == PAUSE_MODE_INHERIT) {
@@ -513,11 +543,40 @@ void Node::_propagate_pause_owner(Node *p_owner) {
 		return;
 	}
 	data.pause_owner = p_owner;
+	_update_process_paused();
 	for (int i = 0; i < data.children.size(); i++) {
 		data.children[i]->_propagate_pause_owner(p_owner);
 	}
 }
 
+void Node::_update_process_paused() {
+	bool paused = false;
+
+	if (data.tree && data.tree->is_paused()) {
+		if (data.pause_mode == PAUSE_MODE_STOP) {
+			paused = true;
+		} else if (data.pause_mode == PAUSE_MODE_INHERIT) {
+			// No pause owner, or one that doesn't process.
+			paused = !data.pause_owner || data.pause_owner->data.pause_mode != PAUSE_MODE_PROCESS;
+		}
+	}
+
+	data.process_paused = paused;
+}
+
+void Node::_set_in_process_list(SceneTree::ProcessListType p_type, bool p_enabled) {
+	if (!data.inside_tree) {
+		return; // Joined when entering the tree.
+	}
+	ERR_FAIL_IN_PROCESS_THREAD();
+
+	if (p_enabled) {
+		data.tree->_add_to_process_list(p_type, this);
+	} else {
+		data.tree->_remove_from_process_list(p_type, this);
+	}
+}
+
 bool Node::can_process_notification(int p_what) const {
 	switch (p_what) {
 		case NOTIFICATION_PHYSICS_PROCESS:
@@ -536,29 +595,7 @@ bool Node::can_process_notification(int p_what) const {
 bool Node::can_process() const {
 	ERR_FAIL_COND_V(!is_inside_tree(), false);
 
-	if (get_tree()->is_paused()) {
-		if (data.pause_mode == PAUSE_MODE_STOP) {
-			return false;
-		}
-		if (data.pause_mode == PAUSE_MODE_PROCESS) {
-			return true;
-		}
-		if (data.pause_mode == PAUSE_MODE_INHERIT) {
-			if (!data.pause_owner) {
-				return false; //clearly no pause owner by default
-			}
-
-			if (data.pause_owner->data.pause_mode == PAUSE_MODE_PROCESS) {
-				return true;
-			}
-
-			if (data.pause_owner->data.pause_mode == PAUSE_MODE_STOP) {
-				return false;
-			}
-		}
-	}
-
-	return true;
+	return !data.process_paused;
 }
 
 void Node::set_physics_interpolation_mode(PhysicsInterpolationMode p_mode) {
@@ -622,11 +659,7 @@ void Node::set_process(bool p_idle_process) {
 
 	data.idle_process = p_idle_process;
 
-	if (data.idle_process) {
-		add_to_group("idle_process", false);
-	} else {
-		remove_from_group("idle_process");
-	}
+	_set_in_process_list(SceneTree::PROCESS_LIST_IDLE, data.idle_process);
 
 	_change_notify("idle_process");
 }
@@ -642,11 +675,7 @@ void Node::set_process_internal(bool p_idle_process_internal) {
 
 	data.idle_process_internal = p_idle_process_internal;
 
-	if (data.idle_process_internal) {
-		add_to_group("idle_process_internal", false);
-	} else {
-		remove_from_group("idle_process_internal");
-	}
+	_set_in_process_list(SceneTree::PROCESS_LIST_IDLE_INTERNAL, data.idle_process_internal);
 
 	_change_notify("idle_process_internal");
 }
@@ -656,6 +685,7 @@ bool Node::is_processing_internal() const {
 }
 
 void Node::set_process_priority(int p_priority) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	data.process_priority = p_priority;
 
 	// Make sure we are in SceneTree.
@@ -663,25 +693,40 @@ void Node::set_process_priority(int p_priority) {
 		return;
 	}
 
-	if (is_processing()) {
-		data.tree->make_group_changed("idle_process");
+	for (int i = 0; i < SceneTree::PROCESS_LIST_MAX; i++) {
+		if (data.process_slot[i] != -1) {
+			data.tree->_make_process_list_changed((SceneTree::ProcessListType)i);
+		}
 	}
+}
+
+int Node::get_process_priority() const {
+	return data.process_priority;
+}
 
-	if (is_processing_internal()) {
-		data.tree->make_group_changed("idle_process_internal");
+void Node::set_process_thread_group(int p_group) {
+	ERR_FAIL_COND(p_group < 0);
+	ERR_FAIL_IN_PROCESS_THREAD();
+
+	if (data.process_thread_group == p_group) {
+		return;
 	}
+	data.process_thread_group = p_group;
 
-	if (is_physics_processing()) {
-		data.tree->make_group_changed("physics_process");
+	if (data.tree == nullptr) {
+		return;
 	}
 
-	if (is_physics_processing_internal()) {
-		data.tree->make_group_changed("physics_process_internal");
+	if (data.process_slot[SceneTree::PROCESS_LIST_IDLE] != -1) {
+		data.tree->_make_process_list_changed(SceneTree::PROCESS_LIST_IDLE);
+	}
+	if (data.process_slot[SceneTree::PROCESS_LIST_PHYSICS] != -1) {
+		data.tree->_make_process_list_changed(SceneTree::PROCESS_LIST_PHYSICS);
 	}
 }
 
-int Node::get_process_priority() const {
-	return data.process_priority;
+int Node::get_process_thread_group() const {
+	return data.process_thread_group;
 }
 
 void Node::set_process_input(bool p_enable) {
@@ -762,10 +807,21 @@ StringName Node::get_name() const {
 }
 
 void Node::_set_name_nocheck(const StringName &p_name) {
+	StringName old_name = data.name;
 	data.name = p_name;
+
+	if (data.parent && data.parent->data.child_index) {
+		data.parent->_unindex_child(this, old_name);
+		data.parent->_index_child(this);
+	}
+	// Scenes name every node they instance, which were never looked up.
+	if (data.lookup_cached) {
+		_invalidate_lookups();
+	}
 }
 
 void Node::set_name(const String &p_name) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	String name = p_name.validate_node_name();
 
 	ERR_FAIL_COND(name == "");
@@ -773,10 +829,18 @@ void Node::set_name(const String &p_name) {
 	if (data.unique_name_in_owner && data.owner) {
 		_release_unique_name_in_owner();
 	}
+	StringName old_name = data.name;
 	data.name = name;
 
 	if (data.parent) {
 		data.parent->_validate_child_name(this);
+		if (data.parent->data.child_index) {
+			data.parent->_unindex_child(this, old_name);
+			data.parent->_index_child(this);
+		}
+	}
+	if (data.lookup_cached) {
+		_invalidate_lookups();
 	}
 
 	if (data.unique_name_in_owner && data.owner) {
@@ -832,19 +896,7 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
 			//new unique name must be assigned
 			unique = false;
 		} else {
-			//check if exists
-			Node **children = data.children.ptrw();
-			int cc = data.children.size();
-
-			for (int i = 0; i < cc; i++) {
-				if (children[i] == p_child) {
-					continue;
-				}
-				if (children[i]->data.name == p_child->data.name) {
-					unique = false;
-					break;
-				}
-			}
+			unique = !_is_child_name_taken(p_child->data.name, p_child);
 		}
 
 		if (!unique) {
@@ -901,24 +953,8 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
 	}
 
 	//quickly test if proposed name exists
-	int cc = data.children.size(); //children count
-	const Node *const *children_ptr = data.children.ptr();
-
-	{
-		bool exists = false;
-
-		for (int i = 0; i < cc; i++) {
-			if (children_ptr[i] == p_child) { //exclude self in renaming if its already a child
-				continue;
-			}
-			if (children_ptr[i]->data.name == name) {
-				exists = true;
-			}
-		}
-
-		if (!exists) {
-			return; //if it does not exist, it does not need validation
-		}
+	if (!_is_child_name_taken(name, p_child)) {
+		return; //if it does not exist, it does not need validation
 	}
 
 	// Extract trailing number
@@ -945,18 +981,8 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
 
 	for (;;) {
 		StringName attempt = name_string + nums;
-		bool exists = false;
-
-		for (int i = 0; i < cc; i++) {
-			if (children_ptr[i] == p_child) {
-				continue;
-			}
-			if (children_ptr[i]->data.name == attempt) {
-				exists = true;
-			}
-		}
 
-		if (!exists) {
+		if (!_is_child_name_taken(attempt, p_child)) {
 			name = attempt;
 			return;
 		} else {
@@ -978,6 +1004,12 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 	p_child->data.pos = data.children.size();
 	data.children.push_back(p_child);
 	p_child->data.parent = this;
+
+	if (data.child_index) {
+		_index_child(p_child);
+	} else if (data.children.size() >= CHILD_INDEX_MIN_CHILDREN) {
+		_build_child_index();
+	}
 	p_child->notification(NOTIFICATION_PARENTED);
 
 	if (data.tree) {
@@ -997,6 +1029,7 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 }
 
 void Node::add_child(Node *p_child, bool p_legible_unique_name) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	ERR_FAIL_NULL(p_child);
 	ERR_FAIL_COND_MSG(p_child == this, vformat("Can't add child '%s' to itself.", p_child->get_name())); // adding to itself!
 	ERR_FAIL_COND_MSG(p_child->data.parent, vformat("Can't add child '%s' to '%s', already has a parent '%s'.", p_child->get_name(), get_name(), p_child->data.parent->get_name())); //Fail if node has a parent
@@ -1025,6 +1058,7 @@ void Node::add_child_below_node(Node *p_node, Node *p_child, bool p_legible_uniq
 }
 
 void Node::remove_child(Node *p_child) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	ERR_FAIL_NULL(p_child);
 	ERR_FAIL_COND_MSG(data.blocked > 0, "Parent node is busy setting up children, remove_node() failed. Consider using call_deferred(\"remove_child\", child) instead.");
 
@@ -1060,6 +1094,18 @@ void Node::remove_child(Node *p_child) {
 
 	data.children.remove(idx);
 
+	if (data.child_index) {
+		if (data.children.size() < CHILD_INDEX_MIN_CHILDREN / 2) {
+			_clear_child_index();
+		} else {
+			_unindex_child(p_child, p_child->data.name);
+		}
+	}
+	// Lookups from outside the child's subtree to inside it went through the child.
+	if (p_child->data.lookup_cached) {
+		_invalidate_lookups();
+	}
+
 	//update pointer and size
 	child_count = data.children.size();
 	children = data.children.ptrw();
@@ -1085,6 +1131,11 @@ Node *Node::get_child(int p_index) const {
 }
 
 Node *Node::_get_child_by_name(const StringName &p_name) const {
+	if (data.child_index) {
+		Node *const *child = data.child_index->getptr(p_name);
+		return child ? *child : nullptr;
+	}
+
 	int cc = data.children.size();
 	Node *const *cd = data.children.ptr();
 
@@ -1097,6 +1148,72 @@ Node *Node::_get_child_by_name(const StringName &p_name) const {
 	return nullptr;
 }
 
+bool Node::_is_child_name_taken(const StringName &p_name, const Node *p_child) const {
+	if (data.child_index && !data.child_index_collided) {
+		Node *const *child = data.child_index->getptr(p_name);
+		return child && *child != p_child;
+	}
+
+	int cc = data.children.size();
+	Node *const *cd = data.children.ptr();
+
+	for (int i = 0; i < cc; i++) {
+		if (cd[i] != p_child && cd[i]->data.name == p_name) { // Excludes itself when renaming.
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Node::_build_child_index() {
+	data.child_index = memnew(ChildIndex);
+	data.child_index_collided = false;
+
+	for (int i = 0; i < data.children.size(); i++) {
+		_index_child(data.children[i]);
+	}
+}
+
+void Node::_clear_child_index() {
+	memdelete(data.child_index);
+	data.child_index = nullptr;
+}
+
+void Node::_index_child(Node *p_child) {
+	Node **indexed = data.child_index->getptr(p_child->data.name);
+	if (indexed) {
+		if (*indexed != p_child) {
+			data.child_index_collided = true; // Lookups find the first one, as when scanning.
+		}
+		return;
+	}
+	data.child_index->set(p_child->data.name, p_child);
+}
+
+void Node::_unindex_child(Node *p_child, const StringName &p_name) {
+	Node **indexed = data.child_index->getptr(p_name);
+	if (!indexed || *indexed != p_child) {
+		return;
+	}
+	data.child_index->erase(p_name);
+
+	if (!data.child_index_collided) {
+		return;
+	}
+	for (int i = 0; i < data.children.size(); i++) {
+		Node *child = data.children[i];
+		if (child != p_child && child->data.name == p_name) {
+			data.child_index->set(p_name, child);
+			break;
+		}
+	}
+}
+
+void Node::_invalidate_lookups() {
+	lookup_version.increment();
+}
+
 Node *Node::get_node_or_null(const NodePath &p_path) const {
 	if (p_path.is_empty()) {
 		return nullptr;
@@ -1104,6 +1221,20 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 
 	ERR_FAIL_COND_V_MSG(!data.inside_tree && p_path.is_absolute(), nullptr, "Can't use get_node() with absolute paths from outside the active scene tree.");
 
+	// Single names are cheap to resolve already. Other threads may be looking up from the same node,
+	// so only the main thread uses the cache.
+	bool cacheable = p_path.get_name_count() > 1 && Thread::get_caller_id() == Thread::get_main_id();
+	uint64_t version = lookup_version.get();
+
+	if (cacheable && data.lookup_cache && data.lookup_cache->version == version) {
+		const LookupCache *cache = data.lookup_cache;
+		for (int i = 0; i < LOOKUP_CACHE_SIZE; i++) {
+			if (cache->nodes[i] && cache->paths[i] == p_path) {
+				return cache->nodes[i];
+			}
+		}
+	}
+
 	Node *current = nullptr;
 	Node *root = nullptr;
 
@@ -1120,6 +1251,10 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 		StringName name = p_path.get_name(i);
 		Node *next = nullptr;
 
+		if (cacheable && current) {
+			current->data.lookup_cached = true;
+		}
+
 		if (name == SceneStringNames::get_singleton()->dot) { // .
 
 			next = current;
@@ -1155,16 +1290,7 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 			}
 
 		} else {
-			next = nullptr;
-
-			for (int j = 0; j < current->data.children.size(); j++) {
-				Node *child = current->data.children[j];
-
-				if (child->data.name == name) {
-					next = child;
-					break;
-				}
-			}
+			next = current->_get_child_by_name(name);
 			if (next == nullptr) {
 				return nullptr;
 			};
@@ -1172,6 +1298,25 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 		current = next;
 	}
 
+	if (cacheable && current) {
+		if (!data.lookup_cache) {
+			data.lookup_cache = memnew(LookupCache);
+		}
+		LookupCache *cache = data.lookup_cache;
+		if (cache->version != version) {
+			for (int i = 0; i < LOOKUP_CACHE_SIZE; i++) {
+				cache->paths[i] = NodePath();
+				cache->nodes[i] = nullptr;
+			}
+			cache->version = version;
+			cache->next = 0;
+		}
+		current->data.lookup_cached = true;
+		cache->paths[cache->next] = p_path;
+		cache->nodes[cache->next] = current;
+		cache->next = (cache->next + 1) % LOOKUP_CACHE_SIZE;
+	}
+
 	return current;
 }
 
@@ -1351,6 +1496,7 @@ void Node::_release_unique_name_in_owner() {
 		return; // Ignore.
 	}
 	data.owner->data.owned_unique_nodes.erase(key);
+	_invalidate_lookups();
 }
 
 void Node::_acquire_unique_name_in_owner() {
@@ -1387,6 +1533,8 @@ bool Node::is_unique_name_in_owner() const {
 }
 
 void Node::set_owner(Node *p_owner) {
+	ERR_FAIL_IN_PROCESS_THREAD();
+	_invalidate_lookups(); // Unique names are looked up in the owner.
 	if (data.owner) {
 		if (data.unique_name_in_owner) {
 			_release_unique_name_in_owner();
@@ -1535,6 +1683,7 @@ bool Node::is_in_group(const StringName &p_identifier) const {
 }
 
 void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	ERR_FAIL_COND(!p_identifier.operator String().length());
 
 	if (data.grouped.has(p_identifier)) {
@@ -1555,6 +1704,7 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 }
 
 void Node::remove_from_group(const StringName &p_identifier) {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	ERR_FAIL_COND(!data.grouped.has(p_identifier));
 
 	Map<StringName, GroupData>::Element *E = data.grouped.find(p_identifier);
@@ -2590,6 +2740,7 @@ void Node::print_stray_nodes() {
 }
 
 void Node::queue_delete() {
+	ERR_FAIL_IN_PROCESS_THREAD();
 	if (is_inside_tree()) {
 		get_tree()->queue_delete(this);
 	} else {
@@ -2741,6 +2892,8 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_process", "enable"), &Node::set_process);
 	ClassDB::bind_method(D_METHOD("set_process_priority", "priority"), &Node::set_process_priority);
 	ClassDB::bind_method(D_METHOD("get_process_priority"), &Node::get_process_priority);
+	ClassDB::bind_method(D_METHOD("set_process_thread_group", "group"), &Node::set_process_thread_group);
+	ClassDB::bind_method(D_METHOD("get_process_thread_group"), &Node::get_process_thread_group);
 	ClassDB::bind_method(D_METHOD("is_processing"), &Node::is_processing);
 	ClassDB::bind_method(D_METHOD("set_process_input", "enable"), &Node::set_process_input);
 	ClassDB::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
@@ -2868,6 +3021,7 @@ void Node::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "filename", PROPERTY_HINT_NONE, "", 0), "set_filename", "get_filename");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "owner", PROPERTY_HINT_RESOURCE_TYPE, "Node", 0), "set_owner", "get_owner");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_priority"), "set_process_priority", "get_process_priority");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_thread_group", PROPERTY_HINT_RANGE, "0,64,1,or_greater"), "set_process_thread_group", "get_process_thread_group");
 
 	BIND_VMETHOD(MethodInfo("_process", PropertyInfo(Variant::REAL, "delta")));
 	BIND_VMETHOD(MethodInfo("_physics_process", PropertyInfo(Variant::REAL, "delta")));
@@ -2903,6 +3057,7 @@ Node::Node() {
 	data.physics_process = false;
 	data.idle_process = false;
 	data.process_priority = 0;
+	data.process_thread_group = 0;
 	data.physics_process_internal = false;
 	data.idle_process_internal = false;
 	data.inside_tree = false;
@@ -2920,7 +3075,15 @@ Node::Node() {
 	data.pause_mode = PAUSE_MODE_INHERIT;
 	data.physics_interpolation_mode = PHYSICS_INTERPOLATION_MODE_INHERIT;
 	data.pause_owner = nullptr;
+	data.process_paused = false;
+	for (int i = 0; i < SceneTree::PROCESS_LIST_MAX; i++) {
+		data.process_slot[i] = -1;
+	}
 	data.path_cache = nullptr;
+	data.child_index = nullptr;
+	data.child_index_collided = false;
+	data.lookup_cache = nullptr;
+	data.lookup_cached = false;
 	data.parent_owned = false;
 	data.in_constructor = true;
 	data.viewport = nullptr;
@@ -2940,6 +3103,13 @@ Node::~Node() {
 	ERR_FAIL_COND(data.parent);
 	ERR_FAIL_COND(data.children.size());
 
+	if (data.child_index) {
+		_clear_child_index();
+	}
+	if (data.lookup_cache) {
+		memdelete(data.lookup_cache);
+	}
+
 	orphan_node_count--;
 }
 
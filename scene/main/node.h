@@ -65,9 +65,39 @@ public:
 		bool operator()(const Node *p_a, const Node *p_b) const { return p_b->data.process_priority == p_a->data.process_priority ? p_b->is_greater_than(p_a) : p_b->data.process_priority > p_a->data.process_priority; }
 	};
 
+	// Keeps the nodes of a process thread group together within a priority.
+	struct ComparatorWithProcessThreadGroup {
+		bool operator()(const Node *p_a, const Node *p_b) const {
+			if (p_a->data.process_priority != p_b->data.process_priority) {
+				return p_a->data.process_priority < p_b->data.process_priority;
+			}
+			if (p_a->data.process_thread_group != p_b->data.process_thread_group) {
+				return p_a->data.process_thread_group < p_b->data.process_thread_group;
+			}
+			return p_b->is_greater_than(p_a);
+		}
+	};
+
 	static int orphan_node_count;
 
 private:
+	enum {
+		CHILD_INDEX_MIN_CHILDREN = 32, // Children are looked up by scanning below this count.
+		LOOKUP_CACHE_SIZE = 8,
+	};
+
+	typedef HashMap<StringName, Node *> ChildIndex;
+
+	// Nodes found by get_node() from this node. Entries are only valid for the lookup version they
+	// were resolved in, which changes whenever a node that a cached lookup went through is removed
+	// or renamed, or a node changes owner.
+	struct LookupCache {
+		uint64_t version = 0;
+		uint32_t next = 0;
+		NodePath paths[LOOKUP_CACHE_SIZE];
+		Node *nodes[LOOKUP_CACHE_SIZE] = {};
+	};
+
 	struct GroupData {
 		bool persistent;
 		SceneTree::Group *group;
@@ -82,6 +112,7 @@ private:
 		Node *parent;
 		Node *owner;
 		Vector<Node *> children; // list of children
+		ChildIndex *child_index; // Children by name, once there are many of them.
 		HashMap<StringName, Node *> owned_unique_nodes;
 		bool unique_name_in_owner = false;
 
@@ -103,6 +134,7 @@ private:
 		Node *pause_owner;
 
 		int process_priority;
+		int process_thread_group; // 0 for the main thread.
 
 		// Keep bitpacked values together to get better packing
 		PauseMode pause_mode : 2;
@@ -151,7 +183,17 @@ private:
 		bool ready_notified : 1; //this is a small hack, so if a node is added during _ready() to the tree, it correctly gets the _ready() notification
 		bool ready_first : 1;
 
+		// Resolved when the pause state of the tree or the pause owner changes, see can_process().
+		bool process_paused : 1;
+
+		// Unchecked names (see _add_child_nocheck()) may be repeated, only the first is indexed.
+		bool child_index_collided : 1;
+
+		int process_slot[SceneTree::PROCESS_LIST_MAX]; // In the process lists of the tree, -1 if not in them.
+
 		mutable NodePath *path_cache;
+		mutable LookupCache *lookup_cache;
+		bool lookup_cached; // A cached lookup went through this node, renaming or removing it invalidates them.
 
 	} data;
 
@@ -159,6 +201,13 @@ private:
 	void _print_tree(const Node *p_node);
 
 	Node *_get_child_by_name(const StringName &p_name) const;
+	bool _is_child_name_taken(const StringName &p_name, const Node *p_child) const;
+
+	void _build_child_index();
+	void _clear_child_index();
+	void _index_child(Node *p_child);
+	void _unindex_child(Node *p_child, const StringName &p_name);
+	static void _invalidate_lookups();
 
 	void _replace_connections_target(Node *p_new_target);
 
@@ -175,6 +224,8 @@ private:
 	void _propagate_physics_interpolation_reset_requested();
 	void _print_stray_nodes();
 	void _propagate_pause_owner(Node *p_owner);
+	void _update_process_paused();
+	void _set_in_process_list(SceneTree::ProcessListType p_type, bool p_enabled);
 	Array _get_node_and_resource(const NodePath &p_path);
 
 	void _duplicate_signals(const Node *p_original, Node *p_copy) const;
@@ -367,6 +418,16 @@ public:
 	void set_process_priority(int p_priority);
 	int get_process_priority() const;
 
+	// Nodes of a group other than 0 are processed (but not internally) on worker threads, in
+	// parallel with the other nodes of the group. They may only change themselves: the tree must
+	// not be changed and deferred calls are run once the group is done. Worker threads are only
+	// used when the rendering and 2D physics servers run on threads of their own
+	// ("rendering/threads/thread_model" and "physics/2d/thread_model" set to Multi-Threaded), so
+	// calls to them are queued without waiting for the main thread. Otherwise the groups are
+	// processed on the main thread. The same applies to group calls made with GROUP_CALL_THREADED.
+	void set_process_thread_group(int p_group);
+	int get_process_thread_group() const;
+
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
 
@@ -0,0 +1,219 @@
+/**************************************************************************/
+/*  node_pool.cpp                                                         */
+/**************************************************************************/
+
+
+#include "node_pool.h"
+
+#include "core/os/frame_profiler.h"
+#include "scene/main/scene_tree.h"
+
+Node *NodePool::_create() {
+	Node *node = scene->instance();
+	ERR_FAIL_COND_V(!node, nullptr);
+
+	if (defaults.empty()) {
+		_take_defaults(node);
+	}
+	return node;
+}
+
+void NodePool::_take_defaults(Node *p_root) {
+	root_name = p_root->get_name();
+
+	List<Node *> stack;
+	stack.push_back(p_root);
+	while (stack.size()) {
+		Node *node = stack.front()->get();
+		stack.pop_front();
+
+		NodeDefaults nd;
+		nd.path = p_root->get_path_to(node);
+
+		List<PropertyInfo> properties;
+		node->get_property_list(&properties);
+		for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next()) {
+			const PropertyInfo &pi = E->get();
+			if (!(pi.usage & PROPERTY_USAGE_STORAGE) || pi.name == "script") {
+				continue;
+			}
+			Variant value = node->get(pi.name);
+			if (value.get_type() == Variant::OBJECT) {
+				continue;
+			}
+			nd.names.push_back(pi.name);
+			nd.values.push_back(value);
+		}
+		defaults.push_back(nd);
+
+		for (int i = 0; i < node->get_child_count(); i++) {
+			stack.push_back(node->get_child(i));
+		}
+	}
+}
+
+void NodePool::_reset(Node *p_root) {
+	FRAME_PROFILE_SCOPE("NodePool::reset");
+
+	// Renamed if there was a sibling with the same name.
+	p_root->set_name(root_name);
+
+	for (int i = 0; i < defaults.size(); i++) {
+		const NodeDefaults &nd = defaults[i];
+		Node *node = i == 0 ? p_root : p_root->get_node_or_null(nd.path);
+		if (!node) {
+			continue; // Removed after instancing.
+		}
+
+		// Setters may do more than store the value, so only the changed ones are called.
+		for (int j = 0; j < nd.names.size(); j++) {
+			bool valid = false;
+			Variant current = node->get(nd.names[j], &valid);
+			if (valid && current != nd.values[j]) {
+				node->set(nd.names[j], nd.values[j]);
+			}
+		}
+
+		node->request_ready();
+	}
+}
+
+void NodePool::set_scene(const Ref<PackedScene> &p_scene) {
+	if (scene == p_scene) {
+		return;
+	}
+
+	// Instances of the previous scene still in use aren't taken back.
+	clear();
+	in_use.clear();
+	defaults.clear();
+	scene = p_scene;
+}
+
+Ref<PackedScene> NodePool::get_scene() const {
+	return scene;
+}
+
+void NodePool::set_max_size(int p_size) {
+	ERR_FAIL_COND(p_size < 0);
+	max_size = p_size;
+
+	while (max_size > 0 && available.size() > max_size) {
+		memdelete(available[available.size() - 1]);
+		available.resize(available.size() - 1);
+	}
+}
+
+int NodePool::get_max_size() const {
+	return max_size;
+}
+
+Node *NodePool::acquire() {
+	ERR_FAIL_COND_V_MSG(scene.is_null(), nullptr, "The pool has no scene to instance.");
+
+	Node *node;
+	if (available.size()) {
+		node = available[available.size() - 1];
+		available.resize(available.size() - 1);
+		hits++;
+	} else {
+		node = _create();
+		ERR_FAIL_COND_V(!node, nullptr);
+		misses++;
+	}
+
+	in_use.insert(node->get_instance_id());
+	return node;
+}
+
+void NodePool::release(Node *p_node) {
+	ERR_FAIL_NULL(p_node);
+	ERR_FAIL_COND_MSG(!in_use.has(p_node->get_instance_id()), "The node wasn't acquired from this pool.");
+	in_use.erase(p_node->get_instance_id());
+
+	if (p_node->get_parent()) {
+		p_node->get_parent()->remove_child(p_node);
+	}
+
+	if (max_size > 0 && available.size() >= max_size) {
+		// May be released from one of its own methods.
+		if (SceneTree::get_singleton()) {
+			p_node->queue_delete();
+		} else {
+			memdelete(p_node);
+		}
+		return;
+	}
+
+	_reset(p_node);
+	available.push_back(p_node);
+}
+
+void NodePool::prewarm(int p_count) {
+	ERR_FAIL_COND_MSG(scene.is_null(), "The pool has no scene to instance.");
+
+	while (available.size() < p_count && (max_size == 0 || available.size() < max_size)) {
+		Node *node = _create();
+		ERR_FAIL_COND(!node);
+		available.push_back(node);
+	}
+}
+
+void NodePool::clear() {
+	for (int i = 0; i < available.size(); i++) {
+		memdelete(available[i]);
+	}
+	available.clear();
+}
+
+int NodePool::get_available_count() const {
+	return available.size();
+}
+
+int NodePool::get_in_use_count() const {
+	return in_use.size();
+}
+
+uint64_t NodePool::get_hit_count() const {
+	return hits;
+}
+
+uint64_t NodePool::get_miss_count() const {
+	return misses;
+}
+
+void NodePool::reset_stats() {
+	hits = 0;
+	misses = 0;
+}
+
+void NodePool::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_scene", "scene"), &NodePool::set_scene);
+	ClassDB::bind_method(D_METHOD("get_scene"), &NodePool::get_scene);
+	ClassDB::bind_method(D_METHOD("set_max_size", "size"), &NodePool::set_max_size);
+	ClassDB::bind_method(D_METHOD("get_max_size"), &NodePool::get_max_size);
+
+	ClassDB::bind_method(D_METHOD("acquire"), &NodePool::acquire);
+	ClassDB::bind_method(D_METHOD("release", "node"), &NodePool::release);
+	ClassDB::bind_method(D_METHOD("prewarm", "count"), &NodePool::prewarm);
+	ClassDB::bind_method(D_METHOD("clear"), &NodePool::clear);
+
+	ClassDB::bind_method(D_METHOD("get_available_count"), &NodePool::get_available_count);
+	ClassDB::bind_method(D_METHOD("get_in_use_count"), &NodePool::get_in_use_count);
+	ClassDB::bind_method(D_METHOD("get_hit_count"), &NodePool::get_hit_count);
+	ClassDB::bind_method(D_METHOD("get_miss_count"), &NodePool::get_miss_count);
+	ClassDB::bind_method(D_METHOD("reset_stats"), &NodePool::reset_stats);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "scene", PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"), "set_scene", "get_scene");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_size", PROPERTY_HINT_RANGE, "0,65536,1,or_greater"), "set_max_size", "get_max_size");
+}
+
+NodePool::NodePool() {
+	max_size = 0;
+	hits = 0;
+	misses = 0;
+}
+
+NodePool::~NodePool() {
+	clear();
+}
@@ -0,0 +1,71 @@
+/**************************************************************************/
+/*  node_pool.h                                                           */
+/**************************************************************************/
+
+
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include "core/reference.h"
+#include "core/set.h"
+#include "scene/resources/packed_scene.h"
+
+// Recycles the instances of a scene that is spawned and freed often, such as projectiles.
+// Released instances are taken out of the tree, which takes them out of the world but keeps
+// their server resources, and their stored properties are reset to the values of a new instance.
+// Properties holding objects are left alone, as every instance may have its own copies of local
+// resources, and so are the signals connected and the nodes added after instancing.
+class NodePool : public Reference {
+	GDCLASS(NodePool, Reference);
+
+	struct NodeDefaults {
+		NodePath path; // From the root of the instance.
+		Vector<StringName> names;
+		Vector<Variant> values;
+	};
+
+	Ref<PackedScene> scene;
+	int max_size; // 0 for no limit.
+
+	Vector<Node *> available;
+	Set<ObjectID> in_use;
+
+	// Taken from the first instance.
+	Vector<NodeDefaults> defaults;
+	StringName root_name;
+
+	uint64_t hits;
+	uint64_t misses;
+
+	Node *_create();
+	void _take_defaults(Node *p_root);
+	void _reset(Node *p_root);
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_scene(const Ref<PackedScene> &p_scene);
+	Ref<PackedScene> get_scene() const;
+
+	void set_max_size(int p_size);
+	int get_max_size() const;
+
+	Node *acquire();
+	void release(Node *p_node);
+
+	void prewarm(int p_count);
+	void clear();
+
+	int get_available_count() const;
+	int get_in_use_count() const;
+
+	uint64_t get_hit_count() const;
+	uint64_t get_miss_count() const;
+	void reset_stats();
+
+	NodePool();
+	~NodePool();
+};
+
+#endif // NODE_POOL_H
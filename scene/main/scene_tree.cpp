@@ -5,16 +5,19 @@
 
 #include "scene_tree.h"
 
+#include "core/core_string_names.h"
 #include "core/io/marshalls.h"
 #include "core/io/resource_loader.h"
 #include "core/message_queue.h"
 #include "core/os/dir_access.h"
+#include "core/os/frame_profiler.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
 #include "main/input_default.h"
 #include "node.h"
+#include "scene/2d/canvas_item.h"
 #include "scene/debugger/script_debugger_remote.h"
 #include "scene/resources/dynamic_font.h"
 #include "scene/resources/material.h"
@@ -23,6 +26,7 @@
 #include "scene/scene_string_names.h"
 #include "servers/navigation_server.h"
 #include "servers/physics_2d_server.h"
+#include "servers/visual_server.h"
 #include "viewport.h"
 
 #include "modules/modules_enabled.gen.h" // For freetype.
@@ -93,6 +97,165 @@ SceneTreeTimer::SceneTreeTimer() {
 	process_pause = true;
 }
 
+// The instancing thread may be blocked on a call that needs the main thread to flush the commands
+// it sent to the visual server, which isn't the case when rendering on a separate thread.
+static void _help_instance_thread() {
+	if (OS::get_singleton()->get_render_thread_mode() == OS::RENDER_THREAD_SAFE) {
+		VisualServer::get_singleton()->sync();
+	}
+	OS::get_singleton()->delay_usec(100);
+}
+
+void SceneInstanceTask::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_status"), &SceneInstanceTask::get_status);
+	ClassDB::bind_method(D_METHOD("is_done"), &SceneInstanceTask::is_done);
+	ClassDB::bind_method(D_METHOD("get_scene"), &SceneInstanceTask::get_scene);
+	ClassDB::bind_method(D_METHOD("get_node"), &SceneInstanceTask::get_node);
+	ClassDB::bind_method(D_METHOD("wait"), &SceneInstanceTask::wait);
+	ClassDB::bind_method(D_METHOD("cancel"), &SceneInstanceTask::cancel);
+
+	ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::OBJECT, "node", PROPERTY_HINT_RESOURCE_TYPE, "Node")));
+
+	BIND_ENUM_CONSTANT(STATUS_QUEUED);
+	BIND_ENUM_CONSTANT(STATUS_BUILT);
+	BIND_ENUM_CONSTANT(STATUS_DONE);
+	BIND_ENUM_CONSTANT(STATUS_FAILED);
+	BIND_ENUM_CONSTANT(STATUS_CANCELED);
+}
+
+// May run on the instancing thread, so the task must not be touched once the status is set.
+static int _count_nodes(const Node *p_node) {
+	int count = 1;
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		count += _count_nodes(p_node->get_child(i));
+	}
+	return count;
+}
+
+void SceneInstanceTask::_build() {
+	FRAME_PROFILE_SCOPE("SceneInstanceTask::build");
+	node = scene->instance();
+	if (node) {
+		node_count = _count_nodes(node);
+	}
+	status.set(node ? STATUS_BUILT : STATUS_FAILED);
+}
+
+void SceneInstanceTask::_ensure_built() {
+	if (status.get() != STATUS_QUEUED) {
+		return;
+	}
+
+	if (threaded) {
+		SceneTree *tree = SceneTree::get_singleton();
+		tree->instance_mutex.lock();
+		bool taken_back = tree->instance_build_queue.erase(this);
+		tree->instance_mutex.unlock();
+
+		if (!taken_back) {
+			while (status.get() == STATUS_QUEUED) {
+				_help_instance_thread();
+			}
+			return;
+		}
+	}
+
+	_build();
+}
+
+void SceneInstanceTask::_commit() {
+	if (status.get() != STATUS_BUILT) {
+		return;
+	}
+
+	if (parent_id) {
+		Node *parent = Object::cast_to<Node>(ObjectDB::get_instance(parent_id));
+		if (!parent) {
+			_discard(STATUS_FAILED); // Freed while the scene was being built.
+			return;
+		}
+		parent->add_child(node);
+	}
+
+	// From now on the node belongs to its parent or to the caller.
+	node_id = node->get_instance_id();
+	node = nullptr;
+	status.set(STATUS_DONE);
+	emit_signal("completed", ObjectDB::get_instance(node_id));
+}
+
+void SceneInstanceTask::_discard(Status p_status) {
+	if (node) {
+		memdelete(node);
+		node = nullptr;
+	}
+	status.set(p_status);
+}
+
+SceneInstanceTask::Status SceneInstanceTask::get_status() const {
+	return (Status)status.get();
+}
+
+bool SceneInstanceTask::is_done() const {
+	return status.get() == STATUS_DONE;
+}
+
+Ref<PackedScene> SceneInstanceTask::get_scene() const {
+	return scene;
+}
+
+Node *SceneInstanceTask::get_node() const {
+	if (status.get() != STATUS_DONE) {
+		return nullptr;
+	}
+	return Object::cast_to<Node>(ObjectDB::get_instance(node_id));
+}
+
+// Builds and commits the scene right away, ignoring the frame budget.
+Node *SceneInstanceTask::wait() {
+	ERR_FAIL_COND_V_MSG(Thread::get_caller_id() != Thread::get_main_id(), nullptr, "Asynchronous instances can only be waited for from the main thread.");
+
+	_ensure_built();
+	_commit();
+	return get_node();
+}
+
+void SceneInstanceTask::cancel() {
+	ERR_FAIL_COND_MSG(Thread::get_caller_id() != Thread::get_main_id(), "Asynchronous instances can only be canceled from the main thread.");
+
+	uint32_t current = status.get();
+	if (current == STATUS_QUEUED && threaded) {
+		SceneTree *tree = SceneTree::get_singleton();
+		tree->instance_mutex.lock();
+		bool taken_back = tree->instance_build_queue.erase(this);
+		tree->instance_mutex.unlock();
+
+		if (!taken_back) {
+			_ensure_built(); // Already being built, wait for it to be freed.
+		}
+		current = status.get();
+	}
+
+	if (current == STATUS_QUEUED || current == STATUS_BUILT) {
+		_discard(STATUS_CANCELED);
+	}
+}
+
+SceneInstanceTask::SceneInstanceTask() {
+	parent_id = 0;
+	threaded = false;
+	status.set(STATUS_QUEUED);
+	node = nullptr;
+	node_count = 0;
+	node_id = 0;
+}
+
+SceneInstanceTask::~SceneInstanceTask() {
+	if (node) {
+		memdelete(node);
+	}
+}
+
 // This should be called once per physics tick, to make sure the transform previous and current
 // is kept up to date on the few spatials that are using client side physics interpolation
 void SceneTree::ClientPhysicsInterpolation::physics_process() {
@@ -122,32 +285,36 @@ void SceneTree::node_renamed(Node *p_node) {
 }
 
 SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
-		E = group_map.insert(p_group, Group());
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
+		group_map.set(p_group, Group());
+		g = group_map.getptr(p_group);
 	}
 
-	ERR_FAIL_COND_V_MSG(E->get().nodes.find(p_node) != -1, &E->get(), "Already in group: " + p_group + ".");
-	E->get().nodes.push_back(p_node);
-	//E->get().last_tree_version=0;
-	E->get().changed = true;
-	return &E->get();
+#ifdef DEBUG_ENABLED
+	// Nodes check their own groups first, this is a linear search.
+	ERR_FAIL_COND_V_MSG(g->nodes.find(p_node) != -1, g, "Already in group: " + p_group + ".");
+#endif
+	g->nodes.push_back(p_node);
+	//g->last_tree_version=0;
+	g->changed = true;
+	return g;
 }
 
 void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	ERR_FAIL_COND(!E);
+	Group *g = group_map.getptr(p_group);
+	ERR_FAIL_COND(!g);
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.empty()) {
-		group_map.erase(E);
+	g->nodes.erase(p_node);
+	if (g->nodes.empty()) {
+		group_map.erase(p_group);
 	}
 }
 
 void SceneTree::make_group_changed(const StringName &p_group) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (E) {
-		E->get().changed = true;
+	Group *g = group_map.getptr(p_group);
+	if (g) {
+		g->changed = true;
 	}
 }
 
@@ -162,6 +329,36 @@ void SceneTree::flush_transform_notifications() {
 	}
 }
 
+void SceneTree::_flush_canvas_transforms() {
+	if (!canvas_transform_list.first()) {
+		return;
+	}
+
+	FRAME_PROFILE_SCOPE("SceneTree::flush_canvas_transforms");
+
+	int count = 0;
+	for (SelfList<Node> *n = canvas_transform_list.first(); n; n = n->next()) {
+		count++;
+	}
+
+	Vector<RID> items;
+	Vector<Transform2D> transforms;
+	items.resize(count);
+	transforms.resize(count);
+	RID *items_w = items.ptrw();
+	Transform2D *transforms_w = transforms.ptrw();
+
+	for (int i = 0; i < count; i++) {
+		SelfList<Node> *n = canvas_transform_list.first();
+		CanvasItem *ci = static_cast<CanvasItem *>(n->self());
+		items_w[i] = ci->get_canvas_item();
+		transforms_w[i] = ci->get_transform();
+		canvas_transform_list.remove(n);
+	}
+
+	VisualServer::get_singleton()->canvas_item_set_transforms(items, transforms);
+}
+
 void SceneTree::_flush_ugc() {
 	ugc_locked = true;
 
@@ -204,11 +401,11 @@ void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
 }
 
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *group = group_map.getptr(p_group);
+	if (!group) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *group;
 	if (g.nodes.empty()) {
 		return;
 	}
@@ -240,47 +437,65 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 
 	_update_group_order(g);
 
+	// Shares the nodes with the group unless they change during the calls.
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
-	call_lock++;
+	VARIANT_ARGPTRS;
+	int argc = 0;
+	while (argc < VARIANT_ARG_MAX && argptr[argc]->get_type() != Variant::NIL) {
+		argc++;
+	}
 
-	if (p_call_flags & GROUP_CALL_REVERSE) {
-		for (int i = node_count - 1; i >= 0; i--) {
-			if (call_lock && call_skip.has(nodes[i])) {
-				continue;
-			}
+	// Nodes without a script are called through the method of their class, looked up once for
+	// every run of nodes of the same class.
+	StringName method_class;
+	MethodBind *method = nullptr;
 
-			if (p_call_flags & GROUP_CALL_REALTIME) {
-				if (p_call_flags & GROUP_CALL_MULTILEVEL) {
-					nodes[i]->call_multilevel(p_function, VARIANT_ARG_PASS);
-				} else {
-					nodes[i]->call(p_function, VARIANT_ARG_PASS);
-				}
-			} else {
-				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
-			}
-		}
+	// Methods called from the process threads are held to the same rules as processing, so threaded
+	// calls need the servers to be safe to call from them as well.
+	bool threaded = (p_call_flags & GROUP_CALL_THREADED) && (p_call_flags & GROUP_CALL_REALTIME) && !(p_call_flags & GROUP_CALL_MULTILEVEL) && process_threads_allowed && !is_in_process_thread();
+	LocalVector<Node *> threaded_nodes;
 
-	} else {
-		for (int i = 0; i < node_count; i++) {
-			if (call_lock && call_skip.has(nodes[i])) {
-				continue;
-			}
+	call_lock++;
 
-			if (p_call_flags & GROUP_CALL_REALTIME) {
-				if (p_call_flags & GROUP_CALL_MULTILEVEL) {
-					nodes[i]->call_multilevel(p_function, VARIANT_ARG_PASS);
-				} else {
-					nodes[i]->call(p_function, VARIANT_ARG_PASS);
+	for (int n = 0; n < node_count; n++) {
+		Node *node = nodes[(p_call_flags & GROUP_CALL_REVERSE) ? node_count - 1 - n : n];
+		if (call_skip.has(node)) {
+			continue;
+		}
+
+		if (!(p_call_flags & GROUP_CALL_REALTIME)) {
+			MessageQueue::get_singleton()->push_call(node, p_function, VARIANT_ARG_PASS);
+		} else if (p_call_flags & GROUP_CALL_MULTILEVEL) {
+			node->call_multilevel(p_function, argptr, argc);
+		} else if (threaded && node->get_process_thread_group() != 0) {
+			threaded_nodes.push_back(node);
+		} else {
+			Variant::CallError ce;
+			if (!node->get_script_instance()) {
+				const StringName &class_name = node->get_class_name();
+				if (class_name != method_class) {
+					method_class = class_name;
+					method = ClassDB::get_method(class_name, p_function);
+				}
+				if (method) {
+#ifdef DEBUG_ENABLED
+					_ObjectDebugLock debug_lock(node);
+#endif
+					method->call(node, argptr, argc, ce);
+					continue;
 				}
-			} else {
-				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
 			}
+			node->call(p_function, argptr, argc, ce);
 		}
 	}
 
+	if (threaded_nodes.size()) {
+		_call_process_batch(threaded_nodes.ptr(), threaded_nodes.size(), p_function, argptr, argc);
+	}
+
 	call_lock--;
 	if (call_lock == 0) {
 		call_skip.clear();
@@ -288,11 +503,11 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 }
 
 void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_group, int p_notification) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *group = group_map.getptr(p_group);
+	if (!group) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *group;
 	if (g.nodes.empty()) {
 		return;
 	}
@@ -339,11 +554,11 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 }
 
 void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group, const String &p_name, const Variant &p_value) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *group = group_map.getptr(p_group);
+	if (!group) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *group;
 	if (g.nodes.empty()) {
 		return;
 	}
@@ -496,6 +711,8 @@ void SceneTree::iteration_end() {
 }
 
 bool SceneTree::iteration(float p_time) {
+	FRAME_PROFILE_SCOPE("SceneTree::iteration");
+
 	root_lock++;
 
 	current_frame++;
@@ -516,11 +733,11 @@ bool SceneTree::iteration(float p_time) {
 
 	emit_signal("physics_frame");
 
-	_notify_group_pause("physics_process_internal", Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
+	_notify_process_list(PROCESS_LIST_PHYSICS_INTERNAL, Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
 	if (GLOBAL_GET("physics/common/enable_pause_aware_picking")) {
 		call_group_flags(GROUP_CALL_REALTIME, "_viewports", "_process_picking", true);
 	}
-	_notify_group_pause("physics_process", Node::NOTIFICATION_PHYSICS_PROCESS);
+	_notify_process_list(PROCESS_LIST_PHYSICS, Node::NOTIFICATION_PHYSICS_PROCESS);
 	_flush_ugc();
 	MessageQueue::get_singleton()->flush(); //small little hack
 
@@ -544,6 +761,8 @@ void SceneTree::_update_font_oversampling(float p_ratio) {
 }
 
 bool SceneTree::idle(float p_time) {
+	FRAME_PROFILE_SCOPE("SceneTree::idle");
+
 	//print_line("ram: "+itos(OS::get_singleton()->get_static_memory_usage())+" sram: "+itos(OS::get_singleton()->get_dynamic_memory_usage()));
 	//print_line("node count: "+itos(get_node_count()));
 	//print_line("TEXTURE RAM: "+itos(VS::get_singleton()->get_render_info(VS::INFO_TEXTURE_MEM_USED)));
@@ -560,8 +779,8 @@ bool SceneTree::idle(float p_time) {
 
 	flush_transform_notifications();
 
-	_notify_group_pause("idle_process_internal", Node::NOTIFICATION_INTERNAL_PROCESS);
-	_notify_group_pause("idle_process", Node::NOTIFICATION_PROCESS);
+	_notify_process_list(PROCESS_LIST_IDLE_INTERNAL, Node::NOTIFICATION_INTERNAL_PROCESS);
+	_notify_process_list(PROCESS_LIST_IDLE, Node::NOTIFICATION_PROCESS);
 
 	Size2 win_size = OS::get_singleton()->get_window_size();
 
@@ -579,6 +798,9 @@ bool SceneTree::idle(float p_time) {
 	root_lock--;
 
 	_flush_delete_queue();
+	_flush_graveyard(false);
+
+	_flush_instance_tasks();
 
 	//go through timers
 
@@ -654,8 +876,18 @@ bool SceneTree::idle(float p_time) {
 	return _quit;
 }
 
+// After the deferred calls of the frame have been flushed, right before drawing, so everything that
+// moved during the frame is drawn where it ended up.
+void SceneTree::idle_end() {
+	_flush_canvas_transforms();
+}
+
 void SceneTree::finish() {
+	_finish_instance_tasks();
+	_finish_process_threads();
+
 	_flush_delete_queue();
+	_flush_graveyard(true);
 
 	_flush_ugc();
 
@@ -673,6 +905,7 @@ void SceneTree::finish() {
 	// In case deletion of some objects was queued when destructing the `root`.
 	// E.g. if `queue_free()` was called for some node outside the tree when handling NOTIFICATION_PREDELETE for some node in the tree.
 	_flush_delete_queue();
+	_flush_graveyard(true);
 
 	// Cleanup timers.
 	for (List<Ref<SceneTreeTimer>>::Element *E = timers.front(); E; E = E->next()) {
@@ -916,11 +1149,11 @@ bool SceneTree::is_paused() const {
 }
 
 void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *group = group_map.getptr(p_group);
+	if (!group) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *group;
 	if (g.nodes.empty()) {
 		return;
 	}
@@ -963,50 +1196,228 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 	}
 }
 
-void SceneTree::_notify_group_pause(const StringName &p_group, int p_notification) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
-		return;
+void SceneTree::_add_to_process_list(ProcessListType p_type, Node *p_node) {
+	ProcessList &list = process_lists[p_type];
+	ERR_FAIL_COND(p_node->data.process_slot[p_type] != -1);
+
+	// Pending slots are stored as -2 - index.
+	p_node->data.process_slot[p_type] = -2 - (int)list.pending.size();
+	list.pending.push_back(p_node);
+}
+
+void SceneTree::_remove_from_process_list(ProcessListType p_type, Node *p_node) {
+	ProcessList &list = process_lists[p_type];
+	int slot = p_node->data.process_slot[p_type];
+	ERR_FAIL_COND(slot == -1);
+	p_node->data.process_slot[p_type] = -1;
+
+	if (slot >= 0) {
+		list.nodes[slot] = nullptr;
+		list.removed++;
+	} else {
+		// Pending nodes haven't been notified yet, so their order doesn't matter.
+		uint32_t index = -2 - slot;
+		uint32_t last = list.pending.size() - 1;
+		if (index != last) {
+			list.pending[index] = list.pending[last];
+			list.pending[index]->data.process_slot[p_type] = slot;
+		}
+		list.pending.resize(last);
 	}
-	Group &g = E->get();
-	if (g.nodes.empty()) {
+}
+
+void SceneTree::_make_process_list_changed(ProcessListType p_type) {
+	process_lists[p_type].changed = true;
+}
+
+void SceneTree::_update_process_list(ProcessListType p_type) {
+	ProcessList &list = process_lists[p_type];
+	if (list.iterating || (!list.changed && !list.removed && list.pending.empty())) {
 		return;
 	}
 
-	_update_group_order(g, p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
+	if (list.removed) {
+		uint32_t to = 0;
+		for (uint32_t i = 0; i < list.nodes.size(); i++) {
+			if (list.nodes[i]) {
+				list.nodes[to++] = list.nodes[i];
+			}
+		}
+		list.nodes.resize(to);
+		list.removed = 0;
+	}
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node *> nodes_copy = g.nodes;
+	if (list.pending.size()) {
+		for (uint32_t i = 0; i < list.pending.size(); i++) {
+			list.nodes.push_back(list.pending[i]);
+		}
+		list.pending.clear();
+		list.changed = true;
+	}
 
-	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	if (list.changed && list.nodes.size()) {
+		if (p_type == PROCESS_LIST_IDLE || p_type == PROCESS_LIST_PHYSICS) {
+			SortArray<Node *, Node::ComparatorWithProcessThreadGroup> node_sort;
+			node_sort.sort(list.nodes.ptr(), list.nodes.size());
+		} else {
+			SortArray<Node *, Node::ComparatorWithPriority> node_sort;
+			node_sort.sort(list.nodes.ptr(), list.nodes.size());
+		}
+	}
+	list.changed = false;
 
-	call_lock++;
+	for (uint32_t i = 0; i < list.nodes.size(); i++) {
+		list.nodes[i]->data.process_slot[p_type] = i;
+	}
+}
 
-	for (int i = 0; i < node_count; i++) {
-		Node *n = nodes[i];
-		if (call_lock && call_skip.has(n)) {
+void SceneTree::_notify_process_list(ProcessListType p_type, int p_notification) {
+	_update_process_list(p_type);
+
+	ProcessList &list = process_lists[p_type];
+	if (list.nodes.empty()) {
+		return;
+	}
+
+	// Internal processing stays on the main thread, it's what engine nodes use.
+	bool threaded = process_threads_allowed && (p_type == PROCESS_LIST_IDLE || p_type == PROCESS_LIST_PHYSICS);
+
+	// Nodes added meanwhile are pending, so the size can't change. Paused state is kept up to date
+	// by the nodes themselves.
+	list.iterating++;
+	uint32_t count = list.nodes.size();
+	for (uint32_t i = 0; i < count;) {
+		Node *n = list.nodes[i];
+		if (!n || n->data.process_paused) {
+			i++;
 			continue;
 		}
 
-		if (!n->can_process()) {
+		int group = n->data.process_thread_group;
+		if (group == 0 || !threaded) {
+			n->notification(p_notification);
+			i++;
 			continue;
 		}
-		if (!n->can_process_notification(p_notification)) {
-			continue;
+
+		uint32_t end = i + 1;
+		while (end < count && (!list.nodes[end] || list.nodes[end]->data.process_thread_group == group)) {
+			end++;
 		}
+		_notify_process_batch(&list.nodes[i], end - i, p_notification);
+		i = end;
+	}
+	list.iterating--;
+}
 
-		n->notification(p_notification);
-		//ERR_FAIL_COND(node_count != g.nodes.size());
+static thread_local bool in_process_thread = false;
+static thread_local SelfList<Node>::List *thread_canvas_transforms = nullptr;
+
+bool SceneTree::is_in_process_thread() {
+	return in_process_thread;
+}
+
+SelfList<Node>::List *SceneTree::_get_canvas_transform_list(SceneTree *p_tree) {
+	return thread_canvas_transforms ? thread_canvas_transforms : &p_tree->canvas_transform_list;
+}
+
+void SceneTree::set_process_threads_allowed(bool p_allowed) {
+	process_threads_allowed = p_allowed && OS::get_singleton()->can_use_threads();
+}
+
+bool SceneTree::are_process_threads_allowed() const {
+	return process_threads_allowed;
+}
+
+void SceneTree::_process_chunk(uint32_t p_chunk, ProcessBatch *p_batch) {
+	FRAME_PROFILE_SCOPE("SceneTree::process_chunk");
+
+	uint32_t from = p_chunk * p_batch->chunk_size;
+	uint32_t to = MIN(from + p_batch->chunk_size, p_batch->count);
+
+	MessageQueue::set_thread_queue(process_thread_queues[p_chunk]);
+	thread_canvas_transforms = process_thread_canvas_transforms[p_chunk];
+	in_process_thread = true;
+
+	if (p_batch->method) {
+		for (uint32_t i = from; i < to; i++) {
+			Variant::CallError ce;
+			p_batch->nodes[i]->call(*p_batch->method, p_batch->args, p_batch->argc, ce);
+		}
+	} else {
+		for (uint32_t i = from; i < to; i++) {
+			Node *n = p_batch->nodes[i];
+			if (n && !n->data.process_paused) {
+				n->notification(p_batch->notification);
+			}
+		}
 	}
 
-	call_lock--;
-	if (call_lock == 0) {
-		call_skip.clear();
+	in_process_thread = false;
+	thread_canvas_transforms = nullptr;
+	MessageQueue::set_thread_queue(nullptr);
+}
+
+void SceneTree::_run_process_batch(ProcessBatch &p_batch) {
+	if (process_thread_queues.empty()) {
+		process_thread_pool.init();
+		for (int i = 0; i < process_thread_pool.get_thread_count(); i++) {
+			process_thread_queues.push_back(memnew(MessageQueue(PROCESS_THREAD_QUEUE_SIZE_KB)));
+			process_thread_canvas_transforms.push_back(memnew(SelfList<Node>::List));
+		}
+	}
+
+	uint32_t chunks = MIN(p_batch.count, process_thread_queues.size());
+	p_batch.chunk_size = (p_batch.count + chunks - 1) / chunks;
+	chunks = (p_batch.count + p_batch.chunk_size - 1) / p_batch.chunk_size;
+
+	process_thread_pool.do_work(chunks, this, &SceneTree::_process_chunk, &p_batch);
+
+	for (uint32_t i = 0; i < chunks; i++) {
+		SelfList<Node>::List *transforms = process_thread_canvas_transforms[i];
+		while (transforms->first()) {
+			SelfList<Node> *n = transforms->first();
+			transforms->remove(n);
+			canvas_transform_list.add(n);
+		}
+	}
+	for (uint32_t i = 0; i < chunks; i++) {
+		process_thread_queues[i]->flush();
 	}
 }
 
+void SceneTree::_notify_process_batch(Node *const *p_nodes, uint32_t p_count, int p_notification) {
+	ProcessBatch batch;
+	batch.nodes = p_nodes;
+	batch.count = p_count;
+	batch.notification = p_notification;
+	batch.method = nullptr;
+	batch.args = nullptr;
+	batch.argc = 0;
+	_run_process_batch(batch);
+}
+
+void SceneTree::_call_process_batch(Node *const *p_nodes, uint32_t p_count, const StringName &p_method, const Variant **p_args, int p_argc) {
+	ProcessBatch batch;
+	batch.nodes = p_nodes;
+	batch.count = p_count;
+	batch.notification = 0;
+	batch.method = &p_method;
+	batch.args = p_args;
+	batch.argc = p_argc;
+	_run_process_batch(batch);
+}
+
+void SceneTree::_finish_process_threads() {
+	process_thread_pool.finish();
+	for (uint32_t i = 0; i < process_thread_queues.size(); i++) {
+		memdelete(process_thread_queues[i]);
+		memdelete(process_thread_canvas_transforms[i]);
+	}
+	process_thread_queues.clear();
+	process_thread_canvas_transforms.clear();
+}
+
 /*
 void SceneMainLoop::_update_listener_2d() {
 
@@ -1068,20 +1479,20 @@ int64_t SceneTree::get_event_count() const {
 
 Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 	Array ret;
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
 		return ret;
 	}
 
-	_update_group_order(E->get()); //update order just in case
-	int nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	int nc = g->nodes.size();
 	if (nc == 0) {
 		return ret;
 	}
 
 	ret.resize(nc);
 
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = g->nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 		ret[i] = ptr[i];
 	}
@@ -1093,17 +1504,17 @@ bool SceneTree::has_group(const StringName &p_identifier) const {
 	return group_map.has(p_identifier);
 }
 void SceneTree::get_nodes_in_group(const StringName &p_group, List<Node *> *p_list) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
 		return;
 	}
 
-	_update_group_order(E->get()); //update order just in case
-	int nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	int nc = g->nodes.size();
 	if (nc == 0) {
 		return;
 	}
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = g->nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 		p_list->push_back(ptr[i]);
 	}
@@ -1114,10 +1525,79 @@ void SceneTree::_flush_delete_queue() {
 
 	while (delete_queue.size()) {
 		Object *obj = ObjectDB::get_instance(delete_queue.front()->get());
-		if (obj) {
+		delete_queue.pop_front();
+		if (!obj) {
+			continue;
+		}
+
+		Node *node = delete_budget_usec > 0 ? Object::cast_to<Node>(obj) : nullptr;
+		if (!node) {
 			memdelete(obj);
+			continue;
 		}
-		delete_queue.pop_front();
+
+		if (node->get_parent()) {
+			node->get_parent()->remove_child(node);
+		}
+
+		// Freed nodes can't be reached by signals, nor emit them, so neither can nodes waiting to be.
+		List<Node *> stack;
+		stack.push_back(node);
+		while (stack.size()) {
+			Node *n = stack.back()->get();
+			stack.pop_back();
+			n->disconnect_all();
+			graveyard_node_count++;
+			for (int i = 0; i < n->get_child_count(); i++) {
+				stack.push_back(n->get_child(i));
+			}
+		}
+		graveyard.push_back(node->get_instance_id());
+	}
+}
+
+void SceneTree::_flush_graveyard(bool p_all) {
+	if (graveyard.empty()) {
+		return;
+	}
+
+	FRAME_PROFILE_SCOPE("SceneTree::flush_graveyard");
+
+	uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+	int deleted = 0;
+
+	while (graveyard.size()) {
+		ObjectID root_id = graveyard.front()->get();
+		Node *node = Object::cast_to<Node>(ObjectDB::get_instance(root_id));
+		if (!node) {
+			graveyard.pop_front(); // Freed meanwhile.
+			continue;
+		}
+		if (node->get_parent()) {
+			graveyard.pop_front();
+			memdelete(node); // Added to a parent again, so it's freed at once.
+			continue;
+		}
+
+		// Same order as when freeing the root at once, but the root is destroyed last.
+		while (node->get_child_count()) {
+			node = node->get_child(node->get_child_count() - 1);
+		}
+		if (node->get_instance_id() == root_id) {
+			graveyard.pop_front();
+		}
+		memdelete(node);
+		graveyard_node_count--;
+
+		// The clock is only checked every few nodes, most take far less than a microsecond.
+		deleted++;
+		if (!p_all && (deleted & 15) == 0 && OS::get_singleton()->get_ticks_usec() - begin_usec >= delete_budget_usec) {
+			break;
+		}
+	}
+
+	if (graveyard.empty()) {
+		graveyard_node_count = 0; // Nodes may have been added to or freed from the graveyard.
 	}
 }
 
@@ -1132,6 +1612,19 @@ int SceneTree::get_node_count() const {
 	return node_count;
 }
 
+int SceneTree::get_pending_deletion_count() const {
+	return MAX(graveyard_node_count, 0);
+}
+
+void SceneTree::set_delete_budget_usec(int p_usec) {
+	ERR_FAIL_COND(p_usec < 0);
+	delete_budget_usec = p_usec;
+}
+
+int SceneTree::get_delete_budget_usec() const {
+	return delete_budget_usec;
+}
+
 void SceneTree::_update_root_rect() {
 	if (stretch_mode == STRETCH_MODE_DISABLED) {
 		_update_font_oversampling(stretch_scale);
@@ -1731,6 +2224,221 @@ Ref<SceneTreeTimer> SceneTree::create_timer(float p_delay_sec, bool p_process_pa
     return stt;
 }
 
+// Looks into arrays, dictionaries and the stored properties of resources, which are duplicated when
+// local to the scene. Each resource is only looked into once.
+static bool _has_script(const Variant &p_value, Set<const Object *> &r_visited) {
+	switch (p_value.get_type()) {
+		case Variant::ARRAY: {
+			Array array = p_value;
+			for (int i = 0; i < array.size(); i++) {
+				if (_has_script(array[i], r_visited)) {
+					return true;
+				}
+			}
+			return false;
+		}
+		case Variant::DICTIONARY: {
+			Dictionary dictionary = p_value;
+			for (const Variant *key = dictionary.next(); key; key = dictionary.next(key)) {
+				if (_has_script(*key, r_visited) || _has_script(dictionary[*key], r_visited)) {
+					return true;
+				}
+			}
+			return false;
+		}
+		case Variant::OBJECT: {
+			Object *obj = p_value;
+			if (!obj || r_visited.has(obj)) {
+				return false;
+			}
+			r_visited.insert(obj);
+			if (Object::cast_to<Script>(obj) || !obj->get_script().is_null()) {
+				return true;
+			}
+
+			List<PropertyInfo> properties;
+			obj->get_property_list(&properties);
+			for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next()) {
+				if ((E->get().usage & PROPERTY_USAGE_STORAGE) && _has_script(obj->get(E->get().name), r_visited)) {
+					return true;
+				}
+			}
+			return false;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+// The servers used by a scene while it's built must be safe to call from other threads. The visual
+// server is unless rendering is thread unsafe, which is checked by the caller, and the 2D physics
+// server only when it runs on its own thread, as it otherwise flushes its commands when stepped.
+// The 3D physics server never is.
+// Scripts can't run on the instancing thread either, which rules out nodes with a script attached
+// and properties holding scripted resources (setters and _init() run when they are assigned).
+bool SceneTree::_can_instance_in_thread(const Ref<SceneState> &p_state, bool p_physics_2d_threaded, int p_depth) {
+	if (p_depth > 16) {
+		return false;
+	}
+
+	Ref<SceneState> base = p_state->get_base_scene_state();
+	if (base.is_valid() && !_can_instance_in_thread(base, p_physics_2d_threaded, p_depth + 1)) {
+		return false;
+	}
+
+	Set<const Object *> visited;
+	for (int i = 0; i < p_state->get_node_count(); i++) {
+		for (int j = 0; j < p_state->get_node_property_count(i); j++) {
+			if (p_state->get_node_property_name(i, j) == CoreStringNames::get_singleton()->_script || _has_script(p_state->get_node_property_value(i, j), visited)) {
+				return false;
+			}
+		}
+
+		StringName type = p_state->get_node_type(i);
+		if (type != StringName()) {
+			if (ClassDB::is_parent_class(type, "CollisionObject") || ClassDB::is_parent_class(type, "Joint") || ClassDB::is_parent_class(type, "SoftBody")) {
+				return false;
+			}
+			if (!p_physics_2d_threaded && (ClassDB::is_parent_class(type, "CollisionObject2D") || ClassDB::is_parent_class(type, "Joint2D"))) {
+				return false;
+			}
+			continue;
+		}
+
+		Ref<PackedScene> instance = p_state->get_node_instance(i);
+		if (instance.is_valid() && !_can_instance_in_thread(instance->get_state(), p_physics_2d_threaded, p_depth + 1)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SceneTree::_instance_thread_func(void *p_userdata) {
+	SceneTree *tree = (SceneTree *)p_userdata;
+
+	while (true) {
+		tree->instance_semaphore.wait();
+		if (tree->instance_thread_exit.is_set()) {
+			break;
+		}
+
+		tree->instance_mutex.lock();
+		if (tree->instance_build_queue.empty()) {
+			tree->instance_mutex.unlock();
+			continue; // Taken back by the main thread.
+		}
+		SceneInstanceTask *task = tree->instance_build_queue.front()->get();
+		tree->instance_build_queue.pop_front();
+		tree->instance_mutex.unlock();
+
+		// Kept alive by instance_tasks until built.
+		task->_build();
+	}
+
+	tree->instance_thread_done.set();
+}
+
+// Commits the built scenes in request order, as many as fit in the budget, but at least one.
+// Scenes that can't be built by the instancing thread are built here too.
+// The cost of a commit is predicted from the nodes of the scene, so a large scene waits for the next
+// frame instead of overrunning the budget left by the ones before it. A scene is committed at once,
+// splitting it would make nodes ready before their children are in the tree.
+void SceneTree::_flush_instance_tasks() {
+	if (instance_tasks.empty()) {
+		return;
+	}
+
+	FRAME_PROFILE_SCOPE("SceneTree::flush_instance_tasks");
+	uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+	bool committed = false;
+
+	while (!instance_tasks.empty()) {
+		Ref<SceneInstanceTask> task = instance_tasks.front()->get();
+		if (task->status.get() == SceneInstanceTask::STATUS_QUEUED) {
+			if (task->threaded) {
+				break; // Still being built, the next ones wait to keep the order.
+			}
+			task->_build();
+		}
+
+		uint64_t commit_begin_usec = OS::get_singleton()->get_ticks_usec();
+		if (committed && instance_budget_usec > 0) {
+			uint64_t expected_usec = task->node_count * instance_commit_usec_per_node;
+			if (commit_begin_usec - begin_usec + expected_usec > instance_budget_usec) {
+				break;
+			}
+		}
+
+		int node_count = task->node_count;
+		task->_commit();
+		instance_tasks.pop_front();
+		committed = true;
+
+		uint64_t end_usec = OS::get_singleton()->get_ticks_usec();
+		if (node_count > 0) {
+			double usec_per_node = double(end_usec - commit_begin_usec) / node_count;
+			instance_commit_usec_per_node = instance_commit_usec_per_node > 0.0 ? Math::lerp(instance_commit_usec_per_node, usec_per_node, 0.25) : usec_per_node;
+		}
+
+		if (instance_budget_usec > 0 && end_usec - begin_usec >= instance_budget_usec) {
+			break;
+		}
+	}
+}
+
+void SceneTree::_finish_instance_tasks() {
+	if (instance_thread.is_started()) {
+		instance_thread_exit.set();
+		instance_semaphore.post();
+		while (!instance_thread_done.is_set()) {
+			_help_instance_thread();
+		}
+		instance_thread.wait_to_finish();
+	}
+	instance_build_queue.clear();
+
+	for (List<Ref<SceneInstanceTask>>::Element *E = instance_tasks.front(); E; E = E->next()) {
+		uint32_t status = E->get()->status.get();
+		if (status == SceneInstanceTask::STATUS_QUEUED || status == SceneInstanceTask::STATUS_BUILT) {
+			E->get()->_discard(SceneInstanceTask::STATUS_CANCELED);
+		}
+	}
+	instance_tasks.clear();
+}
+
+Ref<SceneInstanceTask> SceneTree::instance_async(const Ref<PackedScene> &p_scene, Node *p_parent) {
+	ERR_FAIL_COND_V(p_scene.is_null(), Ref<SceneInstanceTask>());
+	ERR_FAIL_COND_V_MSG(Thread::get_caller_id() != Thread::get_main_id(), Ref<SceneInstanceTask>(), "Asynchronous instances can only be requested from the main thread.");
+
+	Ref<SceneInstanceTask> task;
+	task.instance();
+	task->scene = p_scene;
+	task->parent_id = p_parent ? p_parent->get_instance_id() : 0;
+
+	if (OS::get_singleton()->can_use_threads() && OS::get_singleton()->get_render_thread_mode() != OS::RENDER_THREAD_UNSAFE) {
+		bool physics_2d_threaded = int(GLOBAL_GET("physics/2d/thread_model")) == 2;
+		task->threaded = _can_instance_in_thread(task->scene->get_state(), physics_2d_threaded);
+	}
+
+	instance_tasks.push_back(task);
+
+	if (task->threaded) {
+		if (!instance_thread.is_started()) {
+			instance_thread_exit.clear();
+			instance_thread_done.clear();
+			instance_thread.start(_instance_thread_func, this);
+		}
+		instance_mutex.lock();
+		instance_build_queue.push_back(task.ptr());
+		instance_mutex.unlock();
+		instance_semaphore.post();
+	}
+
+	return task;
+}
+
 void SceneTree::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_root"), &SceneTree::get_root);
 	ClassDB::bind_method(D_METHOD("has_group", "name"), &SceneTree::has_group);
@@ -1756,6 +2464,9 @@ void SceneTree::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("create_timer", "time_sec", "pause_mode_process", "owner"), &SceneTree::create_timer, DEFVAL(true));
 
 	ClassDB::bind_method(D_METHOD("get_node_count"), &SceneTree::get_node_count);
+	ClassDB::bind_method(D_METHOD("get_pending_deletion_count"), &SceneTree::get_pending_deletion_count);
+	ClassDB::bind_method(D_METHOD("set_delete_budget_usec", "usec"), &SceneTree::set_delete_budget_usec);
+	ClassDB::bind_method(D_METHOD("get_delete_budget_usec"), &SceneTree::get_delete_budget_usec);
 	ClassDB::bind_method(D_METHOD("get_frame"), &SceneTree::get_frame);
 	ClassDB::bind_method(D_METHOD("quit", "exit_code"), &SceneTree::quit, DEFVAL(-1));
 
@@ -1812,6 +2523,7 @@ void SceneTree::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "current_scene", PROPERTY_HINT_RESOURCE_TYPE, "Node", 0), "set_current_scene", "get_current_scene");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "root", PROPERTY_HINT_RESOURCE_TYPE, "Node", 0), "", "get_root");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "physics_interpolation"), "set_physics_interpolation_enabled", "is_physics_interpolation_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "delete_budget_usec", PROPERTY_HINT_RANGE, "0,100000,1,or_greater"), "set_delete_budget_usec", "get_delete_budget_usec");
 
 	ADD_SIGNAL(MethodInfo("tree_changed"));
 	ADD_SIGNAL(MethodInfo("node_added", PropertyInfo(Variant::OBJECT, "node", PROPERTY_HINT_RESOURCE_TYPE, "Node")));
@@ -1837,6 +2549,7 @@ void SceneTree::_bind_methods() {
 	BIND_ENUM_CONSTANT(GROUP_CALL_REVERSE);
 	BIND_ENUM_CONSTANT(GROUP_CALL_REALTIME);
 	BIND_ENUM_CONSTANT(GROUP_CALL_UNIQUE);
+	BIND_ENUM_CONSTANT(GROUP_CALL_THREADED);
 
 	BIND_ENUM_CONSTANT(STRETCH_MODE_DISABLED);
 	BIND_ENUM_CONSTANT(STRETCH_MODE_2D);
@@ -1948,6 +2661,19 @@ SceneTree::SceneTree() {
 	call_lock = 0;
 	root_lock = 0;
 	node_count = 0;
+
+	// Servers can only be called from worker threads when they run on a thread of their own. In the
+	// safe single thread models, calls from other threads are queued for the main thread, which is
+	// waiting for the workers, so a call returning a value (or a full queue) would never finish.
+	process_threads_allowed = OS::get_singleton()->can_use_threads() && OS::get_singleton()->get_render_thread_mode() == OS::RENDER_SEPARATE_THREAD && int(GLOBAL_DEF("physics/2d/thread_model", 1)) == 2;
+
+	graveyard_node_count = 0;
+	delete_budget_usec = GLOBAL_DEF("application/run/delete_budget_usec", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("application/run/delete_budget_usec", PropertyInfo(Variant::INT, "application/run/delete_budget_usec", PROPERTY_HINT_RANGE, "0,100000,1,or_greater")); // 0 frees queued nodes at once.
+
+	instance_budget_usec = GLOBAL_DEF("application/run/async_instance_budget_usec", 2000);
+	instance_commit_usec_per_node = 0.0;
+	ProjectSettings::get_singleton()->set_custom_property_info("application/run/async_instance_budget_usec", PropertyInfo(Variant::INT, "application/run/async_instance_budget_usec", PROPERTY_HINT_RANGE, "0,100000,1,or_greater")); // 0 commits everything that's built.
 	_physics_interpolation_enabled = false;
 
 	//create with mainloop
@@ -2062,6 +2788,10 @@ SceneTree::SceneTree() {
 }
 
 SceneTree::~SceneTree() {
+	_finish_instance_tasks();
+	_finish_process_threads();
+	_flush_graveyard(true);
+
 	if (root) {
 		root->_set_tree(nullptr);
 		root->_propagate_after_exit_branch(true);
@@ -6,15 +6,24 @@
 #ifndef SCENE_TREE_H
 #define SCENE_TREE_H
 
-#include "core/reference.h"
+#include "core/hash_map.h"
+#include "core/local_vector.h"
 #include "core/os/main_loop.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
 #include "core/os/thread_safe.h"
+#include "core/os/thread_work_pool.h"
+#include "core/reference.h"
+#include "core/safe_refcount.h"
 #include "core/self_list.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/world_2d.h"
 
 
+class MessageQueue;
 class PackedScene;
+class SceneState;
 class Node;
 class Viewport;
 class Material;
@@ -50,6 +59,55 @@ public:
 	SceneTreeTimer();
 };
 
+// Handle of a scene instanced by PackedScene::instance_async().
+// The node tree is built detached, on the instancing thread of the SceneTree when the servers the
+// scene uses can be called from other threads and no script runs while building it, or on the main
+// thread otherwise. Built scenes are then added to their parent by the main thread in request order,
+// as many per frame as their node counts are expected to fit in "application/run/async_instance_budget_usec".
+class SceneInstanceTask : public Reference {
+	GDCLASS(SceneInstanceTask, Reference);
+
+public:
+	enum Status {
+		STATUS_QUEUED, // Waiting to be built, or being built.
+		STATUS_BUILT, // Built but not added to the parent yet.
+		STATUS_DONE,
+		STATUS_FAILED,
+		STATUS_CANCELED,
+	};
+
+private:
+	friend class SceneTree;
+
+	Ref<PackedScene> scene;
+	ObjectID parent_id;
+	bool threaded;
+	SafeNumeric<uint32_t> status; // Set last by the instancing thread, which doesn't keep a reference.
+	Node *node;
+	int node_count;
+	ObjectID node_id;
+
+	void _build();
+	void _ensure_built();
+	void _commit();
+	void _discard(Status p_status);
+
+protected:
+	static void _bind_methods();
+
+public:
+	Status get_status() const;
+	bool is_done() const;
+	Ref<PackedScene> get_scene() const;
+	Node *get_node() const;
+
+	Node *wait();
+	void cancel();
+
+	SceneInstanceTask();
+	~SceneInstanceTask();
+};
+
 class SceneTree : public MainLoop {
 	_THREAD_SAFE_CLASS_
 
@@ -82,6 +140,64 @@ private:
 		Group() { changed = false; };
 	};
 
+	enum ProcessListType {
+		PROCESS_LIST_IDLE,
+		PROCESS_LIST_IDLE_INTERNAL,
+		PROCESS_LIST_PHYSICS,
+		PROCESS_LIST_PHYSICS_INTERNAL,
+		PROCESS_LIST_MAX,
+	};
+
+	// Nodes inside the tree with a process notification enabled, sorted by priority and tree order.
+	// Every node knows its slot in the lists it's in, so it can leave one without a search. While a
+	// list is iterated, leaving nodes only clear their slot and joining ones wait in the pending
+	// list, so the list is never copied. Both are resolved before the next iteration.
+	struct ProcessList {
+		LocalVector<Node *> nodes;
+		LocalVector<Node *> pending;
+		uint32_t removed = 0;
+		int iterating = 0;
+		bool changed = false;
+	};
+
+	ProcessList process_lists[PROCESS_LIST_MAX];
+
+	void _add_to_process_list(ProcessListType p_type, Node *p_node);
+	void _remove_from_process_list(ProcessListType p_type, Node *p_node);
+	void _make_process_list_changed(ProcessListType p_type);
+	void _update_process_list(ProcessListType p_type);
+	void _notify_process_list(ProcessListType p_type, int p_notification);
+
+	// Nodes with a process thread group are processed on worker threads, see
+	// Node::set_process_thread_group(). Consecutive nodes of a group in a list form a batch, which
+	// is split in one chunk per thread. The deferred calls of every chunk are flushed in order once
+	// the whole batch is done.
+	enum {
+		PROCESS_THREAD_QUEUE_SIZE_KB = 1024,
+	};
+
+	struct ProcessBatch {
+		Node *const *nodes;
+		uint32_t count;
+		uint32_t chunk_size;
+		int notification;
+		// Called instead of sending the notification when set.
+		const StringName *method;
+		const Variant **args;
+		int argc;
+	};
+
+	bool process_threads_allowed;
+	ThreadWorkPool process_thread_pool;
+	LocalVector<MessageQueue *> process_thread_queues;
+	LocalVector<SelfList<Node>::List *> process_thread_canvas_transforms; // Moved to canvas_transform_list after each batch.
+
+	void _process_chunk(uint32_t p_chunk, ProcessBatch *p_batch);
+	void _run_process_batch(ProcessBatch &p_batch);
+	void _notify_process_batch(Node *const *p_nodes, uint32_t p_count, int p_notification);
+	void _call_process_batch(Node *const *p_nodes, uint32_t p_count, const StringName &p_method, const Variant **p_args, int p_argc);
+	void _finish_process_threads();
+
 	struct ClientPhysicsInterpolation {
 		void physics_process();
 	} _client_physics_interpolation;
@@ -101,7 +217,7 @@ private:
 	bool pause;
 	int root_lock;
 
-	Map<StringName, Group> group_map;
+	HashMap<StringName, Group> group_map; // Elements don't move, nodes keep pointers to their groups.
 	bool _quit;
 	bool initialized;
 	bool input_handled;
@@ -142,6 +258,14 @@ private:
 
 	List<ObjectID> delete_queue;
 
+	// With a deletion budget, queued nodes leave the tree at the end of the frame as usual, but are
+	// kept here and destroyed a few at a time, leaves first, within the budget of every frame. Their
+	// signals are disconnected when they get here, so they behave as freed, except that
+	// is_instance_valid() is still true for them meanwhile.
+	List<ObjectID> graveyard;
+	int graveyard_node_count;
+	uint64_t delete_budget_usec; // 0 destroys them at once.
+
 	Map<UGCall, Vector<Variant>> unique_group_calls;
 	bool ugc_locked;
 	void _flush_ugc();
@@ -167,6 +291,23 @@ private:
 
 	List<Ref<SceneTreeTimer>> timers;
 
+	// Asynchronous instancing, see SceneInstanceTask.
+	List<Ref<SceneInstanceTask>> instance_tasks; // All the pending tasks, in request order.
+	List<SceneInstanceTask *> instance_build_queue; // The tasks left to the instancing thread.
+	Mutex instance_mutex;
+	Semaphore instance_semaphore;
+	Thread instance_thread;
+	SafeFlag instance_thread_exit;
+	SafeFlag instance_thread_done;
+	uint64_t instance_budget_usec;
+	double instance_commit_usec_per_node; // Running average, predicts how long a commit takes.
+
+	static void _instance_thread_func(void *p_userdata);
+	static bool _can_instance_in_thread(const Ref<SceneState> &p_state, bool p_physics_2d_threaded, int p_depth = 0);
+	void _flush_instance_tasks();
+	void _finish_instance_tasks();
+	friend class SceneInstanceTask;
+
 	static SceneTree *singleton;
 	friend class Node;
 
@@ -179,18 +320,24 @@ private:
 	void remove_from_group(const StringName &p_group, Node *p_node);
 	void make_group_changed(const StringName &p_group);
 
-	void _notify_group_pause(const StringName &p_group, int p_notification);
 	void _call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input);
 	Variant _call_group_flags(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	Variant _call_group(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 
 	void _flush_delete_queue();
+	void _flush_graveyard(bool p_all);
 	//optimization
 	friend class CanvasItem;
 	friend class Viewport;
 
 	SelfList<Node>::List xform_change_list;
 
+	// Node2Ds whose local transform has to be sent to the VisualServer, see Node2D::_send_transform().
+	friend class Node2D;
+	SelfList<Node>::List canvas_transform_list;
+	void _flush_canvas_transforms();
+	static SelfList<Node>::List *_get_canvas_transform_list(SceneTree *p_tree);
+
 	friend class ScriptDebuggerRemote;
 #ifdef DEBUG_ENABLED
 
@@ -249,6 +396,9 @@ public:
 		GROUP_CALL_REALTIME = 2,
 		GROUP_CALL_UNIQUE = 4,
 		GROUP_CALL_MULTILEVEL = 8,
+		// Realtime calls to nodes in a process thread group run in parallel, under the same conditions
+		// and rules as processing them (see Node::set_process_thread_group()).
+		GROUP_CALL_THREADED = 16,
 	};
 
 	_FORCE_INLINE_ Viewport *get_root() const { return root; }
@@ -270,6 +420,7 @@ public:
 	virtual bool iteration(float p_time);
 	virtual void iteration_end();
 	virtual bool idle(float p_time);
+	virtual void idle_end();
 
 	virtual void finish();
 
@@ -329,6 +480,10 @@ public:
 	int64_t get_event_count() const;
 
 	int get_node_count() const;
+	int get_pending_deletion_count() const;
+
+	void set_delete_budget_usec(int p_usec);
+	int get_delete_budget_usec() const;
 
 	void queue_delete(Object *p_object);
 
@@ -354,10 +509,17 @@ public:
 
     Ref<SceneTreeTimer> create_timer(float p_delay_sec, bool p_process_pause = true, Node *p_owner = nullptr);
 
+	Ref<SceneInstanceTask> instance_async(const Ref<PackedScene> &p_scene, Node *p_parent = nullptr);
+
     //used by Main::start, don't use otherwise
 	void add_current_scene(Node *p_current);
 
 	static SceneTree *get_singleton() { return singleton; }
+	static bool is_in_process_thread();
+	// Only allowed by default when the servers run on threads of their own, see the constructor.
+	// Not exposed, it's for tests whose nodes don't use the servers.
+	void set_process_threads_allowed(bool p_allowed);
+	bool are_process_threads_allowed() const;
 
 	void drop_files(const Vector<String> &p_files, int p_from_screen = 0);
 	void global_menu_action(const Variant &p_id, const Variant &p_meta);
@@ -371,6 +533,7 @@ public:
 	~SceneTree();
 };
 
+VARIANT_ENUM_CAST(SceneInstanceTask::Status);
 VARIANT_ENUM_CAST(SceneTree::StretchMode);
 VARIANT_ENUM_CAST(SceneTree::StretchAspect);
 VARIANT_ENUM_CAST(SceneTree::GroupCallFlags);
@@ -84,6 +84,7 @@
 
 #include "scene/main/canvas_layer.h"
 #include "scene/main/instance_placeholder.h"
+#include "scene/main/node_pool.h"
 #include "scene/main/resource_preloader.h"
 #include "scene/main/scene_tree.h"
 #include "scene/main/timer.h"
@@ -302,6 +303,8 @@ void register_scene_types() {
 
 	ClassDB::register_class<SceneTree>();
 	ClassDB::register_virtual_class<SceneTreeTimer>(); //sorry, you can't create it
+	ClassDB::register_virtual_class<SceneInstanceTask>();
+	ClassDB::register_class<NodePool>();
 
 	OS::get_singleton()->yield(); //may take time to init
 
@@ -319,7 +322,7 @@ void register_scene_types() {
 }
 
 void initialize_theme() {
-	bool default_theme_hidpi = GLOBAL_DEF("gui/theme/use_hidpi", false);
+	GLOBAL_DEF("gui/theme/use_hidpi", false);
 	ProjectSettings::get_singleton()->set_custom_property_info("gui/theme/use_hidpi", PropertyInfo(Variant::BOOL, "gui/theme/use_hidpi", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_RESTART_IF_CHANGED));
 	String theme_path = GLOBAL_DEF_RST("gui/theme/custom", "");
 	ProjectSettings::get_singleton()->set_custom_property_info("gui/theme/custom", PropertyInfo(Variant::STRING, "gui/theme/custom", PROPERTY_HINT_FILE, "*.tres,*.res,*.theme", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_RESTART_IF_CHANGED));
@@ -335,7 +338,12 @@ void initialize_theme() {
 	}
 
 	// Always make the default theme to avoid invalid default font/icon/style in the given theme
+#ifdef SERVER_ENABLED
+	make_headless_default_theme(font);
+#else
+	bool default_theme_hidpi = GLOBAL_GET("gui/theme/use_hidpi");
 	make_default_theme(default_theme_hidpi, font);
+#endif
 
 	if (theme_path != String()) {
 		Ref<Theme> theme = ResourceLoader::load(theme_path);
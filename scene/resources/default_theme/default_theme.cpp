@@ -873,6 +873,32 @@ void make_default_theme(bool p_hidpi, Ref<Font> p_font) {
 	Theme::set_default_font(default_font);
 }
 
+// Headless builds never draw, so the default theme is left empty and the fallback
+// font, icon and style are placeholders. This avoids decoding and uploading the
+// theme textures and font atlas at startup; theme lookups still succeed as they
+// fall back to the defaults below.
+void make_headless_default_theme(Ref<Font> p_font) {
+	Ref<Theme> t;
+	t.instance();
+
+	Ref<Font> default_font = p_font;
+	if (default_font.is_null()) {
+		Ref<BitmapFont> font;
+		font.instance();
+		font->set_height(_lodpi_font_height);
+		font->set_ascent(_lodpi_font_ascent);
+		default_font = font;
+	}
+
+	Ref<StyleBoxEmpty> default_style;
+	default_style.instance();
+
+	Theme::set_default(t);
+	Theme::set_default_icon(Ref<ImageTexture>(memnew(ImageTexture)));
+	Theme::set_default_style(default_style);
+	Theme::set_default_font(default_font);
+}
+
 void clear_default_theme() {
 	Theme::set_project_default(nullptr);
 	Theme::set_default(nullptr);
@@ -10,6 +10,7 @@
 
 void fill_default_theme(Ref<Theme> &theme, const Ref<Font> &default_font, const Ref<Font> &large_font, Ref<Texture> &default_icon, Ref<StyleBox> &default_style, float p_scale);
 void make_default_theme(bool p_hidpi, Ref<Font> p_font);
+void make_headless_default_theme(Ref<Font> p_font);
 void clear_default_theme();
 
 #endif // DEFAULT_THEME_H
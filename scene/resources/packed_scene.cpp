@@ -9,12 +9,14 @@
 #include "core/engine.h"
 #include "core/io/resource_loader.h"
 #include "core/project_settings.h"
+#include "core/variant_internal.h"
 #include "scene/2d/node_2d.h"
 #include "scene/main/node.h"
 #ifndef ADVANCED_GUI_DISABLED
     #include "scene/gui/control.h"
 #endif
 #include "scene/main/instance_placeholder.h"
+#include "scene/main/scene_tree.h"
 #include "scene/property_utils.h"
 
 #define PACKED_SCENE_VERSION 2
@@ -47,6 +49,124 @@ static Array _sanitize_node_pinned_properties(Node *p_node) {
 	return pinned;
 }
 
+// Whether the setter can be called with a pointer to the value, like MethodBind::call() would after converting it.
+// Objects are passed as a pointer to the object (or Ref), enums as 32 bits integers, neither is stored as such in a Variant.
+static bool _can_ptrcall_setter(const MethodBind *p_setter, const Variant &p_value, bool p_indexed) {
+#ifdef PTRCALL_ENABLED
+	int argcount = p_indexed ? 2 : 1;
+	if (p_setter->is_vararg() || p_setter->has_return() || p_setter->get_argument_count() != argcount) {
+		return false;
+	}
+	for (int i = 0; i < argcount; i++) {
+		PropertyInfo info = p_setter->get_argument_info(i);
+		if (info.type == Variant::OBJECT || (info.usage & PROPERTY_USAGE_CLASS_IS_ENUM)) {
+			return false;
+		}
+	}
+	if (p_indexed && p_setter->get_argument_type(0) != Variant::INT) {
+		return false;
+	}
+	Variant::Type type = p_setter->get_argument_type(argcount - 1);
+	return type == Variant::NIL || (type == p_value.get_type() && VariantInternal::get_opaque_pointer(&p_value));
+#else
+	return false;
+#endif
+}
+
+void SceneState::_build_instance_plan() const {
+	instance_plan.nodes.clear();
+	instance_plan.valid = false;
+
+	int nc = nodes.size();
+	instance_plan.nodes.resize(nc);
+	for (int i = 0; i < nc; i++) {
+		const NodeData &n = nodes[i];
+		InstancePlan::PlannedNode &pn = instance_plan.nodes.write[i];
+
+		StringName class_name;
+		if (!(i == 0 && base_scene_idx >= 0) && n.instance < 0 && n.type != TYPE_INSTANCED) {
+			ERR_FAIL_INDEX(n.type, names.size());
+			pn.creation_func = ClassDB::get_creation_func(names[n.type], &class_name);
+			if (pn.creation_func && !ClassDB::is_parent_class(class_name, "Node")) {
+				pn.creation_func = nullptr; // instance() replaces it with a placeholder.
+			}
+		}
+
+		pn.properties.resize(n.properties.size());
+		for (int j = 0; j < n.properties.size(); j++) {
+			ERR_FAIL_INDEX(n.properties[j].name, names.size());
+			ERR_FAIL_INDEX(n.properties[j].value, variants.size());
+			if (!pn.creation_func) {
+				continue;
+			}
+
+			const StringName &name = names[n.properties[j].name];
+			const Variant &value = variants[n.properties[j].value];
+			if (name == CoreStringNames::get_singleton()->_script || value.get_type() == Variant::OBJECT) {
+				continue; // Scripts keep the state of the previous one, resources may be local to the scene.
+			}
+
+			const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(class_name, name);
+			if (!psg || !psg->_setptr) {
+				continue;
+			}
+
+			InstancePlan::PlannedProperty &pp = pn.properties.write[j];
+			pp.setter = psg->_setptr;
+			pp.index = psg->index;
+			pp.ptrcall = _can_ptrcall_setter(psg->_setptr, value, psg->index >= 0);
+			pp.variant_argument = psg->_setptr->get_argument_type(psg->index >= 0 ? 1 : 0) == Variant::NIL;
+		}
+	}
+
+	instance_plan.valid = true;
+}
+
+const SceneState::InstancePlan *SceneState::_get_instance_plan() const {
+	if (!instance_plan_built.is_set()) {
+		MutexLock lock(instance_plan_mutex);
+		if (!instance_plan_built.is_set()) {
+			_build_instance_plan();
+			instance_plan_built.set();
+		}
+	}
+	return instance_plan.valid ? &instance_plan : nullptr;
+}
+
+void SceneState::_clear_instance_plan() {
+	MutexLock lock(instance_plan_mutex);
+	instance_plan_built.clear();
+	instance_plan.nodes.clear();
+	instance_plan.valid = false;
+}
+
+// Same as ClassDB::set_property() for the node, which has no script, without looking up the property.
+void SceneState::_set_planned_property(Node *p_node, const InstancePlan::PlannedProperty &p_property, const Variant &p_value) {
+#ifdef PTRCALL_ENABLED
+	if (p_property.ptrcall) {
+		int64_t index = p_property.index;
+		const void *args[2];
+		int argcount = 0;
+		if (p_property.index >= 0) {
+			args[argcount++] = &index;
+		}
+		args[argcount++] = p_property.variant_argument ? &p_value : VariantInternal::get_opaque_pointer(&p_value);
+		p_property.setter->ptrcall(p_node, args, nullptr);
+		return;
+	}
+#endif
+
+	Variant::CallError ce;
+	if (p_property.index >= 0) {
+		Variant index = p_property.index;
+		const Variant *args[2] = { &index, &p_value };
+		p_property.setter->call(p_node, args, 2, ce);
+	} else {
+		const Variant *args[1] = { &p_value };
+		p_property.setter->call(p_node, args, 1, ce);
+	}
+}
+
 Node *SceneState::instance(GenEditState p_edit_state) const {
 	// nodes where instancing failed (because something is missing)
 	List<Node *> stray_instances;
@@ -86,6 +206,12 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	Map<Ref<Resource>, Ref<Resource>> resources_local_to_scene;
 
+	// The editor keeps going through Object::set(), as it tracks what it sets.
+	const InstancePlan *plan = nullptr;
+	if (p_edit_state == GEN_EDIT_STATE_DISABLED && !Engine::get_singleton()->is_editor_hint()) {
+		plan = _get_instance_plan();
+	}
+
 	for (int i = 0; i < nc; i++) {
 		const NodeData &n = nd[i];
 
@@ -155,7 +281,7 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 			}
 		} else {
 			//node belongs to this scene and must be created
-			Object *obj = ClassDB::instance(snames[n.type]);
+			Object *obj = plan && plan->nodes[i].creation_func ? plan->nodes[i].creation_func() : ClassDB::instance(snames[n.type]);
 
 			node = Object::cast_to<Node>(obj);
 
@@ -193,6 +319,14 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 					ERR_FAIL_INDEX_V(nprops[j].name, sname_count, nullptr);
 					ERR_FAIL_INDEX_V(nprops[j].value, prop_count, nullptr);
 
+					if (plan) {
+						const InstancePlan::PlannedProperty &pp = plan->nodes[i].properties[j];
+						if (pp.setter && !node->get_script_instance()) {
+							_set_planned_property(node, pp, props[nprops[j].value]);
+							continue;
+						}
+					}
+
 					if (snames[nprops[j].name] == CoreStringNames::get_singleton()->_script) {
 						//work around to avoid old script variables from disappearing, should be the proper fix to:
 						//https://github.com/godotengine/godot/issues/2958
@@ -846,6 +980,7 @@ String SceneState::get_path() const {
 }
 
 void SceneState::clear() {
+	_clear_instance_plan();
 	names.clear();
 	variants.clear();
 	nodes.clear();
@@ -1019,6 +1154,8 @@ void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
 	const PoolVector<int> sconns = p_dictionary["conns"];
 	ERR_FAIL_COND(sconns.size() < conn_count);
 
+	_clear_instance_plan();
+
 	PoolVector<String> snames = p_dictionary["names"];
 	if (snames.size()) {
 		int namecount = snames.size();
@@ -1441,6 +1578,7 @@ int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int
 	nd.instance = p_instance;
 	nd.index = p_index;
 
+	_clear_instance_plan();
 	nodes.push_back(nd);
 
 	return nodes.size() - 1;
@@ -1453,6 +1591,7 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 	NodeData::Property prop;
 	prop.name = p_name;
 	prop.value = p_value;
+	_clear_instance_plan();
 	nodes.write[p_node].properties.push_back(prop);
 }
 void SceneState::add_node_group(int p_node, int p_group) {
@@ -1462,6 +1601,7 @@ void SceneState::add_node_group(int p_node, int p_group) {
 }
 void SceneState::set_base_scene(int p_idx) {
 	ERR_FAIL_INDEX(p_idx, variants.size());
+	_clear_instance_plan();
 	base_scene_idx = p_idx;
 }
 void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method, int p_flags, const Vector<int> &p_binds) {
@@ -1575,6 +1715,14 @@ Node *PackedScene::instance(GenEditState p_edit_state) const {
 	return s;
 }
 
+// Builds the node tree away from the main thread when possible, see SceneInstanceTask.
+Ref<SceneInstanceTask> PackedScene::instance_async(Node *p_parent) const {
+	ERR_FAIL_COND_V_MSG(!SceneTree::get_singleton(), Ref<SceneInstanceTask>(), "Asynchronous instancing requires a SceneTree.");
+	ERR_FAIL_COND_V(!can_instance(), Ref<SceneInstanceTask>());
+
+	return SceneTree::get_singleton()->instance_async(Ref<PackedScene>(const_cast<PackedScene *>(this)), p_parent);
+}
+
 void PackedScene::replace_state(Ref<SceneState> p_by) {
 	state = p_by;
 	state->set_path(get_path());
@@ -1603,6 +1751,7 @@ void PackedScene::set_path(const String &p_path, bool p_take_over) {
 void PackedScene::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("pack", "path"), &PackedScene::pack);
 	ClassDB::bind_method(D_METHOD("instance", "edit_state"), &PackedScene::instance, DEFVAL(GEN_EDIT_STATE_DISABLED));
+	ClassDB::bind_method(D_METHOD("instance_async", "parent"), &PackedScene::instance_async, DEFVAL(Variant()));
 	ClassDB::bind_method(D_METHOD("can_instance"), &PackedScene::can_instance);
 	ClassDB::bind_method(D_METHOD("_set_bundled_scene"), &PackedScene::_set_bundled_scene);
 	ClassDB::bind_method(D_METHOD("_get_bundled_scene"), &PackedScene::_get_bundled_scene);
@@ -6,9 +6,13 @@
 #ifndef PACKED_SCENE_H
 #define PACKED_SCENE_H
 
+#include "core/os/mutex.h"
 #include "core/resource.h"
+#include "core/safe_refcount.h"
 #include "scene/main/node.h"
 
+class SceneInstanceTask;
+
 class SceneState : public Reference {
 	GDCLASS(SceneState, Reference);
 
@@ -56,6 +60,36 @@ class SceneState : public Reference {
 
 	Vector<ConnectionData> connections;
 
+	// What instance() resolves by name for every node, done once per scene and reused by all the
+	// instances made outside of the editor. Nodes from sub-scenes and inherited scenes have no
+	// creation function, their class is only known once they are created, so their properties
+	// go through Object::set() as well as any property of a node with a script.
+	struct InstancePlan {
+		struct PlannedProperty {
+			MethodBind *setter = nullptr; // nullptr when the property must be set with Object::set().
+			int index = -1; // For indexed properties, passed before the value.
+			bool ptrcall = false; // The value has the exact type of the argument.
+			bool variant_argument = false; // The setter takes a Variant, which is passed as is by ptrcall.
+		};
+
+		struct PlannedNode {
+			Object *(*creation_func)() = nullptr;
+			Vector<PlannedProperty> properties;
+		};
+
+		Vector<PlannedNode> nodes;
+		bool valid = false;
+	};
+
+	mutable InstancePlan instance_plan;
+	mutable Mutex instance_plan_mutex;
+	mutable SafeFlag instance_plan_built;
+
+	const InstancePlan *_get_instance_plan() const;
+	void _build_instance_plan() const;
+	void _clear_instance_plan();
+	static void _set_planned_property(Node *p_node, const InstancePlan::PlannedProperty &p_property, const Variant &p_value);
+
 	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 
@@ -190,6 +224,7 @@ public:
 
 	bool can_instance() const;
 	Node *instance(GenEditState p_edit_state = GEN_EDIT_STATE_DISABLED) const;
+	Ref<SceneInstanceTask> instance_async(Node *p_parent = nullptr) const;
 
 	void recreate_state();
 	void replace_state(Ref<SceneState> p_by);
@@ -7,6 +7,7 @@
 
 #include "core/io/resource_loader.h"
 #include "core/os/file_access.h"
+#include "core/os/frame_profiler.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
 #include "servers/audio/audio_driver_dummy.h"
@@ -268,6 +269,8 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 }
 
 void AudioServer::_mix_step() {
+	FRAME_PROFILE_SCOPE("AudioServer::_mix_step");
+
 	bool solo_mode = false;
 
 	for (int i = 0; i < buses.size(); i++) {
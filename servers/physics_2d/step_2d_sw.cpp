@@ -4,6 +4,8 @@
 
 
 #include "step_2d_sw.h"
+
+#include "core/os/frame_profiler.h"
 #include "core/os/os.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
@@ -104,6 +106,8 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 }
 
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
+	FRAME_PROFILE_SCOPE("Step2DSW::step");
+
 	p_space->lock(); // can't access space during this
 	p_space->set_step(p_delta);
 	p_space->setup(); //update inertias, etc
@@ -132,6 +136,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_FORCES, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("Step2DSW::integrate_forces", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -184,6 +189,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_GENERATE_ISLANDS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("Step2DSW::generate_islands", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -227,6 +233,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("Step2DSW::setup_constraints", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -244,6 +251,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SOLVE_CONSTRAINTS, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("Step2DSW::solve_constraints", profile_begtime, profile_endtime);
 		profile_begtime = profile_endtime;
 	}
 
@@ -269,6 +277,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
+		FRAME_PROFILE_EVENT("Step2DSW::integrate_velocities", profile_begtime, profile_endtime);
 		//profile_begtime=profile_endtime;
 	}
 
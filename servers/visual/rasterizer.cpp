@@ -20,6 +20,8 @@ Rasterizer *Rasterizer::create() {
 
 RasterizerStorage *RasterizerStorage::base_singleton = nullptr;
 
+uint32_t RasterizerCanvas::Item::revision_counter = 0;
+
 RasterizerStorage::RasterizerStorage() {
 	base_singleton = this;
 }
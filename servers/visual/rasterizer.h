@@ -941,6 +941,12 @@ public:
 		int32_t light_mask;
 		mutable uint32_t skeleton_revision;
 
+		// unique value, changed each time the commands are cleared, so renderers can
+		// detect an item that has not been redrawn since the previous frame
+		// (in combination with the number of commands)
+		uint32_t revision;
+		static uint32_t revision_counter;
+
 		Item *next;
 
 		struct CopyBackBuffer {
@@ -1158,6 +1164,7 @@ public:
 				memdelete(commands[i]);
 			}
 			commands.clear();
+			revision = ++revision_counter;
 			clip = false;
 			rect_dirty = true;
 			final_clip_owner = nullptr;
@@ -1167,6 +1174,7 @@ public:
 		Item() {
 			light_mask = 1;
 			skeleton_revision = 0;
+			revision = ++revision_counter;
 			vp_render = nullptr;
 			next = nullptr;
 			final_clip_owner = nullptr;
@@ -4,6 +4,8 @@
 
 
 #include "visual_server_canvas.h"
+
+#include "core/os/frame_profiler.h"
 #include "visual_server_globals.h"
 #include "visual_server_raster.h"
 #include "visual_server_viewport.h"
@@ -202,6 +204,8 @@ void VisualServerCanvas::_light_mask_canvas_items(int p_z, RasterizerCanvas::Ite
 }
 
 void VisualServerCanvas::render_canvas(Canvas *p_canvas, const Transform2D &p_transform, RasterizerCanvas::Light *p_lights, RasterizerCanvas::Light *p_masked_lights, const Rect2 &p_clip_rect, int p_canvas_layer_id) {
+	FRAME_PROFILE_SCOPE("VisualServerCanvas::render_canvas");
+
 	VSG::canvas_render->canvas_begin();
 
 	if (p_canvas->children_order_dirty) {
@@ -376,6 +380,15 @@ void VisualServerCanvas::canvas_item_set_transform(RID p_item, const Transform2D
 
 	canvas_item->xform = p_transform;
 }
+void VisualServerCanvas::canvas_item_set_transforms(const Vector<RID> &p_items, const Vector<Transform2D> &p_transforms) {
+	ERR_FAIL_COND(p_items.size() != p_transforms.size());
+
+	const RID *items = p_items.ptr();
+	const Transform2D *transforms = p_transforms.ptr();
+	for (int i = 0; i < p_items.size(); i++) {
+		canvas_item_set_transform(items[i], transforms[i]);
+	}
+}
 void VisualServerCanvas::canvas_item_set_clip(RID p_item, bool p_clip) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
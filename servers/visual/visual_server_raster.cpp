@@ -6,6 +6,7 @@
 #include "visual_server_raster.h"
 
 #include "core/io/marshalls.h"
+#include "core/os/frame_profiler.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
 #include "core/sort_array.h"
@@ -70,6 +71,8 @@ void VisualServerRaster::request_frame_drawn_callback(Object *p_where, const Str
 }
 
 void VisualServerRaster::draw(bool p_swap_buffers, double frame_step) {
+	FRAME_PROFILE_SCOPE("VisualServerRaster::draw");
+
 	//needs to be done before changes is reset to 0, to not force the editor to redraw
 	VS::get_singleton()->emit_signal("frame_pre_draw");
 